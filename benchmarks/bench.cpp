@@ -0,0 +1,625 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "address_index.hpp"
+#include "memory_source.hpp"
+#include "msvc.hpp"
+#include "object.hpp"
+#include "scan.hpp"
+#include "synth/image.hpp"
+#include "win/win.hpp"
+
+namespace
+{
+    std::atomic< std::uint64_t > allocations{ 0 }, allocated_bytes{ 0 };
+}  // namespace
+
+// Every allocation the library makes goes through here, so the benchmarks can report how many a call costs.
+void* operator new( std::size_t size )
+{
+    allocations.fetch_add( 1, std::memory_order_relaxed );
+    allocated_bytes.fetch_add( size, std::memory_order_relaxed );
+
+    if ( const auto memory = std::malloc( size ? size : 1 ) )
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void* memory ) noexcept
+{
+    std::free( memory );
+}
+
+void operator delete( void* memory, std::size_t ) noexcept
+{
+    std::free( memory );
+}
+
+// Polymorphic allocators (and so the library's pmr containers) allocate with an explicit alignment.
+void* operator new( std::size_t size, std::align_val_t alignment )
+{
+    allocations.fetch_add( 1, std::memory_order_relaxed );
+    allocated_bytes.fetch_add( size, std::memory_order_relaxed );
+
+    const auto align = static_cast< std::size_t >( alignment );
+
+#ifdef _WIN32
+    if ( const auto memory = _aligned_malloc( size ? size : 1, align ) )
+        return memory;
+#else
+    if ( const auto memory = std::aligned_alloc( align, ( size + align ) & ~( align - 1 ) ) )
+        return memory;
+#endif
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void* memory, std::align_val_t ) noexcept
+{
+#ifdef _WIN32
+    _aligned_free( memory );
+#else
+    std::free( memory );
+#endif
+}
+
+void operator delete( void* memory, std::size_t, std::align_val_t alignment ) noexcept
+{
+    operator delete( memory, alignment );
+}
+
+namespace
+{
+    /// <summary>
+    /// Wraps another memory source and counts the calls that would each be a system call against a live process.
+    /// Views are never forwarded, so the library reads every byte the way it would from a process.
+    /// </summary>
+    class counting_source final : public extlib::memory_source
+    {
+       public:
+        explicit counting_source( const extlib::memory_source& inner ) : inner( inner )
+        {
+        }
+
+        std::vector< extlib::win::region_t > get_regions( std::uintptr_t start, std::uintptr_t end ) const override
+        {
+            region_queries.fetch_add( 1, std::memory_order_relaxed );
+
+            return inner.get_regions( start, end );
+        }
+
+        std::vector< extlib::module_info_t > get_modules() const override
+        {
+            return inner.get_modules();
+        }
+
+        std::size_t read( std::uintptr_t address, void* buffer, std::size_t size ) const override
+        {
+            reads.fetch_add( 1, std::memory_order_relaxed );
+
+            return inner.read( address, buffer, size );
+        }
+
+        mutable std::atomic< std::uint64_t > reads{ 0 }, region_queries{ 0 };
+
+       private:
+        const extlib::memory_source& inner;
+    };
+
+    /// <summary>
+    /// What to run and how often.
+    /// </summary>
+    struct config_t
+    {
+        std::uint64_t seed = 1;
+        std::size_t iterations = 20;
+
+        /// <summary>
+        /// Runs a reduced set of cases, for a quick check rather than tracking.
+        /// </summary>
+        bool quick = false;
+
+        /// <summary>
+        /// Only cases whose name contains this are run.
+        /// </summary>
+        std::string filter;
+
+        /// <summary>
+        /// Where to write the machine-readable results, if anywhere.
+        /// </summary>
+        std::string json_path;
+    };
+
+    /// <summary>
+    /// The measurements of one benchmark case. Counters are averaged per iteration.
+    /// </summary>
+    struct result_t
+    {
+        std::string group, name;
+        std::vector< std::pair< std::string, std::uint64_t > > parameters;
+
+        std::size_t bytes;
+        std::vector< double > samples;
+
+        double allocations, allocated_bytes, reads, region_queries;
+
+        double percentile( double fraction ) const
+        {
+            return samples[ static_cast< std::size_t >( fraction * static_cast< double >( samples.size() - 1 ) + 0.5 ) ];
+        }
+
+        double gigabytes_per_second() const
+        {
+            return static_cast< double >( bytes ) / percentile( 0.5 );
+        }
+    };
+
+    /// <summary>
+    /// Times `body` once to warm up and then `iterations` times, recording the latency of every run.
+    /// </summary>
+    template< typename body_t >
+    result_t measure(
+        std::string group,
+        std::string name,
+        std::vector< std::pair< std::string, std::uint64_t > > parameters,
+        std::size_t bytes,
+        std::size_t iterations,
+        const counting_source* source,
+        body_t&& body )
+    {
+        body();
+
+        result_t result{ std::move( group ), std::move( name ), std::move( parameters ), bytes, {}, 0, 0, 0, 0 };
+        result.samples.reserve( iterations );
+
+        const auto allocations_before = allocations.load();
+        const auto allocated_before = allocated_bytes.load();
+        const auto reads_before = source ? source->reads.load() : 0;
+        const auto queries_before = source ? source->region_queries.load() : 0;
+
+        for ( std::size_t i = 0; i < iterations; ++i )
+        {
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            const auto end = std::chrono::steady_clock::now();
+
+            result.samples.push_back( std::chrono::duration< double, std::nano >( end - start ).count() );
+        }
+
+        const auto count = static_cast< double >( iterations );
+
+        result.allocations = static_cast< double >( allocations.load() - allocations_before ) / count;
+        result.allocated_bytes = static_cast< double >( allocated_bytes.load() - allocated_before ) / count;
+        result.reads = source ? static_cast< double >( source->reads.load() - reads_before ) / count : 0;
+        result.region_queries = source ? static_cast< double >( source->region_queries.load() - queries_before ) / count : 0;
+
+        std::sort( result.samples.begin(), result.samples.end() );
+
+        return result;
+    }
+
+    /// <summary>
+    /// Generates bytes that look roughly like x64 code: a handful of opcode and operand bytes make up a large share of
+    /// them, which is what makes some anchor bytes far more expensive to search for than others.
+    /// </summary>
+    std::vector< std::uint8_t > generate_code( std::size_t size, std::mt19937_64& random )
+    {
+        static constexpr std::uint8_t common[] = { 0x00, 0x48, 0x8B, 0x89, 0xE8, 0xCC, 0xFF, 0x0F, 0x24, 0x44, 0x4C, 0xC3 };
+
+        std::vector< std::uint8_t > bytes( size );
+
+        for ( auto& byte : bytes )
+        {
+            const auto value = random();
+            byte = value % 10 < 3 ? common[ ( value >> 8 ) % std::size( common ) ]
+                                  : static_cast< std::uint8_t >( value >> 16 );
+        }
+
+        return bytes;
+    }
+
+    /// <summary>
+    /// Copies a pattern out of a buffer, wildcarding roughly `wildcard_percent` percent of its bytes.
+    /// </summary>
+    extlib::pattern_t take_pattern(
+        const std::vector< std::uint8_t >& bytes,
+        std::size_t length,
+        std::size_t wildcard_percent,
+        std::mt19937_64& random )
+    {
+        const auto offset = random() % ( bytes.size() - length );
+
+        std::string text;
+
+        for ( std::size_t i = 0; i < length; ++i )
+        {
+            char byte[ 4 ];
+            std::snprintf( byte, sizeof( byte ), "%02X ", bytes[ offset + i ] );
+
+            text += random() % 100 < wildcard_percent ? "?? " : byte;
+        }
+
+        return extlib::pattern_t::from_byte_pattern( text );
+    }
+
+    bool selected( const config_t& config, const std::string& name )
+    {
+        return config.filter.empty() || name.find( config.filter ) != std::string::npos;
+    }
+
+    void find_matches_benchmarks( const config_t& config, std::vector< result_t >& results )
+    {
+        std::mt19937_64 random( config.seed );
+
+        const std::vector< std::size_t > buffer_sizes =
+            config.quick ? std::vector< std::size_t >{ 0x10000, 0x1000000 }
+                         : std::vector< std::size_t >{ 0x1000, 0x10000, 0x100000, 0x1000000 };
+        const std::vector< std::size_t > lengths = config.quick ? std::vector< std::size_t >{ 8, 32 }
+                                                                : std::vector< std::size_t >{ 4, 8, 16, 32 };
+        const std::vector< std::size_t > densities = { 0, 25, 50 };
+
+        for ( const auto buffer_size : buffer_sizes )
+        {
+            const auto buffer = generate_code( buffer_size, random );
+
+            // Small buffers are timed more often, so their percentiles rest on as much data as the large ones.
+            const auto iterations =
+                std::max( config.iterations, std::min< std::size_t >( 1000, 0x4000000 / buffer_size ) );
+
+            for ( const auto length : lengths )
+            {
+                for ( const auto density : densities )
+                {
+                    const auto name = "find_matches/" + std::to_string( buffer_size ) + "/" + std::to_string( length ) +
+                                      "/" + std::to_string( density );
+
+                    if ( !selected( config, name ) )
+                        continue;
+
+                    const auto pattern = take_pattern( buffer, length, density, random );
+
+                    results.push_back( measure(
+                        "find_matches",
+                        name,
+                        { { "buffer_size", buffer_size }, { "pattern_length", length }, { "wildcard_percent", density } },
+                        buffer_size,
+                        iterations,
+                        nullptr,
+                        [ & ]() { pattern.find_matches( buffer.data(), buffer.size() ); } ) );
+                }
+            }
+        }
+    }
+
+    void scanner_benchmarks( const config_t& config, std::vector< result_t >& results )
+    {
+        const std::vector< std::size_t > image_sizes =
+            config.quick ? std::vector< std::size_t >{ 0x1000000 } : std::vector< std::size_t >{ 0x1000000, 0x4000000 };
+
+        for ( const auto image_size : image_sizes )
+        {
+            const auto name = "find_all/" + std::to_string( image_size );
+
+            if ( !selected( config, name ) )
+                continue;
+
+            extlib::synth::image_options_t options;
+            options.seed = config.seed;
+            options.code_size = image_size;
+            options.signatures = { "48 8B 05 ?? ?? ?? ?? 48 85 C0 74 ?? E8" };
+
+            const auto image = extlib::synth::image::generate( options );
+            const auto bytes = image.get_bytes().size();
+
+            const auto loaded = image.create_source();
+            const counting_source source( *loaded );
+
+            const auto pattern = extlib::pattern_t::from_byte_pattern( options.signatures.front() );
+
+            extlib::scanner scanner( extlib::scanner_options_t( source, image.get_base(), image.get_base() + bytes ) );
+
+            results.push_back( measure(
+                "find_all",
+                name,
+                { { "image_size", bytes } },
+                bytes,
+                config.iterations,
+                &source,
+                [ & ]() { scanner.find_all( pattern ); } ) );
+        }
+    }
+
+    void object_benchmarks( const config_t& config, std::vector< result_t >& results )
+    {
+        const std::vector< std::size_t > class_counts =
+            config.quick ? std::vector< std::size_t >{ 1000 } : std::vector< std::size_t >{ 1000, 10000 };
+
+        for ( const auto classes : class_counts )
+        {
+            const auto name = "find_object/" + std::to_string( classes );
+
+            if ( !selected( config, name ) )
+                continue;
+
+            extlib::synth::image_options_t options;
+            options.seed = config.seed;
+            options.code_size = 0x1000000;
+            options.classes = classes;
+
+            const auto image = extlib::synth::image::generate( options );
+            const auto bytes = image.get_bytes().size();
+
+            const auto loaded = image.create_source();
+            const auto source = std::make_shared< counting_source >( *loaded );
+
+            const extlib::win::module_t module( source, image.get_base(), bytes );
+
+            // A class late in the image, so its hierarchy is deep and its name is far into `.data`.
+            const auto pattern = extlib::object_pattern_t::from_class_name( image.get_classes()[ classes * 3 / 4 ].name );
+
+            // find_object reports what it finds on stdout, which would swamp the results.
+            const auto output = std::cout.rdbuf( nullptr );
+
+            auto result = measure(
+                "find_object",
+                name,
+                { { "image_size", bytes }, { "classes", classes } },
+                bytes,
+                config.iterations,
+                source.get(),
+                [ & ]() { extlib::object::find_object( module, pattern ); } );
+
+            std::cout.rdbuf( output );
+            std::cout.clear();
+
+            results.push_back( std::move( result ) );
+        }
+    }
+
+    void address_index_benchmarks( const config_t& config, std::vector< result_t >& results )
+    {
+        if ( !selected( config, "address_index/unsorted" ) && !selected( config, "address_index/sorted" ) )
+            return;
+
+        const auto count = config.quick ? std::size_t{ 0x10000 } : std::size_t{ 0x100000 };
+
+        extlib::synth::image_options_t options;
+        options.seed = config.seed;
+        options.code_size = 0x1000000;
+
+        const auto image = extlib::synth::image::generate( options );
+        const auto bytes = image.get_bytes().size();
+
+        const auto index =
+            extlib::address_index::build( { extlib::win::module_t( image.create_source(), image.get_base(), bytes ) } );
+
+        // Addresses spread over the image and a little either side of it, as scan results and pointers would be.
+        std::mt19937_64 random( config.seed );
+        std::vector< std::uintptr_t > addresses( count );
+
+        for ( auto& address : addresses )
+            address = image.get_base() - 0x1000 + random() % ( bytes + 0x2000 );
+
+        std::vector< extlib::address_location_t > locations( count );
+
+        for ( const auto sorted : { false, true } )
+        {
+            const auto name = std::string( "address_index/" ) + ( sorted ? "sorted" : "unsorted" );
+
+            if ( !selected( config, name ) )
+                continue;
+
+            if ( sorted )
+                std::sort( addresses.begin(), addresses.end() );
+
+            results.push_back( measure(
+                "address_index",
+                name,
+                { { "addresses", count }, { "sections", index.get_sections().size() } },
+                count * sizeof( std::uintptr_t ),
+                config.iterations,
+                nullptr,
+                [ & ]() { index.lookup( addresses.data(), count, locations.data() ); } ) );
+        }
+    }
+
+    void container_benchmarks( const config_t& config, std::vector< result_t >& results )
+    {
+        const auto count = config.quick ? std::size_t{ 300 } : std::size_t{ 3000 };
+        const auto name = "msvc_containers/" + std::to_string( count );
+
+        if ( !selected( config, name ) )
+            return;
+
+        extlib::synth::image_options_t options;
+        options.seed = config.seed;
+        options.code_size = 0x100000;
+        options.containers = count;
+
+        const auto image = extlib::synth::image::generate( options );
+        const auto bytes = image.get_bytes().size();
+
+        const auto loaded = image.create_source();
+        const auto source = std::make_shared< counting_source >( *loaded );
+
+        const extlib::win::module_t module( source, image.get_base(), bytes );
+
+        // Reads a container and flattens it the way the image records it.
+        const auto read = [ & ]( const extlib::synth::planted_container_t& container ) {
+            const auto address = image.get_base() + container.rva;
+
+            std::vector< std::uint32_t > values;
+            std::string string;
+
+            switch ( container.kind )
+            {
+                case extlib::synth::container_kind_t::vector:
+                    values = extlib::msvc::read_vector< std::uint32_t >( module, address );
+                    break;
+                case extlib::synth::container_kind_t::string:
+                    string = extlib::msvc::read_string( module, address );
+                    break;
+                case extlib::synth::container_kind_t::unordered_map:
+                {
+                    const auto entries = extlib::msvc::read_unordered_map< std::uint32_t, std::uint32_t >( module, address );
+
+                    for ( const auto& entry : entries )
+                    {
+                        values.push_back( entry.first );
+                        values.push_back( entry.second );
+                    }
+                    break;
+                }
+            }
+
+            return std::make_pair( std::move( values ), std::move( string ) );
+        };
+
+        // Timings of readers that read the wrong thing are meaningless, so every container is checked first.
+        std::size_t contents = 0;
+
+        for ( const auto& container : image.get_containers() )
+        {
+            const auto [ values, string ] = read( container );
+
+            if ( values != container.values || string != container.string )
+            {
+                std::stringstream msg;
+                msg << "The container at RVA 0x" << std::hex << container.rva << " did not read back as it was planted";
+                throw std::runtime_error( msg.str() );
+            }
+
+            contents += values.size() * sizeof( std::uint32_t ) + string.size();
+        }
+
+        results.push_back( measure(
+            "msvc_containers",
+            name,
+            { { "containers", count } },
+            contents,
+            config.iterations,
+            source.get(),
+            [ & ]() {
+                for ( const auto& container : image.get_containers() )
+                    read( container );
+            } ) );
+    }
+
+    void write_json( const config_t& config, const std::vector< result_t >& results )
+    {
+        std::ofstream file( config.json_path );
+
+        if ( !file )
+            throw std::runtime_error( "Failed to open '" + config.json_path + "'" );
+
+        file << "{\n  \"seed\": " << config.seed << ",\n  \"quick\": " << ( config.quick ? "true" : "false" )
+             << ",\n  \"results\": [\n";
+
+        for ( std::size_t i = 0; i < results.size(); ++i )
+        {
+            const auto& result = results[ i ];
+
+            file << "    { \"group\": \"" << result.group << "\", \"name\": \"" << result.name << "\", \"parameters\": { ";
+
+            for ( std::size_t j = 0; j < result.parameters.size(); ++j )
+                file << ( j ? ", " : "" ) << '"' << result.parameters[ j ].first << "\": " << result.parameters[ j ].second;
+
+            file << " }, \"bytes\": " << result.bytes << ", \"iterations\": " << result.samples.size()
+                 << ", \"min_ns\": " << result.samples.front() << ", \"p50_ns\": " << result.percentile( 0.5 )
+                 << ", \"p90_ns\": " << result.percentile( 0.9 ) << ", \"p99_ns\": " << result.percentile( 0.99 )
+                 << ", \"gb_per_s\": " << result.gigabytes_per_second() << ", \"allocations\": " << result.allocations
+                 << ", \"allocated_bytes\": " << result.allocated_bytes << ", \"reads\": " << result.reads
+                 << ", \"region_queries\": " << result.region_queries << " }" << ( i + 1 < results.size() ? "," : "" )
+                 << '\n';
+        }
+
+        file << "  ]\n}\n";
+    }
+
+    void print( const std::vector< result_t >& results )
+    {
+        std::printf(
+            "%-28s %12s %12s %12s %9s %10s %10s %8s\n", "benchmark", "p50 us", "p90 us", "p99 us", "GB/s", "allocs", "reads",
+            "queries" );
+
+        for ( const auto& result : results )
+        {
+            std::printf(
+                "%-28s %12.2f %12.2f %12.2f %9.2f %10.1f %10.1f %8.1f\n",
+                result.name.c_str(),
+                result.percentile( 0.5 ) / 1000,
+                result.percentile( 0.9 ) / 1000,
+                result.percentile( 0.99 ) / 1000,
+                result.gigabytes_per_second(),
+                result.allocations,
+                result.reads,
+                result.region_queries );
+        }
+    }
+}  // namespace
+
+std::int32_t main( std::int32_t argc, char** argv )
+{
+    config_t config;
+
+    for ( std::int32_t i = 1; i < argc; ++i )
+    {
+        const std::string argument = argv[ i ];
+        const auto has_value = i + 1 < argc;
+
+        if ( argument == "--quick" )
+            config.quick = true;
+        else if ( argument == "--seed" && has_value )
+            config.seed = std::strtoull( argv[ ++i ], nullptr, 0 );
+        else if ( argument == "--iterations" && has_value )
+            config.iterations = std::max< std::size_t >( std::strtoull( argv[ ++i ], nullptr, 0 ), 1 );
+        else if ( argument == "--filter" && has_value )
+            config.filter = argv[ ++i ];
+        else if ( argument == "--json" && has_value )
+            config.json_path = argv[ ++i ];
+        else
+        {
+            std::cerr << "usage: extlib_bench [--quick] [--seed n] [--iterations n] [--filter text] [--json path]\n";
+            return 1;
+        }
+    }
+
+    try
+    {
+        std::vector< result_t > results;
+
+        find_matches_benchmarks( config, results );
+        scanner_benchmarks( config, results );
+        object_benchmarks( config, results );
+        address_index_benchmarks( config, results );
+        container_benchmarks( config, results );
+
+        print( results );
+
+        if ( !config.json_path.empty() )
+            write_json( config, results );
+    }
+    catch ( const std::exception& e )
+    {
+        std::cerr << "extlib_bench: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// Where an address lies within a process: its module, section and region, as indices into the address index
+    /// that resolved it. Small enough to keep next to every scan result.
+    /// </summary>
+    struct address_location_t
+    {
+        /// <summary>
+        /// Marks an index that is absent, e.g. the module of an address outside every module.
+        /// </summary>
+        static constexpr std::uint32_t none = 0xFFFFFFFF;
+
+        std::uintptr_t address;
+
+        std::uint32_t module = none;
+        std::uint32_t section = none;
+        std::uint32_t region = none;
+
+        /// <summary>
+        /// The offset of the address from its module's base, or 0 if it is outside every module.
+        /// </summary>
+        std::uint32_t rva = 0;
+
+        constexpr bool in_module() const
+        {
+            return module != none;
+        }
+
+        constexpr bool in_section() const
+        {
+            return section != none;
+        }
+
+        constexpr bool in_region() const
+        {
+            return region != none;
+        }
+    };
+
+    /// <summary>
+    /// An immutable map of a process's address space, resolving addresses to the module, section and region they lie
+    /// in.
+    /// <para>
+    /// Modules, sections and regions are each kept in flat arrays sorted by address, with their start addresses in an
+    /// array of their own, so a lookup is a binary search over contiguous memory. Sections are grouped by module, and
+    /// only the sections of the module found are searched. Batches of sorted addresses (as scans return them) are
+    /// resolved in a single forward pass instead.
+    /// </para>
+    /// </summary>
+    class address_index final
+    {
+       public:
+        /// <summary>
+        /// A section of an indexed module.
+        /// </summary>
+        struct section_entry_t
+        {
+            std::uintptr_t start, end;
+
+            /// <summary>
+            /// The section's name, without the padding of its header.
+            /// </summary>
+            std::string name;
+
+            std::uint32_t module;
+        };
+
+        /// <summary>
+        /// Indexes modules and, optionally, every region of the address space they share.
+        /// </summary>
+        /// <param name="modules">The modules to index (e.g. from `process::get_modules`), which must all belong to the
+        /// same process or memory source.</param>
+        /// <param name="with_regions">Whether to index the regions too, which takes a query per region.</param>
+        /// <returns>The index.</returns>
+        static address_index build( std::vector< win::module_t > modules, bool with_regions = true );
+
+        /// <summary>
+        /// Resolves an address.
+        /// </summary>
+        /// <param name="address">The address to resolve.</param>
+        /// <returns>Where the address lies.</returns>
+        address_location_t lookup( std::uintptr_t address ) const;
+
+        /// <summary>
+        /// Resolves many addresses. Sorted addresses are resolved in one pass over the index; otherwise every address
+        /// is searched for separately.
+        /// </summary>
+        /// <param name="addresses">The addresses to resolve.</param>
+        /// <param name="count">The number of addresses.</param>
+        /// <param name="locations">Receives where each address lies, in the same order.</param>
+        void lookup( const std::uintptr_t* addresses, std::size_t count, address_location_t* locations ) const;
+
+        /// <summary>
+        /// Resolves many addresses, such as the results of a scan.
+        /// </summary>
+        /// <param name="addresses">The addresses to resolve.</param>
+        /// <returns>Where each address lies, in the same order.</returns>
+        std::vector< address_location_t > lookup( const std::vector< std::uintptr_t >& addresses ) const;
+
+        /// <summary>
+        /// Describes a location for people, e.g. `client.dll+0x1A2B30 (.text)`, or just the address if it is outside
+        /// every module.
+        /// </summary>
+        std::string describe( const address_location_t& location ) const;
+
+        /// <summary>
+        /// Gets the indexed modules, sorted by address.
+        /// </summary>
+        const std::vector< win::module_t >& get_modules() const;
+
+        /// <summary>
+        /// Gets the base names of the indexed modules, in the same order.
+        /// </summary>
+        const std::vector< std::string >& get_module_names() const;
+
+        /// <summary>
+        /// Gets the sections of every indexed module, sorted by address.
+        /// </summary>
+        const std::vector< section_entry_t >& get_sections() const;
+
+        /// <summary>
+        /// Gets the indexed regions, sorted by address. Free regions are left out.
+        /// </summary>
+        const std::vector< win::region_t >& get_regions() const;
+
+       private:
+        address_index() = default;
+
+        /// <summary>
+        /// Finds the entry whose range contains an address, searching the start addresses in `[first, last)`.
+        /// </summary>
+        /// <returns>The entry's index, or `address_location_t::none`.</returns>
+        static std::uint32_t find(
+            const std::vector< std::uintptr_t >& starts,
+            const std::vector< std::uintptr_t >& ends,
+            std::size_t first,
+            std::size_t last,
+            std::uintptr_t address );
+
+        /// <summary>
+        /// Fills in the section and RVA of a location whose module is known.
+        /// </summary>
+        void resolve_section( address_location_t& location ) const;
+
+        std::vector< win::module_t > modules;
+        std::vector< std::string > module_names;
+        std::vector< std::uintptr_t > module_starts, module_ends;
+
+        /// <summary>
+        /// The range of `sections` belonging to each module.
+        /// </summary>
+        std::vector< std::uint32_t > module_first_section, module_last_section;
+
+        std::vector< section_entry_t > sections;
+        std::vector< std::uintptr_t > section_starts, section_ends;
+
+        std::vector< win::region_t > regions;
+        std::vector< std::uintptr_t > region_starts, region_ends;
+    };
+}  // namespace extlib
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace extlib
+{
+    /// <summary>
+    /// A monotonic scratch allocator. Memory is handed out by bumping a pointer through large blocks and is only
+    /// reclaimed as a whole by `reset`, which keeps the blocks around for the next use.
+    /// </summary>
+    class arena final : public std::pmr::memory_resource
+    {
+       public:
+        /// <summary>
+        /// The minimum alignment of every allocation (wide enough for any SIMD load).
+        /// </summary>
+        static constexpr std::size_t min_alignment = 64;
+
+        /// <summary>
+        /// Creates a new arena.
+        /// </summary>
+        /// <param name="block_size">The size of each block requested from the system.</param>
+        /// <param name="large_pages">If this value is true, blocks are backed by large pages when allowed.</param>
+        explicit arena( std::size_t block_size = 0x400000, bool large_pages = false );
+
+        arena( const arena& ) = delete;
+        arena& operator=( const arena& ) = delete;
+
+        /// <summary>
+        /// Releases every block back to the system.
+        /// </summary>
+        ~arena() override;
+
+        /// <summary>
+        /// Rewinds the arena to empty. Every pointer handed out previously becomes invalid, the blocks are reused.
+        /// </summary>
+        void reset();
+
+        /// <summary>
+        /// Releases every block back to the system.
+        /// </summary>
+        void release();
+
+        /// <summary>
+        /// Gets the number of bytes handed out since the last reset.
+        /// </summary>
+        std::size_t used() const;
+
+        /// <summary>
+        /// Gets the number of bytes reserved from the system.
+        /// </summary>
+        std::size_t capacity() const;
+
+       private:
+        /// <summary>
+        /// A block of memory reserved from the system.
+        /// </summary>
+        struct block_t
+        {
+            std::uint8_t* data;
+            std::size_t size;
+        };
+
+        void* do_allocate( std::size_t bytes, std::size_t alignment ) override;
+
+        void do_deallocate( void* pointer, std::size_t bytes, std::size_t alignment ) override;
+
+        bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override;
+
+        /// <summary>
+        /// Reserves a new block of at least `size` bytes from the system.
+        /// </summary>
+        block_t allocate_block( std::size_t size ) const;
+
+        std::vector< block_t > blocks;
+
+        std::size_t block_size, current, offset, consumed;
+
+        bool large_pages;
+    };
+}  // namespace extlib
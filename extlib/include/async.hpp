@@ -0,0 +1,444 @@
+#pragma once
+
+#if !defined( EXTLIB_ASYNC )
+#error "async.hpp needs the library to be built with the EXTLIB_ASYNC option"
+#endif
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cancellation.hpp"
+#include "object.hpp"
+#include "scan.hpp"
+#include "thread_pool.hpp"
+#include "win/win.hpp"
+
+namespace extlib::async
+{
+    template< typename T = void >
+    class task;
+
+    namespace detail
+    {
+        /// <summary>
+        /// The parts of a task's promise that do not depend on its result.
+        /// </summary>
+        struct promise_base_t
+        {
+            /// <summary>
+            /// Resumes whoever awaited the task once it finishes, without growing the stack.
+            /// </summary>
+            struct final_awaiter_t
+            {
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                template< typename promise_t >
+                std::coroutine_handle<> await_suspend( std::coroutine_handle< promise_t > coroutine ) const noexcept
+                {
+                    const auto continuation = coroutine.promise().continuation;
+
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept
+                {
+                }
+            };
+
+            std::suspend_always initial_suspend() const noexcept
+            {
+                return {};
+            }
+
+            final_awaiter_t final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            void unhandled_exception() noexcept
+            {
+                error = std::current_exception();
+            }
+
+            std::coroutine_handle<> continuation;
+            std::exception_ptr error;
+        };
+
+        template< typename T >
+        struct promise_t : promise_base_t
+        {
+            task< T > get_return_object() noexcept;
+
+            void return_value( T value )
+            {
+                result.emplace( std::move( value ) );
+            }
+
+            /// <summary>
+            /// Moves the result out of the finished task, or rethrows what the task threw.
+            /// </summary>
+            T take()
+            {
+                if ( error )
+                    std::rethrow_exception( error );
+
+                return std::move( *result );
+            }
+
+            std::optional< T > result;
+        };
+
+        template<>
+        struct promise_t< void > : promise_base_t
+        {
+            task< void > get_return_object() noexcept;
+
+            void return_void() const noexcept
+            {
+            }
+
+            void take() const
+            {
+                if ( error )
+                    std::rethrow_exception( error );
+            }
+        };
+
+        /// <summary>
+        /// A coroutine nobody awaits, which owns and destroys itself once it finishes.
+        /// </summary>
+        struct detached_t
+        {
+            struct promise_type
+            {
+                detached_t get_return_object() const noexcept
+                {
+                    return {};
+                }
+
+                std::suspend_never initial_suspend() const noexcept
+                {
+                    return {};
+                }
+
+                std::suspend_never final_suspend() const noexcept
+                {
+                    return {};
+                }
+
+                void return_void() const noexcept
+                {
+                }
+
+                void unhandled_exception() const noexcept
+                {
+                    std::terminate();
+                }
+            };
+        };
+
+        /// <summary>
+        /// Runs a task to completion, stores its outcome in `result` and then invokes `done`.
+        /// </summary>
+        template< typename T, typename callback_t >
+        detached_t run_detached( task< T > work, std::promise< T > result, callback_t done )
+        {
+            try
+            {
+                if constexpr ( std::is_void_v< T > )
+                {
+                    co_await std::move( work );
+                    result.set_value();
+                }
+                else
+                    result.set_value( co_await std::move( work ) );
+            }
+            catch ( ... )
+            {
+                result.set_exception( std::current_exception() );
+            }
+
+            done();
+        }
+    }  // namespace detail
+
+    /// <summary>
+    /// A lazily started coroutine producing a `T`. Nothing runs until the task is awaited (or handed to `start`,
+    /// `spawn` or `sync_wait`), and whatever it throws is rethrown to whoever awaits it.
+    /// </summary>
+    template< typename T >
+    class task final
+    {
+       public:
+        using promise_type = detail::promise_t< T >;
+
+        task( task&& other ) noexcept : coroutine( std::exchange( other.coroutine, {} ) )
+        {
+        }
+
+        task& operator=( task&& other ) noexcept
+        {
+            if ( this != &other )
+            {
+                if ( coroutine )
+                    coroutine.destroy();
+
+                coroutine = std::exchange( other.coroutine, {} );
+            }
+
+            return *this;
+        }
+
+        task( const task& ) = delete;
+        task& operator=( const task& ) = delete;
+
+        ~task()
+        {
+            if ( coroutine )
+                coroutine.destroy();
+        }
+
+        /// <summary>
+        /// Starts the task and suspends the awaiting coroutine until it finishes.
+        /// </summary>
+        auto operator co_await() && noexcept
+        {
+            struct awaiter_t
+            {
+                std::coroutine_handle< promise_type > coroutine;
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend( std::coroutine_handle<> awaiting ) const noexcept
+                {
+                    coroutine.promise().continuation = awaiting;
+
+                    return coroutine;
+                }
+
+                T await_resume() const
+                {
+                    return coroutine.promise().take();
+                }
+            };
+
+            return awaiter_t{ coroutine };
+        }
+
+       private:
+        friend struct detail::promise_t< T >;
+
+        explicit task( std::coroutine_handle< promise_type > coroutine ) : coroutine( coroutine )
+        {
+        }
+
+        std::coroutine_handle< promise_type > coroutine;
+    };
+
+    namespace detail
+    {
+        template< typename T >
+        inline task< T > promise_t< T >::get_return_object() noexcept
+        {
+            return task< T >( std::coroutine_handle< promise_t >::from_promise( *this ) );
+        }
+
+        inline task< void > promise_t< void >::get_return_object() noexcept
+        {
+            return task< void >( std::coroutine_handle< promise_t >::from_promise( *this ) );
+        }
+    }  // namespace detail
+
+    /// <summary>
+    /// Starts a task without waiting for it.
+    /// </summary>
+    /// <param name="work">The task to start.</param>
+    /// <returns>A future for the task's result.</returns>
+    template< typename T >
+    std::future< T > start( task< T > work )
+    {
+        std::promise< T > result;
+        auto future = result.get_future();
+
+        detail::run_detached( std::move( work ), std::move( result ), []() {} );
+
+        return future;
+    }
+
+    /// <summary>
+    /// Starts a task and invokes a callback once it finishes, for callers such as event loops that must never block.
+    /// The callback runs on whichever thread finished the task, so it usually posts the result back to its own loop.
+    /// </summary>
+    /// <param name="work">The task to start.</param>
+    /// <param name="callback">Invoked with a ready `std::future< T >` holding the result. It must not throw.</param>
+    template< typename T, typename callback_t >
+    void spawn( task< T > work, callback_t&& callback )
+    {
+        std::promise< T > result;
+        auto future = result.get_future();
+
+        detail::run_detached(
+            std::move( work ),
+            std::move( result ),
+            [ callback = std::forward< callback_t >( callback ), future = std::move( future ) ]() mutable {
+                callback( std::move( future ) );
+            } );
+    }
+
+    /// <summary>
+    /// Runs a task and blocks until it finishes. Must not be called from one of the threads the task runs on.
+    /// </summary>
+    /// <param name="work">The task to run.</param>
+    /// <returns>The task's result.</returns>
+    template< typename T >
+    T sync_wait( task< T > work )
+    {
+        return start( std::move( work ) ).get();
+    }
+
+    /// <summary>
+    /// A span of memory to read as part of a batch.
+    /// </summary>
+    struct read_request_t
+    {
+        std::uintptr_t address;
+        std::size_t length;
+    };
+
+    /// <summary>
+    /// Runs the blocking parts of reads and scans on its own threads, so coroutines waiting on them only hold their
+    /// frame rather than a thread. Every operation first moves onto the executor, then checks its cancellation token
+    /// before each unit of work, and throws `operation_cancelled` once it is cancelled.
+    /// <para>
+    /// The operations take their arguments by value, so nothing passed to them has to outlive the returned task;
+    /// only the executor itself must.
+    /// </para>
+    /// </summary>
+    class executor final
+    {
+       public:
+        /// <summary>
+        /// Creates a new executor.
+        /// </summary>
+        /// <param name="threads">The number of threads that run the blocking work.</param>
+        explicit executor( std::size_t threads = std::thread::hardware_concurrency() );
+
+        /// <summary>
+        /// Gets the executor used when callers do not bring their own.
+        /// </summary>
+        static executor& shared();
+
+        /// <summary>
+        /// Resumes the awaiting coroutine on one of the executor's threads.
+        /// </summary>
+        auto schedule() noexcept
+        {
+            struct awaiter_t
+            {
+                thread_pool& pool;
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                void await_suspend( std::coroutine_handle<> coroutine ) const
+                {
+                    pool.post( [ coroutine ]() { coroutine.resume(); } );
+                }
+
+                void await_resume() const noexcept
+                {
+                }
+            };
+
+            return awaiter_t{ pool };
+        }
+
+        /// <summary>
+        /// Reads memory from a module's process (or memory source).
+        /// </summary>
+        /// <param name="module">The module to read through.</param>
+        /// <param name="address">The location to read from.</param>
+        /// <param name="length">The number of bytes to read.</param>
+        /// <param name="cancellation">Cancels the read if it has not started yet.</param>
+        /// <returns>The bytes read.</returns>
+        task< std::vector< std::uint8_t > > read(
+            win::module_t module,
+            std::uintptr_t address,
+            std::size_t length,
+            cancellation_token cancellation = {} );
+
+        /// <summary>
+        /// Reads many spans of memory at once. Spans lying close together are merged into a single read, and the merged
+        /// reads run in parallel. A merged read that fails is retried span by span, so one unreadable span does not
+        /// fail its neighbours.
+        /// </summary>
+        /// <param name="module">The module to read through.</param>
+        /// <param name="requests">The spans to read.</param>
+        /// <param name="cancellation">Stops the batch before its next read.</param>
+        /// <returns>The bytes of every span in the order requested, or nothing for a span that could not be read.</returns>
+        task< std::vector< std::optional< std::vector< std::uint8_t > > > > read_batch(
+            win::module_t module,
+            std::vector< read_request_t > requests,
+            cancellation_token cancellation = {} );
+
+        /// <summary>
+        /// Finds all instances of a pattern, as `scanner::find_all` does.
+        /// </summary>
+        /// <param name="options">The options for the scan. Their cancellation token is replaced.</param>
+        /// <param name="pattern">The pattern to look for.</param>
+        /// <param name="cancellation">Stops the scan before its next chunk is read.</param>
+        /// <returns>A list of locations within the process.</returns>
+        task< std::vector< std::uintptr_t > > find_all(
+            scanner_options_t options,
+            pattern_t pattern,
+            cancellation_token cancellation = {} );
+
+        /// <summary>
+        /// Finds all instances of several patterns in the same memory, scanning for them in parallel.
+        /// </summary>
+        /// <param name="options">The options for the scans. Their cancellation token is replaced.</param>
+        /// <param name="patterns">The patterns to look for.</param>
+        /// <param name="cancellation">Stops every scan before its next chunk is read.</param>
+        /// <returns>The locations of every pattern, in the same order.</returns>
+        task< std::vector< std::vector< std::uintptr_t > > > find_all_batch(
+            scanner_options_t options,
+            std::vector< pattern_t > patterns,
+            cancellation_token cancellation = {} );
+
+        /// <summary>
+        /// Finds an object by its runtime type information, as `object::find_object` does.
+        /// </summary>
+        /// <param name="module">The module to search.</param>
+        /// <param name="pattern">The object pattern.</param>
+        /// <param name="cancellation">Cancels the search if it has not started yet.</param>
+        /// <returns>A unique object.</returns>
+        task< std::unique_ptr< object > > find_object(
+            win::module_t module,
+            object_pattern_t pattern,
+            cancellation_token cancellation = {} );
+
+       private:
+        thread_pool pool;
+
+        /// <summary>
+        /// The scanners the scans run on, kept so repeated scans reuse their arenas.
+        /// </summary>
+        scanner_pool scanners;
+    };
+}  // namespace extlib::async
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+namespace extlib
+{
+    /// <summary>
+    /// Thrown by an operation that stopped because its cancellation token was cancelled.
+    /// </summary>
+    class operation_cancelled final : public std::runtime_error
+    {
+       public:
+        operation_cancelled();
+    };
+
+    /// <summary>
+    /// Lets an operation find out whether whoever started it still wants the result. Tokens are cheap to copy, and
+    /// every copy observes the source it was taken from.
+    /// </summary>
+    class cancellation_token final
+    {
+       public:
+        /// <summary>
+        /// Creates a token that is never cancelled.
+        /// </summary>
+        cancellation_token() = default;
+
+        /// <summary>
+        /// Determines whether the token's source has been cancelled.
+        /// </summary>
+        /// <returns>True if the operation should stop.</returns>
+        bool is_cancelled() const;
+
+        /// <summary>
+        /// Throws `operation_cancelled` if the token's source has been cancelled.
+        /// </summary>
+        void throw_if_cancelled() const;
+
+       private:
+        friend class cancellation_source;
+
+        explicit cancellation_token( std::shared_ptr< const std::atomic< bool > > state );
+
+        std::shared_ptr< const std::atomic< bool > > state;
+    };
+
+    /// <summary>
+    /// Cancels every operation holding one of its tokens. Operations check their token between units of work (e.g.
+    /// before every chunk a scan reads), so they stop soon after, but not necessarily immediately.
+    /// </summary>
+    class cancellation_source final
+    {
+       public:
+        cancellation_source();
+
+        /// <summary>
+        /// Gets a token observing this source.
+        /// </summary>
+        cancellation_token get_token() const;
+
+        /// <summary>
+        /// Cancels every token of this source. Cancelling is permanent.
+        /// </summary>
+        void cancel();
+
+        /// <summary>
+        /// Determines whether the source has been cancelled.
+        /// </summary>
+        bool is_cancelled() const;
+
+       private:
+        std::shared_ptr< std::atomic< bool > > state;
+    };
+}  // namespace extlib
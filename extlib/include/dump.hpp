@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "memory_source.hpp"
+#include "win/mapped_file.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// How the blocks of a dump are stored.
+    /// </summary>
+    enum class dump_codec_t : std::uint32_t
+    {
+        /// <summary>
+        /// Blocks are stored as is, and can be scanned straight from the mapping.
+        /// </summary>
+        none = 0,
+
+        /// <summary>
+        /// Blocks are run-length encoded when that makes them smaller (memory dumps are mostly zero pages).
+        /// </summary>
+        rle = 1,
+
+        /// <summary>
+        /// The block could not be read when the dump was written (only found in block entries).
+        /// </summary>
+        absent = 0xFFFFFFFF
+    };
+
+    /// <summary>
+    /// The on-disk layout of a dump. A header is followed by the region contents (each region starting on a page
+    /// boundary), the copied module headers, and finally the tables the header points to. All fields are little-endian.
+    /// </summary>
+    namespace dump_format
+    {
+        /// <summary>
+        /// "EXTLDUMP" in little-endian.
+        /// </summary>
+        constexpr std::uint64_t magic = 0x504D55444C545845;
+
+        constexpr std::uint32_t version = 1;
+
+        struct header_t
+        {
+            std::uint64_t magic;
+            std::uint32_t version, block_size;
+
+            std::uint64_t region_count, region_table;
+            std::uint64_t block_count, block_table;
+            std::uint64_t module_count, module_table;
+            std::uint64_t string_size, string_table;
+        };
+
+        struct region_entry_t
+        {
+            std::uint64_t start, size, protect;
+            std::uint32_t state, type;
+
+            /// <summary>
+            /// The region's blocks in the block table (none for regions that were not readable).
+            /// </summary>
+            std::uint64_t first_block, block_count;
+        };
+
+        struct block_entry_t
+        {
+            std::uint64_t offset;
+            std::uint32_t stored_size;
+            dump_codec_t codec;
+        };
+
+        struct module_entry_t
+        {
+            std::uint64_t base, size;
+
+            /// <summary>
+            /// The module's name in the string table.
+            /// </summary>
+            std::uint64_t name_offset;
+            std::uint32_t name_length;
+
+            /// <summary>
+            /// A copy of the module's header page, so headers survive even if their region could not be read.
+            /// </summary>
+            std::uint32_t header_size;
+            std::uint64_t header_offset;
+        };
+
+        static_assert( sizeof( header_t ) == 80 && sizeof( region_entry_t ) == 48 );
+        static_assert( sizeof( block_entry_t ) == 16 && sizeof( module_entry_t ) == 40 );
+    }  // namespace dump_format
+
+    /// <summary>
+    /// Options for writing a dump.
+    /// </summary>
+    struct dump_options_t
+    {
+        /// <summary>
+        /// How blocks are stored.
+        /// </summary>
+        dump_codec_t codec = dump_codec_t::none;
+
+        /// <summary>
+        /// The size of each block (a multiple of the page size).
+        /// </summary>
+        std::size_t block_size = 0x100000;
+
+        /// <summary>
+        /// The address range to capture.
+        /// </summary>
+        std::uintptr_t start = 0, end = std::numeric_limits< std::uintptr_t >::max();
+    };
+
+    /// <summary>
+    /// Writes memory sources to dump files.
+    /// </summary>
+    class dump_writer final
+    {
+       public:
+        /// <summary>
+        /// Captures the region map, module list, module headers and the contents of every readable region.
+        /// </summary>
+        /// <param name="path">The path of the dump to write.</param>
+        /// <param name="source">The source to capture (usually a `process_source`).</param>
+        /// <param name="options">The options for the dump.</param>
+        static void write(
+            const std::filesystem::path& path,
+            const memory_source& source,
+            const dump_options_t& options = {} );
+    };
+
+    /// <summary>
+    /// A memory source backed by a mapped dump file. Reads are served straight from the mapping, and uncompressed
+    /// regions can be viewed (and therefore scanned) without copying.
+    /// </summary>
+    class dump_source final : public memory_source
+    {
+       public:
+        /// <summary>
+        /// Opens a dump.
+        /// </summary>
+        /// <param name="path">The path of the dump.</param>
+        explicit dump_source( const std::filesystem::path& path );
+
+        std::vector< win::region_t > get_regions( std::uintptr_t start, std::uintptr_t end ) const override;
+
+        std::vector< module_info_t > get_modules() const override;
+
+        std::size_t read( std::uintptr_t address, void* buffer, std::size_t size ) const override;
+
+        const std::uint8_t* view( std::uintptr_t address, std::size_t size ) const override;
+
+       private:
+        /// <summary>
+        /// Finds the region containing an address.
+        /// </summary>
+        const dump_format::region_entry_t* find_region( std::uintptr_t address ) const;
+
+        /// <summary>
+        /// Copies part of a block's decoded contents into a buffer.
+        /// </summary>
+        /// <returns>False, if the block is absent or corrupt.</returns>
+        bool copy_block(
+            std::size_t index,
+            std::size_t raw_size,
+            std::size_t offset,
+            void* buffer,
+            std::size_t size ) const;
+
+        /// <summary>
+        /// Reads from a copied module header, for addresses whose region is missing from the dump.
+        /// </summary>
+        std::size_t read_module_header( std::uintptr_t address, void* buffer, std::size_t size ) const;
+
+        std::unique_ptr< win::mapped_file > file;
+
+        dump_format::header_t header;
+
+        const dump_format::region_entry_t* regions;
+        const dump_format::block_entry_t* blocks;
+        const dump_format::module_entry_t* modules;
+        const char* strings;
+
+        // The last compressed block that was decoded.
+        mutable std::mutex cache_mutex;
+        mutable std::vector< std::uint8_t > cached_block;
+        mutable std::size_t cached_index;
+    };
+}  // namespace extlib
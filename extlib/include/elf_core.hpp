@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "file_source.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// The parts of the ELF format needed to read 64-bit little-endian core files.
+    /// </summary>
+    namespace elf_format
+    {
+        /// <summary>
+        /// "\x7F" "ELF" in little-endian.
+        /// </summary>
+        constexpr std::uint32_t magic = 0x464C457F;
+
+        constexpr std::uint8_t class64 = 2;
+        constexpr std::uint8_t little_endian = 1;
+
+        constexpr std::uint16_t core_type = 4;
+
+        constexpr std::uint32_t load_segment = 1;
+        constexpr std::uint32_t note_segment = 4;
+
+        constexpr std::uint32_t execute_flag = 1;
+        constexpr std::uint32_t write_flag = 2;
+        constexpr std::uint32_t read_flag = 4;
+
+        /// <summary>
+        /// The note listing the files mapped into the process ("FILE" in little-endian).
+        /// </summary>
+        constexpr std::uint32_t file_note = 0x46494C45;
+
+        struct header_t
+        {
+            std::uint32_t magic;
+            std::uint8_t elf_class, encoding, version, abi;
+            std::uint8_t padding[ 8 ];
+
+            std::uint16_t type, machine;
+            std::uint32_t elf_version;
+            std::uint64_t entry, program_headers, section_headers;
+            std::uint32_t flags;
+            std::uint16_t header_size, program_header_size, program_header_count;
+            std::uint16_t section_header_size, section_header_count, section_names;
+        };
+
+        struct program_header_t
+        {
+            std::uint32_t type, flags;
+            std::uint64_t offset, address, physical_address;
+            std::uint64_t file_size, memory_size, alignment;
+        };
+
+        struct note_header_t
+        {
+            std::uint32_t name_size, descriptor_size, type;
+        };
+
+        static_assert( sizeof( header_t ) == 64 && sizeof( program_header_t ) == 56 && sizeof( note_header_t ) == 12 );
+    }  // namespace elf_format
+
+    /// <summary>
+    /// A memory source backed by an ELF core file. Every loadable segment becomes a region, and the mapped files noted
+    /// in the core become modules.
+    /// </summary>
+    class elf_core_source final : public file_source
+    {
+       public:
+        /// <summary>
+        /// Opens a core file.
+        /// </summary>
+        /// <param name="path">The path of the core file.</param>
+        explicit elf_core_source( const std::filesystem::path& path );
+
+       private:
+        /// <summary>
+        /// Reads the notes in a note segment.
+        /// </summary>
+        void read_notes( const elf_format::program_header_t& segment );
+
+        /// <summary>
+        /// Reads the list of mapped files, turning every file into a module spanning all of its mappings.
+        /// </summary>
+        void read_file_note( const std::uint8_t* data, std::size_t size );
+    };
+}  // namespace extlib
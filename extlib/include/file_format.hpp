@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+
+namespace extlib::detail
+{
+    /// <summary>
+    /// Rounds an offset up to the 8 byte alignment every table of a saved file (dumps, image indices, persistent caches
+    /// and signature databases) starts on.
+    /// </summary>
+    constexpr std::uint64_t align8( std::uint64_t offset )
+    {
+        return ( offset + 7 ) & ~std::uint64_t{ 7 };
+    }
+
+    /// <summary>
+    /// Checks whether a table of `count` entries at `offset` starts on an 8 byte boundary and fits within a file.
+    /// </summary>
+    constexpr bool table_fits( std::uint64_t offset, std::uint64_t count, std::uint64_t entry_size, std::uint64_t file_size )
+    {
+        return offset % alignof( std::uint64_t ) == 0 && offset <= file_size &&
+               count <= ( file_size - offset ) / entry_size;
+    }
+
+    /// <summary>
+    /// Gets a table of a loaded file whose bounds `table_fits` has checked. The data starts on an 8 byte boundary (a
+    /// mapping is page aligned) and so does every table, so the table can be used in place.
+    /// </summary>
+    template< typename T >
+    const T* table_at( const std::uint8_t* data, std::uint64_t offset )
+    {
+        return reinterpret_cast< const T* >( data + offset );
+    }
+
+    /// <summary>
+    /// Throws for a file or blob that is not a valid instance of a format.
+    /// </summary>
+    /// <param name="origin">Where the data came from, as it should read in the message.</param>
+    /// <param name="format">The name of the format (e.g. "image index").</param>
+    /// <param name="reason">What is wrong with the data.</param>
+    [[noreturn]] void throw_corrupt( const std::string& origin, const char* format, const char* reason );
+
+    /// <summary>
+    /// Throws for a file that is not a valid instance of a format, naming the file by its path.
+    /// </summary>
+    [[noreturn]] void throw_corrupt( const std::filesystem::path& path, const char* format, const char* reason );
+
+    /// <summary>
+    /// Writes a table of a file written front to back, padding with zeros from the end of the previous table up to its
+    /// offset, which must lie at most 8 bytes further.
+    /// </summary>
+    void write_at( std::ostream& stream, std::uint64_t offset, const void* data, std::size_t size );
+}  // namespace extlib::detail
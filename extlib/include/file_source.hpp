@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "memory_source.hpp"
+#include "win/mapped_file.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// A base for memory sources whose contents are stored uncompressed in a mapped file, such as crash dumps. Derived
+    /// classes parse the file into a region map, a module list and the file offsets of every captured address range;
+    /// reads and views are then served straight from the mapping, so only the pages that are touched are ever loaded.
+    /// </summary>
+    class file_source : public memory_source
+    {
+       public:
+        std::vector< win::region_t > get_regions( std::uintptr_t start, std::uintptr_t end ) const override;
+
+        std::vector< module_info_t > get_modules() const override;
+
+        std::size_t read( std::uintptr_t address, void* buffer, std::size_t size ) const override;
+
+        const std::uint8_t* view( std::uintptr_t address, std::size_t size ) const override;
+
+       protected:
+        /// <summary>
+        /// Maps a file.
+        /// </summary>
+        /// <param name="path">The path of the file.</param>
+        explicit file_source( const std::filesystem::path& path );
+
+        /// <summary>
+        /// An address range whose contents are stored in the file.
+        /// </summary>
+        struct range_t
+        {
+            std::uintptr_t address;
+            std::size_t size;
+
+            /// <summary>
+            /// The file offset of the range's first byte.
+            /// </summary>
+            std::uint64_t offset;
+        };
+
+        /// <summary>
+        /// Adds a range of captured memory, throwing if it lies outside the file.
+        /// </summary>
+        void add_range( std::uintptr_t address, std::size_t size, std::uint64_t offset );
+
+        /// <summary>
+        /// Sorts the regions and ranges by address. Must be called once the file has been parsed.
+        /// </summary>
+        void sort();
+
+        /// <summary>
+        /// Gets a pointer to `size` bytes at a file offset, or nullptr if they lie outside the file.
+        /// </summary>
+        const std::uint8_t* at( std::uint64_t offset, std::size_t size ) const;
+
+        /// <summary>
+        /// Copies a structure out of the file, throwing if it lies outside the file.
+        /// </summary>
+        template< typename T >
+        T load( std::uint64_t offset ) const
+        {
+            const auto data = at( offset, sizeof( T ) );
+
+            if ( !data )
+                throw std::runtime_error( "A structure lies outside the file" );
+
+            T value;
+            std::memcpy( &value, data, sizeof( value ) );
+
+            return value;
+        }
+
+        std::unique_ptr< win::mapped_file > file;
+
+        std::vector< win::region_t > regions;
+        std::vector< module_info_t > modules;
+        std::vector< range_t > ranges;
+
+       private:
+        /// <summary>
+        /// Finds the range containing an address.
+        /// </summary>
+        const range_t* find_range( std::uintptr_t address ) const;
+    };
+}  // namespace extlib
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace extlib
+{
+    /// <summary>
+    /// Computes the 64-bit xxHash of a buffer. Fast enough to fingerprint memory at several gigabytes per second.
+    /// </summary>
+    /// <param name="data">The buffer to hash.</param>
+    /// <param name="size">The size of the buffer.</param>
+    /// <param name="seed">The seed for the hash.</param>
+    /// <returns>The hash.</returns>
+    std::uint64_t xxh64( const void* data, std::size_t size, std::uint64_t seed = 0 );
+}  // namespace extlib
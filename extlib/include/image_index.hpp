@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "scan.hpp"
+#include "win/mapped_file.hpp"
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// The on-disk layout of an image index: a header, the indexed bytes, the suffix array and the bucket table, each
+    /// starting on an 8 byte boundary. All fields are little-endian.
+    /// </summary>
+    namespace image_index_format
+    {
+        /// <summary>
+        /// "EXTLSAIX" in little-endian.
+        /// </summary>
+        constexpr std::uint64_t magic = 0x584941534C545845;
+
+        constexpr std::uint32_t version = 1;
+
+        /// <summary>
+        /// The number of entries in the bucket table, one per 2-byte prefix plus an end marker.
+        /// </summary>
+        constexpr std::size_t bucket_count = 0x10000 + 1;
+
+        struct header_t
+        {
+            std::uint64_t magic;
+            std::uint32_t version, reserved;
+
+            std::uint64_t base, size;
+            std::uint64_t text_offset, suffix_offset, bucket_offset;
+        };
+
+        static_assert( sizeof( header_t ) == 56 );
+    }  // namespace image_index_format
+
+    /// <summary>
+    /// A suffix array over a copy of a module's image, for answering many queries against the same image without
+    /// scanning it each time.
+    /// <para>
+    /// Exact patterns are located by binary search over the suffixes sharing their first two bytes, in time
+    /// proportional to the pattern's length times the logarithm of the image's size. Patterns with wildcards are
+    /// located through their longest run of concrete bytes, and every occurrence of it is then checked against the
+    /// whole pattern.
+    /// </para>
+    /// <para>
+    /// The array takes four bytes per byte of the image. Once built, an index can be saved and later mapped back into
+    /// memory without being rebuilt or copied.
+    /// </para>
+    /// </summary>
+    class image_index final
+    {
+       public:
+        /// <summary>
+        /// Indexes a copy of a module's image.
+        /// </summary>
+        /// <param name="module">The module to index, which can be backed by a live process or a memory source.</param>
+        /// <returns>The index.</returns>
+        static image_index build( const win::module_t& module );
+
+        /// <summary>
+        /// Indexes a block of bytes.
+        /// </summary>
+        /// <param name="base">The address the first byte is reported at.</param>
+        /// <param name="bytes">The bytes to index, which must be fewer than 2^31.</param>
+        /// <returns>The index.</returns>
+        static image_index build( std::uintptr_t base, std::vector< std::uint8_t > bytes );
+
+        /// <summary>
+        /// Maps an index saved by `save` into memory.
+        /// </summary>
+        /// <param name="path">The path of the saved index.</param>
+        /// <returns>The index, which keeps the file mapped for as long as it lives.</returns>
+        static image_index load( const std::filesystem::path& path );
+
+        image_index( image_index&& ) = default;
+        image_index& operator=( image_index&& ) = default;
+
+        image_index( const image_index& ) = delete;
+        image_index& operator=( const image_index& ) = delete;
+
+        /// <summary>
+        /// Saves the index, so it can be loaded again without being rebuilt.
+        /// </summary>
+        /// <param name="path">The path to save to.</param>
+        void save( const std::filesystem::path& path ) const;
+
+        /// <summary>
+        /// Counts the matches of a pattern.
+        /// </summary>
+        /// <param name="pattern">The pattern to count.</param>
+        /// <returns>The number of matches.</returns>
+        std::size_t count( const pattern_t& pattern ) const;
+
+        /// <summary>
+        /// Finds all matches of a pattern.
+        /// </summary>
+        /// <param name="pattern">The pattern to locate.</param>
+        /// <returns>The addresses of the matches, sorted.</returns>
+        std::vector< std::uintptr_t > find_all( const pattern_t& pattern ) const;
+
+        /// <summary>
+        /// Gets the address the indexed bytes start at.
+        /// </summary>
+        std::uintptr_t get_base() const;
+
+        /// <summary>
+        /// Gets the number of indexed bytes.
+        /// </summary>
+        std::size_t size() const;
+
+       private:
+        image_index() = default;
+
+        /// <summary>
+        /// Points the index at its own copies of the bytes and tables.
+        /// </summary>
+        void adopt();
+
+        /// <summary>
+        /// Gets the range of the suffix array whose suffixes start with the provided bytes.
+        /// </summary>
+        std::pair< std::size_t, std::size_t > locate( const std::uint8_t* bytes, std::size_t length ) const;
+
+        /// <summary>
+        /// Gets the offsets of every match of a pattern, unsorted.
+        /// </summary>
+        std::vector< std::uint32_t > match( const pattern_t& pattern ) const;
+
+        std::uintptr_t base = 0;
+        std::size_t length = 0;
+
+        const std::uint8_t* text = nullptr;
+        const std::uint32_t* suffixes = nullptr;
+
+        /// <summary>
+        /// The first suffix starting with each 2-byte prefix (first byte in the high bits), with a suffix made of a
+        /// single byte sorting first among the prefixes of that byte.
+        /// </summary>
+        const std::uint32_t* buckets = nullptr;
+
+        /// <summary>
+        /// The storage of an index that was built rather than loaded.
+        /// </summary>
+        std::vector< std::uint8_t > owned_text;
+        std::vector< std::uint32_t > owned_suffixes, owned_buckets;
+
+        /// <summary>
+        /// The file a loaded index points into.
+        /// </summary>
+        std::unique_ptr< win::mapped_file > file;
+    };
+}  // namespace extlib
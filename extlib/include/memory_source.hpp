@@ -0,0 +1,137 @@
+#pragma once
+
+#include <Windows.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "win/region.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// Describes a module loaded into a memory source.
+    /// </summary>
+    struct module_info_t
+    {
+        /// <summary>
+        /// The base name of the module (e.g. `kernel32.dll`).
+        /// </summary>
+        std::string name;
+
+        /// <summary>
+        /// The base address and size of the module's image.
+        /// </summary>
+        std::uintptr_t base;
+        std::size_t size;
+    };
+
+    /// <summary>
+    /// Something that can be read like the address space of a process: a live process, a dump, a file on disk, etc.
+    /// </summary>
+    class memory_source
+    {
+       public:
+        virtual ~memory_source() = default;
+
+        /// <summary>
+        /// Gets every region overlapping an address range.
+        /// </summary>
+        /// <param name="start">The start address.</param>
+        /// <param name="end">The end address.</param>
+        /// <returns>A list of regions, sorted by address.</returns>
+        virtual std::vector< win::region_t > get_regions( std::uintptr_t start, std::uintptr_t end ) const = 0;
+
+        /// <summary>
+        /// Gets the modules loaded into the source.
+        /// </summary>
+        virtual std::vector< module_info_t > get_modules() const = 0;
+
+        /// <summary>
+        /// Reads memory at a location into a buffer.
+        /// </summary>
+        /// <param name="address">The location to read from.</param>
+        /// <param name="buffer">The buffer that receives the bytes.</param>
+        /// <param name="size">The number of bytes to read.</param>
+        /// <returns>The number of bytes read, which is less than `size` if the read failed part way.</returns>
+        virtual std::size_t read( std::uintptr_t address, void* buffer, std::size_t size ) const = 0;
+
+        /// <summary>
+        /// Gets a pointer to memory the source already holds contiguously, so it can be used without copying.
+        /// </summary>
+        /// <param name="address">The location of the memory.</param>
+        /// <param name="size">The number of bytes needed.</param>
+        /// <returns>A pointer to the bytes, or nullptr if they have to be read.</returns>
+        virtual const std::uint8_t* view( std::uintptr_t address, std::size_t size ) const;
+
+        /// <summary>
+        /// Reads memory at a location into a buffer, throwing if any of it cannot be read.
+        /// </summary>
+        /// <param name="address">The location to read from.</param>
+        /// <param name="buffer">The buffer that receives the bytes.</param>
+        /// <param name="size">The number of bytes to read.</param>
+        void read_exact( std::uintptr_t address, void* buffer, std::size_t size ) const;
+    };
+
+    /// <summary>
+    /// A memory source backed by a live process.
+    /// </summary>
+    class process_source final : public memory_source
+    {
+       public:
+        /// <summary>
+        /// Creates a new process memory source.
+        /// </summary>
+        /// <param name="handle">The handle to the process (needs `PROCESS_QUERY_INFORMATION | PROCESS_VM_READ`).</param>
+        explicit process_source( HANDLE handle );
+
+        std::vector< win::region_t > get_regions( std::uintptr_t start, std::uintptr_t end ) const override;
+
+        std::vector< module_info_t > get_modules() const override;
+
+        std::size_t read( std::uintptr_t address, void* buffer, std::size_t size ) const override;
+
+       private:
+        HANDLE handle;
+    };
+
+    /// <summary>
+    /// A memory source over bytes held in memory, presented as a single module loaded at a base address. Lets images
+    /// built or captured locally (e.g. synthetic images for benchmarks) be analysed as if they were in a process.
+    /// </summary>
+    class buffer_source final : public memory_source
+    {
+       public:
+        /// <summary>
+        /// Creates a new buffer memory source.
+        /// </summary>
+        /// <param name="bytes">The module's image, laid out as it is once loaded.</param>
+        /// <param name="base">The address to present the image at.</param>
+        /// <param name="name">The name of the module.</param>
+        buffer_source( std::vector< std::uint8_t > bytes, std::uintptr_t base, std::string name = "image.exe" );
+
+        std::vector< win::region_t > get_regions( std::uintptr_t start, std::uintptr_t end ) const override;
+
+        std::vector< module_info_t > get_modules() const override;
+
+        std::size_t read( std::uintptr_t address, void* buffer, std::size_t size ) const override;
+
+        const std::uint8_t* view( std::uintptr_t address, std::size_t size ) const override;
+
+        /// <summary>
+        /// Gets the address the image is presented at.
+        /// </summary>
+        std::uintptr_t get_base() const;
+
+        /// <summary>
+        /// Gets the size of the image.
+        /// </summary>
+        std::size_t get_size() const;
+
+       private:
+        std::vector< std::uint8_t > bytes;
+        std::uintptr_t base;
+        std::string name;
+    };
+}  // namespace extlib
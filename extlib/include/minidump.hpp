@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "file_source.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// The parts of the minidump format the reader understands. Minidumps are parsed by hand rather than through
+    /// DbgHelp, so the structures are spelled out here with the packing the format uses.
+    /// </summary>
+    namespace minidump_format
+    {
+        /// <summary>
+        /// "MDMP" in little-endian.
+        /// </summary>
+        constexpr std::uint32_t signature = 0x504D444D;
+
+        constexpr std::uint32_t module_list_stream = 4;
+        constexpr std::uint32_t memory_list_stream = 5;
+        constexpr std::uint32_t memory64_list_stream = 9;
+        constexpr std::uint32_t memory_info_list_stream = 16;
+
+#pragma pack( push, 4 )
+        struct header_t
+        {
+            std::uint32_t signature, version;
+            std::uint32_t stream_count, stream_directory;
+            std::uint32_t checksum, timestamp;
+            std::uint64_t flags;
+        };
+
+        struct location_t
+        {
+            std::uint32_t size, offset;
+        };
+
+        struct directory_t
+        {
+            std::uint32_t type;
+            location_t location;
+        };
+
+        struct module_t
+        {
+            std::uint64_t base;
+            std::uint32_t size, checksum, timestamp;
+
+            /// <summary>
+            /// The offset of the module's path, stored as a length-prefixed UTF-16 string.
+            /// </summary>
+            std::uint32_t name_offset;
+
+            std::uint32_t version_info[ 13 ];
+            location_t cv_record, misc_record;
+            std::uint64_t reserved[ 2 ];
+        };
+
+        struct memory_descriptor_t
+        {
+            std::uint64_t start;
+            location_t memory;
+        };
+
+        struct memory_descriptor64_t
+        {
+            std::uint64_t start, size;
+        };
+
+        struct memory_info_t
+        {
+            std::uint64_t base, allocation_base;
+            std::uint32_t allocation_protect, alignment1;
+            std::uint64_t size;
+            std::uint32_t state, protect, type, alignment2;
+        };
+#pragma pack( pop )
+
+        static_assert( sizeof( header_t ) == 32 && sizeof( directory_t ) == 12 && sizeof( module_t ) == 108 );
+        static_assert( sizeof( memory_descriptor_t ) == 16 && sizeof( memory_descriptor64_t ) == 16 );
+        static_assert( sizeof( memory_info_t ) == 48 );
+    }  // namespace minidump_format
+
+    /// <summary>
+    /// A memory source backed by a Windows minidump (`.dmp`). Both full (64-bit memory list) and partial dumps are
+    /// supported. The region map comes from the dump's memory info list when it has one, and is otherwise made up from
+    /// the captured ranges.
+    /// </summary>
+    class minidump_source final : public file_source
+    {
+       public:
+        /// <summary>
+        /// Opens a minidump.
+        /// </summary>
+        /// <param name="path">The path of the minidump.</param>
+        explicit minidump_source( const std::filesystem::path& path );
+
+       private:
+        /// <summary>
+        /// Reads the module list stream.
+        /// </summary>
+        void read_modules( const minidump_format::location_t& location );
+
+        /// <summary>
+        /// Reads the 32-bit memory list stream of a partial dump.
+        /// </summary>
+        void read_memory( const minidump_format::location_t& location );
+
+        /// <summary>
+        /// Reads the 64-bit memory list stream of a full dump.
+        /// </summary>
+        void read_memory64( const minidump_format::location_t& location );
+
+        /// <summary>
+        /// Reads the memory info list stream.
+        /// </summary>
+        void read_memory_info( const minidump_format::location_t& location );
+    };
+}  // namespace extlib
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// Identifies the contents of a module image, independently of where it is loaded.
+    /// </summary>
+    struct module_fingerprint_t
+    {
+        /// <summary>
+        /// Fingerprints a module. The header fields are read from the module's headers, and the content hash covers
+        /// `.text` and `.rdata` with every relocated value turned back into what it is at the preferred base, so
+        /// copies of an image loaded at different bases fingerprint the same.
+        /// </summary>
+        /// <param name="module">The module to fingerprint.</param>
+        /// <param name="hash_contents">Whether to hash the contents at all. Without it, only the headers are read and
+        /// the content hash is 0.</param>
+        /// <returns>The fingerprint.</returns>
+        static module_fingerprint_t compute( const win::module_t& module, bool hash_contents = true );
+
+        bool operator==( const module_fingerprint_t& other ) const;
+        bool operator!=( const module_fingerprint_t& other ) const;
+
+        std::uint32_t timestamp, checksum, image_size;
+        std::uint64_t content_hash;
+    };
+
+    /// <summary>
+    /// Remembers the fingerprints of the modules seen, so that each module is only fingerprinted once however often a
+    /// cache is asked about it. Modules are told apart by the process (or memory source) they belong to and their
+    /// bounds, and forgotten once their process exits or their source is released.
+    /// </summary>
+    class fingerprint_memo final
+    {
+       public:
+        /// <summary>
+        /// Gets the fingerprint of a module, computing it only the first time the module is seen.
+        /// </summary>
+        /// <param name="module">The module to fingerprint.</param>
+        /// <param name="hash_contents">Whether to hash the contents, which must be the same on every call.</param>
+        /// <returns>The fingerprint.</returns>
+        module_fingerprint_t get( const win::module_t& module, bool hash_contents = true );
+
+        /// <summary>
+        /// Forgets every fingerprint.
+        /// </summary>
+        void clear();
+
+       private:
+        /// <summary>
+        /// The fingerprint of a module, remembered under what it belongs to and its bounds.
+        /// </summary>
+        struct known_module_t
+        {
+            /// <summary>
+            /// The memory source the module is read from, or empty for a module of a live process. It is held weakly,
+            /// which keeps another source from taking its identity while the entry exists.
+            /// </summary>
+            std::weak_ptr< const memory_source > source;
+
+            /// <summary>
+            /// The id and creation time of the live process the module belongs to, or 0. Unlike a handle's value, they
+            /// are never reused by another process.
+            /// </summary>
+            std::uint64_t process_id, process_created;
+
+            std::uintptr_t base;
+            std::size_t size;
+
+            module_fingerprint_t fingerprint;
+        };
+
+        /// <summary>
+        /// Forgets the modules of every source released and every process exited. The mutex must be held.
+        /// </summary>
+        void prune();
+
+        std::mutex mutex;
+
+        std::vector< known_module_t > known_modules;
+    };
+
+    /// <summary>
+    /// Shares module-relative results (signature matches, RTTI lookups, cross references and the like) between every
+    /// module with the same fingerprint, such as one executable loaded by many instances of a program.
+    /// <para>
+    /// Results are stored as offsets from the module's base and rebased onto whichever module asks for them. When
+    /// several modules ask for the same result at once, it is computed once and the others wait for it.
+    /// </para>
+    /// </summary>
+    class module_cache final
+    {
+       public:
+        /// <summary>
+        /// Computes a list of addresses within a module, or returns the one already computed for a module with the
+        /// same fingerprint, rebased onto this one.
+        /// </summary>
+        /// <param name="module">The module the addresses are for.</param>
+        /// <param name="key">What the addresses are (e.g. a pattern), unique among the results cached for a module.</param>
+        /// <param name="compute">Computes the addresses. Every address must lie within the module.</param>
+        /// <returns>The addresses within `module`.</returns>
+        std::vector< std::uintptr_t > get_or_compute(
+            const win::module_t& module,
+            std::string_view key,
+            const std::function< std::vector< std::uintptr_t >( const win::module_t& ) >& compute );
+
+        /// <summary>
+        /// Gets the fingerprint of a module, computing it only the first time a module at that base is seen.
+        /// </summary>
+        /// <param name="module">The module to fingerprint.</param>
+        /// <returns>The fingerprint.</returns>
+        module_fingerprint_t get_fingerprint( const win::module_t& module );
+
+        /// <summary>
+        /// Forgets every cached result and fingerprint.
+        /// </summary>
+        void clear();
+
+       private:
+        struct fingerprint_hash_t
+        {
+            std::size_t operator()( const module_fingerprint_t& fingerprint ) const;
+        };
+
+        std::mutex mutex;
+
+        fingerprint_memo fingerprints;
+
+        /// <summary>
+        /// The offsets of every cached result, by fingerprint and then by key.
+        /// </summary>
+        std::unordered_map<
+            module_fingerprint_t,
+            std::unordered_map< std::string, std::shared_future< std::vector< std::uint64_t > > >,
+            fingerprint_hash_t >
+            results;
+    };
+}  // namespace extlib
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "win/win.hpp"
+
+/// <summary>
+/// Readers for the standard containers of a 64-bit process built with MSVC, which read the containers' memory layouts
+/// directly. Contiguous storage is fetched in one read, and node-based containers are walked a level at a time, with
+/// every node of a level read in one batch.
+/// <para>
+/// Elements are copied byte for byte, so element types must be trivially copyable and laid out like the target's.
+/// Containers of strings are read as containers of `string_t`, whose strings are then read with `read_strings`.
+/// </para>
+/// </summary>
+namespace extlib::msvc
+{
+    /// <summary>
+    /// Bounds on what a reader accepts, so a corrupt or stale container fails quickly instead of reading garbage.
+    /// </summary>
+    struct container_limits_t
+    {
+        /// <summary>
+        /// The most elements a container can have.
+        /// </summary>
+        std::size_t max_elements = 0x100000;
+
+        /// <summary>
+        /// The most characters a string can have.
+        /// </summary>
+        std::size_t max_string_length = 0x10000;
+    };
+
+    /// <summary>
+    /// The layout of `std::string` and `std::wstring`: a small-string buffer that holds a pointer once the string no
+    /// longer fits into it, followed by the length and the capacity.
+    /// </summary>
+    struct string_t
+    {
+        std::uint8_t buffer[ 16 ];
+        std::uint64_t size, capacity;
+    };
+
+    static_assert( sizeof( string_t ) == 32 );
+
+    /// <summary>
+    /// The layout of `std::pair< const K, V >`, as stored in maps.
+    /// </summary>
+    template< typename K, typename V >
+    struct pair_t
+    {
+        K first;
+        V second;
+    };
+
+    namespace detail
+    {
+        /// <summary>
+        /// Reads the elements of a `std::vector`.
+        /// </summary>
+        /// <returns>The bytes of the elements.</returns>
+        std::vector< std::uint8_t > read_vector(
+            const win::module_t& module,
+            std::uintptr_t address,
+            std::size_t element_size,
+            const container_limits_t& limits );
+
+        /// <summary>
+        /// Reads the values of a `std::list`, in order.
+        /// </summary>
+        /// <returns>The bytes of the values, one after another.</returns>
+        std::vector< std::uint8_t > read_list(
+            const win::module_t& module,
+            std::uintptr_t address,
+            std::size_t value_size,
+            std::size_t value_alignment,
+            const container_limits_t& limits );
+
+        /// <summary>
+        /// Reads the values of a `std::map` or `std::set`, in order.
+        /// </summary>
+        /// <returns>The bytes of the values, one after another.</returns>
+        std::vector< std::uint8_t > read_tree(
+            const win::module_t& module,
+            std::uintptr_t address,
+            std::size_t value_size,
+            std::size_t value_alignment,
+            const container_limits_t& limits );
+
+        /// <summary>
+        /// Reads the values of a `std::unordered_map` or `std::unordered_set`, in iteration order.
+        /// </summary>
+        /// <returns>The bytes of the values, one after another.</returns>
+        std::vector< std::uint8_t > read_hash(
+            const win::module_t& module,
+            std::uintptr_t address,
+            std::size_t value_size,
+            std::size_t value_alignment,
+            const container_limits_t& limits );
+
+        /// <summary>
+        /// Turns the bytes of consecutive values into values.
+        /// </summary>
+        template< typename T >
+        std::vector< T > to_values( const std::vector< std::uint8_t >& bytes )
+        {
+            static_assert( std::is_trivially_copyable_v< T >, "container elements are copied byte for byte" );
+
+            std::vector< T > values( bytes.size() / sizeof( T ) );
+
+            if ( !values.empty() )
+                std::memcpy( values.data(), bytes.data(), values.size() * sizeof( T ) );
+
+            return values;
+        }
+    }  // namespace detail
+
+    /// <summary>
+    /// Reads a `std::string`. Short strings are held inline and need one read; longer ones need a second.
+    /// </summary>
+    /// <param name="module">The module to read through.</param>
+    /// <param name="address">The address of the string object.</param>
+    /// <param name="limits">The bounds on the string.</param>
+    /// <returns>The string.</returns>
+    std::string read_string( const win::module_t& module, std::uintptr_t address, const container_limits_t& limits = {} );
+
+    /// <summary>
+    /// Reads a `std::wstring`, whose characters are two bytes in the target.
+    /// </summary>
+    /// <param name="module">The module to read through.</param>
+    /// <param name="address">The address of the string object.</param>
+    /// <param name="limits">The bounds on the string.</param>
+    /// <returns>The string.</returns>
+    std::wstring read_wstring( const win::module_t& module, std::uintptr_t address, const container_limits_t& limits = {} );
+
+    /// <summary>
+    /// Reads many `std::string`s in two batches: one for every string object, and one for the characters of every
+    /// string too long to be held inline.
+    /// </summary>
+    /// <param name="module">The module to read through.</param>
+    /// <param name="addresses">The addresses of the string objects (e.g. the elements of a `std::vector< std::string >`
+    /// read as `string_t`s are at consecutive multiples of 32 from its storage).</param>
+    /// <param name="limits">The bounds on every string.</param>
+    /// <returns>The strings in the same order, or nothing for a string that could not be read or is out of bounds.</returns>
+    std::vector< std::optional< std::string > > read_strings(
+        const win::module_t& module,
+        const std::vector< std::uintptr_t >& addresses,
+        const container_limits_t& limits = {} );
+
+    /// <summary>
+    /// Reads the elements of a `std::vector< T >` in one read.
+    /// </summary>
+    /// <param name="module">The module to read through.</param>
+    /// <param name="address">The address of the vector object.</param>
+    /// <param name="limits">The bounds on the vector.</param>
+    /// <returns>The elements.</returns>
+    template< typename T >
+    std::vector< T >
+    read_vector( const win::module_t& module, std::uintptr_t address, const container_limits_t& limits = {} )
+    {
+        return detail::to_values< T >( detail::read_vector( module, address, sizeof( T ), limits ) );
+    }
+
+    /// <summary>
+    /// Reads the elements of a `std::list< T >`. Each node is read together with its value, but as every node is
+    /// only found through the one before it, the nodes are read one at a time.
+    /// </summary>
+    /// <param name="module">The module to read through.</param>
+    /// <param name="address">The address of the list object.</param>
+    /// <param name="limits">The bounds on the list.</param>
+    /// <returns>The elements, in order.</returns>
+    template< typename T >
+    std::vector< T >
+    read_list( const win::module_t& module, std::uintptr_t address, const container_limits_t& limits = {} )
+    {
+        return detail::to_values< T >( detail::read_list( module, address, sizeof( T ), alignof( T ), limits ) );
+    }
+
+    /// <summary>
+    /// Reads the elements of a `std::set< T >`. The tree is read a level at a time, so it takes one batch per level.
+    /// </summary>
+    /// <param name="module">The module to read through.</param>
+    /// <param name="address">The address of the set object.</param>
+    /// <param name="limits">The bounds on the set.</param>
+    /// <returns>The elements, in order.</returns>
+    template< typename T >
+    std::vector< T >
+    read_set( const win::module_t& module, std::uintptr_t address, const container_limits_t& limits = {} )
+    {
+        return detail::to_values< T >( detail::read_tree( module, address, sizeof( T ), alignof( T ), limits ) );
+    }
+
+    /// <summary>
+    /// Reads the entries of a `std::map< K, V >`, as `read_set` does.
+    /// </summary>
+    /// <param name="module">The module to read through.</param>
+    /// <param name="address">The address of the map object.</param>
+    /// <param name="limits">The bounds on the map.</param>
+    /// <returns>The entries, in order.</returns>
+    template< typename K, typename V >
+    std::vector< pair_t< K, V > >
+    read_map( const win::module_t& module, std::uintptr_t address, const container_limits_t& limits = {} )
+    {
+        return read_set< pair_t< K, V > >( module, address, limits );
+    }
+
+    /// <summary>
+    /// Reads the entries of a `std::unordered_map< K, V >`. The bucket table is read in one go, and the buckets are
+    /// then walked side by side, reading the next node of every bucket in one batch.
+    /// </summary>
+    /// <param name="module">The module to read through.</param>
+    /// <param name="address">The address of the map object.</param>
+    /// <param name="limits">The bounds on the map.</param>
+    /// <returns>The entries, in iteration order.</returns>
+    template< typename K, typename V >
+    std::vector< pair_t< K, V > >
+    read_unordered_map( const win::module_t& module, std::uintptr_t address, const container_limits_t& limits = {} )
+    {
+        using entry_t = pair_t< K, V >;
+
+        return detail::to_values< entry_t >(
+            detail::read_hash( module, address, sizeof( entry_t ), alignof( entry_t ), limits ) );
+    }
+
+    /// <summary>
+    /// Reads the elements of a `std::unordered_set< T >`, as `read_unordered_map` does.
+    /// </summary>
+    /// <param name="module">The module to read through.</param>
+    /// <param name="address">The address of the set object.</param>
+    /// <param name="limits">The bounds on the set.</param>
+    /// <returns>The elements, in iteration order.</returns>
+    template< typename T >
+    std::vector< T >
+    read_unordered_set( const win::module_t& module, std::uintptr_t address, const container_limits_t& limits = {} )
+    {
+        return detail::to_values< T >( detail::read_hash( module, address, sizeof( T ), alignof( T ), limits ) );
+    }
+}  // namespace extlib::msvc
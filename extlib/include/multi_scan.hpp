@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "process.hpp"
+#include "scan.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// Which memory of each process a multi-process scan covers.
+    /// </summary>
+    enum class multi_scan_scope_t : std::uint8_t
+    {
+        /// <summary>
+        /// The image of each process's main module.
+        /// </summary>
+        main_module,
+
+        /// <summary>
+        /// Every committed private or image region of each process.
+        /// </summary>
+        all_memory,
+    };
+
+    /// <summary>
+    /// Options for scanning several processes at once.
+    /// </summary>
+    struct multi_scan_options_t
+    {
+        multi_scan_scope_t scope = multi_scan_scope_t::main_module;
+
+        /// <summary>
+        /// The size of the pieces regions are split into. Every piece is a separate task on the pool, so smaller
+        /// pieces balance better across processes of uneven size.
+        /// </summary>
+        std::size_t chunk_size = 0x100000;
+    };
+
+    /// <summary>
+    /// Scans many processes for many patterns at once.
+    /// </summary>
+    class multi_scanner final
+    {
+       public:
+        /// <summary>
+        /// Scans several processes for a set of patterns. The readable regions of every process are split into chunks,
+        /// and the chunks of all processes are scanned together on the shared thread pool, all matching against the
+        /// one compiled pattern set.
+        /// </summary>
+        /// <param name="processes">The processes to scan (e.g. from `process::get_all_by_name`).</param>
+        /// <param name="patterns">The patterns to scan for.</param>
+        /// <param name="options">Where and how to scan.</param>
+        /// <returns>For every process id, the sorted matches of every pattern, in the order of the set.</returns>
+        static std::unordered_map< std::uint64_t, std::vector< std::vector< std::uintptr_t > > > scan(
+            const std::vector< std::unique_ptr< process > >& processes,
+            const pattern_set& patterns,
+            const multi_scan_options_t& options = {} );
+    };
+}  // namespace extlib
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// A batch of writes to a remote process. Writes are collected first and applied together: contiguous and
+    /// overlapping writes are coalesced, page protection is changed once per run of pages, and the original bytes are
+    /// recorded so the whole set can be rolled back in one call.
+    /// </summary>
+    class patch_set final
+    {
+       public:
+        /// <summary>
+        /// Creates a new, empty patch set. The handle needs `PROCESS_VM_READ`, `PROCESS_VM_WRITE` and
+        /// `PROCESS_VM_OPERATION` access.
+        /// </summary>
+        /// <param name="handle">The handle to the target process.</param>
+        explicit patch_set( win::handle_t handle );
+
+        /// <summary>
+        /// Queues a write. Later writes take precedence where they overlap earlier ones.
+        /// </summary>
+        /// <param name="address">The location to write to.</param>
+        /// <param name="data">The bytes to write.</param>
+        /// <param name="length">The number of bytes to write.</param>
+        void write( std::uintptr_t address, const void* data, std::size_t length );
+
+        /// <summary>
+        /// Queues a write.
+        /// </summary>
+        /// <param name="address">The location to write to.</param>
+        /// <param name="bytes">The bytes to write.</param>
+        void write( std::uintptr_t address, const std::vector< std::uint8_t >& bytes );
+
+        /// <summary>
+        /// Queues a write of an object of type T.
+        /// </summary>
+        /// <typeparam name="T">The type of the object.</typeparam>
+        /// <param name="address">The location to write to.</param>
+        /// <param name="value">The object to write.</param>
+        template< typename T >
+        void write( std::uintptr_t address, const T& value )
+        {
+            static_assert( std::is_trivially_copyable_v< T >, "patch values must be trivially copyable" );
+
+            write( address, std::addressof( value ), sizeof( T ) );
+        }
+
+        /// <summary>
+        /// Applies every queued write, recording the bytes they replace.
+        /// </summary>
+        void apply();
+
+        /// <summary>
+        /// Restores the bytes recorded by the last `apply`.
+        /// </summary>
+        void rollback();
+
+        /// <summary>
+        /// Discards every queued write. An applied set is not rolled back.
+        /// </summary>
+        void clear();
+
+        /// <summary>
+        /// Specifies whether or not the set is currently applied.
+        /// </summary>
+        bool is_applied() const;
+
+        /// <summary>
+        /// Gets the number of contiguous runs the queued writes coalesce into.
+        /// </summary>
+        std::size_t run_count() const;
+
+       private:
+        /// <summary>
+        /// A single queued write.
+        /// </summary>
+        struct write_t
+        {
+            std::uintptr_t address;
+            std::vector< std::uint8_t > bytes;
+        };
+
+        /// <summary>
+        /// A contiguous range of coalesced writes.
+        /// </summary>
+        struct run_t
+        {
+            std::uintptr_t address;
+            std::vector< std::uint8_t > bytes, original;
+        };
+
+        /// <summary>
+        /// Coalesces the queued writes into sorted, disjoint runs.
+        /// </summary>
+        std::vector< run_t > compile() const;
+
+        /// <summary>
+        /// Makes the pages under every run writable, writes either the new or the original bytes, then restores the
+        /// protection and flushes the instruction cache for executable pages.
+        /// </summary>
+        void commit( bool restore );
+
+        win::handle_t handle;
+
+        std::vector< write_t > writes;
+        std::vector< run_t > runs;
+
+        bool applied;
+    };
+}  // namespace extlib
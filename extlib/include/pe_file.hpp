@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+#include "file_source.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// A memory source presenting a portable executable on disk as if it had been loaded, with every section at its
+    /// virtual address. Relocations and imports are not applied. Useful for analysing a module without running it.
+    /// </summary>
+    class pe_file_source final : public file_source
+    {
+       public:
+        /// <summary>
+        /// Opens a portable executable.
+        /// </summary>
+        /// <param name="path">The path of the file.</param>
+        /// <param name="base">The address to present the image at, or its preferred image base if empty.</param>
+        explicit pe_file_source( const std::filesystem::path& path, std::optional< std::uintptr_t > base = std::nullopt );
+
+        /// <summary>
+        /// Gets the address the image is presented at.
+        /// </summary>
+        std::uintptr_t get_base() const;
+
+        /// <summary>
+        /// Gets the size of the image once loaded.
+        /// </summary>
+        std::size_t get_size() const;
+
+       private:
+        std::uintptr_t base;
+        std::size_t size;
+    };
+}  // namespace extlib
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "module_cache.hpp"
+#include "scan.hpp"
+#include "win/mapped_file.hpp"
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// The on-disk layout of a persistent cache: a header, then the module, result and hit tables and the key strings,
+    /// each starting on an 8 byte boundary. Results are sorted by module and then key, so they can be searched in
+    /// place once the file is mapped. All fields are little-endian.
+    /// </summary>
+    namespace persistent_cache_format
+    {
+        /// <summary>
+        /// "EXTLRCCH" in little-endian.
+        /// </summary>
+        constexpr std::uint64_t magic = 0x484343524C545845;
+
+        constexpr std::uint32_t version = 1;
+
+        /// <summary>
+        /// The most bytes kept at every hit for checking that the module still holds what was found there.
+        /// </summary>
+        constexpr std::size_t check_size = 16;
+
+        struct header_t
+        {
+            std::uint64_t magic;
+            std::uint32_t version, reserved;
+
+            std::uint64_t module_count, result_count, hit_count, string_size;
+            std::uint64_t module_offset, result_offset, hit_offset, string_offset;
+        };
+
+        static_assert( sizeof( header_t ) == 80 );
+
+        struct module_t
+        {
+            std::uint32_t timestamp, checksum, image_size, reserved;
+            std::uint64_t content_hash;
+
+            /// <summary>
+            /// The module's results, as a range of the result table.
+            /// </summary>
+            std::uint64_t first_result, result_count;
+        };
+
+        static_assert( sizeof( module_t ) == 40 );
+
+        struct result_t
+        {
+            /// <summary>
+            /// The key, as a range of the string table.
+            /// </summary>
+            std::uint64_t key_offset, key_size;
+
+            /// <summary>
+            /// The hits, as a range of the hit table.
+            /// </summary>
+            std::uint64_t first_hit, hit_count;
+        };
+
+        static_assert( sizeof( result_t ) == 32 );
+
+        struct hit_t
+        {
+            std::uint32_t rva;
+
+            /// <summary>
+            /// The number of bytes of `check` in use, which is fewer than `check_size` for hits near the module's end.
+            /// </summary>
+            std::uint32_t check_length;
+
+            std::uint8_t check[ check_size ];
+        };
+
+        static_assert( sizeof( hit_t ) == 24 );
+    }  // namespace persistent_cache_format
+
+    /// <summary>
+    /// What a persistent cache has been asked for since it was opened.
+    /// </summary>
+    struct persistent_cache_stats_t
+    {
+        /// <summary>
+        /// Results served from the cache.
+        /// </summary>
+        std::size_t hits;
+
+        /// <summary>
+        /// Results that had to be computed, as the cache had none for the module's build.
+        /// </summary>
+        std::size_t misses;
+
+        /// <summary>
+        /// Results the cache had, but which were computed again because the module no longer held the cached bytes.
+        /// </summary>
+        std::size_t stale;
+    };
+
+    /// <summary>
+    /// Keeps module-relative results (signature matches, RTTI lookups, cross references and the like) across runs, so
+    /// a program attaching to a build of a target it has seen before skips the scans entirely.
+    /// <para>
+    /// Results are keyed by the module's build, told apart by the timestamp, checksum and image size in its headers
+    /// (and, optionally, a hash of its code). Every hit keeps the first bytes found at it, and a cached result is only
+    /// used once those bytes have been read back, all hits at once, and still match.
+    /// </para>
+    /// <para>
+    /// A loaded cache maps its file and searches it in place. Results computed since are kept in memory until the cache
+    /// is saved again.
+    /// </para>
+    /// </summary>
+    class persistent_cache final
+    {
+       public:
+        /// <summary>
+        /// Creates an empty cache.
+        /// </summary>
+        /// <param name="hash_contents">Whether builds are also told apart by hashing their `.text` and `.rdata`, which
+        /// is only needed for targets rebuilt without their headers changing.</param>
+        explicit persistent_cache( bool hash_contents = false );
+
+        /// <summary>
+        /// Maps a cache saved by `save` into memory.
+        /// </summary>
+        /// <param name="path">The path of the saved cache.</param>
+        /// <param name="hash_contents">Whether builds are also told apart by hashing their contents, which must be
+        /// what the cache was saved with.</param>
+        /// <returns>The cache, which keeps the file mapped for as long as it lives.</returns>
+        static persistent_cache load( const std::filesystem::path& path, bool hash_contents = false );
+
+        /// <summary>
+        /// Loads a cache if there is a valid one, or creates an empty one otherwise, so a missing or damaged cache
+        /// file only costs a cold start.
+        /// </summary>
+        /// <param name="path">The path of the saved cache.</param>
+        /// <param name="hash_contents">Whether builds are also told apart by hashing their contents.</param>
+        /// <returns>The cache.</returns>
+        static persistent_cache open( const std::filesystem::path& path, bool hash_contents = false );
+
+        /// <summary>
+        /// Gets a list of addresses within a module from the cache, or computes it if the cache has none for the
+        /// module's build or the module no longer holds the bytes at the cached addresses.
+        /// </summary>
+        /// <param name="module">The module the addresses are for.</param>
+        /// <param name="key">What the addresses are (e.g. `rtti:extlib::scan`), unique among a module's results.</param>
+        /// <param name="compute">Computes the addresses. Every address must lie within the module.</param>
+        /// <returns>The addresses within `module`.</returns>
+        std::vector< std::uintptr_t > get_or_compute(
+            const win::module_t& module,
+            std::string_view key,
+            const std::function< std::vector< std::uintptr_t >( const win::module_t& ) >& compute );
+
+        /// <summary>
+        /// Finds all matches of a pattern in a module, as `module_t::find_all` does, through the cache.
+        /// </summary>
+        /// <param name="module">The module to search.</param>
+        /// <param name="pattern">The pattern to use.</param>
+        /// <returns>A list of locations.</returns>
+        std::vector< std::uintptr_t > find_all( const win::module_t& module, const pattern_t& pattern );
+
+        /// <summary>
+        /// Saves every result, loaded or computed, so the next run can load them. The loaded file is unmapped first and
+        /// its results are kept in memory, so it can be overwritten.
+        /// </summary>
+        /// <param name="path">The path to save to, which may be the file the cache was loaded from.</param>
+        void save( const std::filesystem::path& path );
+
+        /// <summary>
+        /// Gets how many results were served from the cache and how many were computed.
+        /// </summary>
+        persistent_cache_stats_t get_stats() const;
+
+       private:
+        /// <summary>
+        /// A result held in memory: computed since the cache was loaded, or taken from the file when it was unmapped.
+        /// </summary>
+        struct computed_t
+        {
+            module_fingerprint_t fingerprint;
+            std::string key;
+            std::vector< persistent_cache_format::hit_t > hits;
+
+            /// <summary>
+            /// Whether the hits are known to match the module, rather than still to be checked.
+            /// </summary>
+            bool checked;
+        };
+
+        struct state_t
+        {
+            bool hash_contents = false;
+
+            std::mutex mutex;
+
+            /// <summary>
+            /// The file of a loaded cache, and its tables.
+            /// </summary>
+            std::unique_ptr< win::mapped_file > file;
+
+            const persistent_cache_format::module_t* modules = nullptr;
+            const persistent_cache_format::result_t* results = nullptr;
+            const persistent_cache_format::hit_t* hits = nullptr;
+            const char* strings = nullptr;
+
+            std::size_t module_count = 0;
+
+            /// <summary>
+            /// The results held in memory, by fingerprint and key, which replace any loaded ones.
+            /// </summary>
+            std::unordered_map< std::string, computed_t > computed;
+
+            fingerprint_memo fingerprints;
+
+            persistent_cache_stats_t stats{};
+        };
+
+        /// <summary>
+        /// Finds the hits the loaded file has for a result. The mutex must be held for as long as the hits are used, as
+        /// `save` unmaps the file.
+        /// </summary>
+        /// <returns>The hits and their number, or nullptr if the file has none.</returns>
+        std::pair< const persistent_cache_format::hit_t*, std::size_t >
+        find_loaded( const module_fingerprint_t& fingerprint, std::string_view key ) const;
+
+        /// <summary>
+        /// Checks that a module still holds the bytes kept at every hit, reading them all in one batch.
+        /// </summary>
+        static bool check( const win::module_t& module, const persistent_cache_format::hit_t* hits, std::size_t count );
+
+        /// <summary>
+        /// Records the bytes at every address of a computed result.
+        /// </summary>
+        static std::vector< persistent_cache_format::hit_t >
+        capture( const win::module_t& module, const std::vector< std::uintptr_t >& addresses );
+
+        std::unique_ptr< state_t > state;
+    };
+}  // namespace extlib
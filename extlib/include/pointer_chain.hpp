@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "remote.hpp"
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// A multi-level pointer: starting at `base`, every offset is added to the pointer read at the current address.
+    /// `base -> +0x10 -> +0x8` is `{ base, { 0x10, 0x8 } }` and resolves to `read( read( base ) + 0x10 ) + 0x8`.
+    /// </summary>
+    struct pointer_chain_t
+    {
+        std::uintptr_t base;
+        std::vector< std::ptrdiff_t > offsets;
+    };
+
+    /// <summary>
+    /// How a pointer chain set caches the pointers it reads.
+    /// </summary>
+    struct pointer_chain_options_t
+    {
+        /// <summary>
+        /// The number of levels, counted from the bases, whose pointers are taken to be stable (e.g. globals pointing at
+        /// long-lived managers) and are only read again every `revalidate_interval` resolves.
+        /// </summary>
+        std::size_t cached_levels = 0;
+
+        /// <summary>
+        /// How many resolves a cached pointer is used for before it is read again.
+        /// </summary>
+        std::size_t revalidate_interval = 64;
+    };
+
+    /// <summary>
+    /// A set of pointer chains compiled into a prefix trie, so chains sharing a base and leading offsets share the
+    /// reads for them.
+    /// <para>
+    /// Chains are resolved a level at a time: every pointer the trie needs at a level is read in one batch, with
+    /// pointers lying close together merged into one read. Resolving the whole set takes as many batches as the
+    /// longest chain has offsets, however many chains there are.
+    /// </para>
+    /// <para>
+    /// The set keeps the pointers it read for caching, so it must not be resolved from several threads at once.
+    /// </para>
+    /// </summary>
+    class pointer_chain_set final
+    {
+       public:
+        /// <summary>
+        /// Compiles a set of pointer chains.
+        /// </summary>
+        /// <param name="chains">The chains, which keep their order as their indices.</param>
+        /// <param name="options">How the pointers read are cached.</param>
+        explicit pointer_chain_set( const std::vector< pointer_chain_t >& chains, pointer_chain_options_t options = {} );
+
+        /// <summary>
+        /// Resolves every chain.
+        /// </summary>
+        /// <param name="module">The module to read through.</param>
+        /// <returns>The address every chain leads to in the same order, or nothing for a chain passing through a null
+        /// or unreadable pointer.</returns>
+        std::vector< std::optional< std::uintptr_t > > resolve( const win::module_t& module );
+
+        /// <summary>
+        /// Resolves every chain into a list the caller keeps. Once the first resolve has sized the set's working memory,
+        /// resolving every tick does not allocate.
+        /// </summary>
+        /// <param name="module">The module to read through.</param>
+        /// <param name="addresses">Receives the address every chain leads to, as `resolve` returns them.</param>
+        void resolve( const win::module_t& module, std::vector< std::optional< std::uintptr_t > >& addresses );
+
+        /// <summary>
+        /// Forgets every cached pointer, so the next resolve reads them all again.
+        /// </summary>
+        void invalidate();
+
+        /// <summary>
+        /// Gets the number of chains in the set.
+        /// </summary>
+        std::size_t size() const;
+
+        /// <summary>
+        /// Gets the number of distinct pointers the set reads, which is less than the chains' offsets combined when
+        /// they share prefixes.
+        /// </summary>
+        std::size_t get_pointer_count() const;
+
+        /// <summary>
+        /// Gets the number of pointers the last resolve read, leaving out those served from the cache.
+        /// </summary>
+        std::size_t get_last_read_count() const;
+
+       private:
+        /// <summary>
+        /// A node of the trie: a base, or an offset from the pointer read at its parent.
+        /// </summary>
+        struct node_t
+        {
+            /// <summary>
+            /// The index of the parent in the level above, unused for bases.
+            /// </summary>
+            std::uint32_t parent;
+
+            /// <summary>
+            /// Whether any node below reads the pointer at this one.
+            /// </summary>
+            bool has_children;
+
+            /// <summary>
+            /// The base, or the offset from the parent's pointer.
+            /// </summary>
+            std::uintptr_t value;
+
+            /// <summary>
+            /// The address the node resolved to in the current resolve, or 0 if it did not resolve.
+            /// </summary>
+            std::uintptr_t address;
+
+            /// <summary>
+            /// The pointer read at `read_address`, or 0 if it is unknown or could not be read.
+            /// </summary>
+            std::uint64_t pointer;
+
+            std::uintptr_t read_address;
+
+            /// <summary>
+            /// The resolve the pointer was read in.
+            /// </summary>
+            std::size_t read_generation;
+        };
+
+        pointer_chain_options_t options;
+
+        /// <summary>
+        /// The nodes of every level, starting with the bases.
+        /// </summary>
+        std::vector< std::vector< node_t > > levels;
+
+        /// <summary>
+        /// The level and index of the node every chain ends at.
+        /// </summary>
+        std::vector< std::pair< std::uint32_t, std::uint32_t > > leaves;
+
+        std::size_t generation = 0;
+        std::size_t last_read_count = 0;
+
+        /// <summary>
+        /// The reads of a level and the memory to perform them in, kept between resolves so they do not allocate.
+        /// </summary>
+        std::vector< detail::remote_read_t > reads;
+        std::vector< bool > failed;
+        detail::scattered_scratch_t scratch;
+    };
+}  // namespace extlib
@@ -1,8 +1,13 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
+#include "patch.hpp"
+#include "process_snapshot.hpp"
 #include "win/psapi.hpp"
 #include "win/ptapi.hpp"
 #include "win/win_exception.hpp"
@@ -19,8 +24,12 @@ namespace extlib
         /// Gets a list of all processes with the provided name.
         /// </summary>
         /// <param name="name">The name of the target process.</param>
+        /// <param name="desired_access">The access to open the processes with (add `PROCESS_VM_WRITE` and
+        /// `PROCESS_VM_OPERATION` to write to them).</param>
         /// <returns>A list of processes matching `name`.</returns>
-        static std::vector< std::unique_ptr< process > > get_all_by_name( const std::string_view name );
+        static std::vector< std::unique_ptr< process > > get_all_by_name(
+            const std::string_view name,
+            std::uint64_t desired_access = PROCESS_QUERY_INFORMATION | PROCESS_VM_READ );
 
         /// <summary>
         /// Gets a process identifier using a process's name.
@@ -36,21 +45,30 @@ namespace extlib
         bool is_64bit() const;
 
         /// <summary>
-        /// Gets a module from the current process.
+        /// Gets a module from the current process. Modules are looked up in a cache keyed by their lowercase base name,
+        /// which is only rebuilt when a name is missing from it.
         /// </summary>
         /// <param name="name">The name of the module to retrieve.</param>
         /// <returns>The module.</returns>
-        inline win::module_t operator[]( const std::string_view name ) const
-        {
-            return get_module_by_name( handle, name );
-        }
+        win::module_t operator[]( const std::string_view name ) const;
 
         /// <summary>
-        /// Gets all modules belonging to the current process.
+        /// Gets all modules belonging to the current process. The modules' headers are only read once they are used.
         /// </summary>
         /// <returns>A list of modules.</returns>
         std::vector< win::module_t > get_modules() const;
 
+        /// <summary>
+        /// Forgets the cached modules, so the next lookup sees modules loaded or unloaded since.
+        /// </summary>
+        void refresh_modules();
+
+        /// <summary>
+        /// Creates an empty patch set for writing to the current process.
+        /// </summary>
+        /// <returns>A new patch set.</returns>
+        patch_set create_patch_set() const;
+
         /// <summary>
         /// Closes the handle to the current process.
         /// </summary>
@@ -64,7 +82,7 @@ namespace extlib
         /// <summary>
         /// The name of the process (includes .exe).
         /// </summary>
-        std::string_view name;
+        std::string name;
 
         /// <summary>
         /// If this value is true, the process has already been closed (cannot interact).
@@ -74,7 +92,7 @@ namespace extlib
         /// <summary>
         /// The handle instance to the process.
         /// </summary>
-        std::unique_ptr< win::handle_t >& handle;
+        std::unique_ptr< win::handle_t > handle;
 
        private:
         /// <summary>
@@ -83,20 +101,27 @@ namespace extlib
         /// <param name="handle">The handle to the process.</param>
         /// <param name="main_module">The main module.</param>
         /// <param name="name">The name of the process.</param>
-        process( std::unique_ptr< win::handle_t > handle, win::module_t main_module, const char* const name )
+        process( std::unique_ptr< win::handle_t > handle, win::module_t main_module, std::string name )
             : handle( std::move( handle ) ),
-              main_module( main_module ),
-              name( name ),
+              main_module( std::move( main_module ) ),
+              name( std::move( name ) ),
               is_dead( false )
         {
         }
 
         /// <summary>
-        /// Gets a module by it's base name.
+        /// Lists the modules of a process together with their base names, in a single pass.
         /// </summary>
         /// <param name="handle">The handle to the target process.</param>
-        /// <param name="name">The base name of the module.</param>
-        /// <returns>The module.</returns>
-        static win::module_t get_module_by_name( std::unique_ptr< win::handle_t >& handle, const std::string_view name );
+        /// <returns>The base names and modules, starting with the executable.</returns>
+        static std::vector< std::pair< std::string, win::module_t > >
+        list_modules( const std::unique_ptr< win::handle_t >& handle );
+
+        mutable std::mutex module_mutex;
+
+        /// <summary>
+        /// Maps lowercase base names onto modules.
+        /// </summary>
+        mutable std::unordered_map< std::string, win::module_t > modules_by_name;
     };
 }  // namespace extlib
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace extlib
+{
+    /// <summary>
+    /// Describes a process at the time a snapshot was taken.
+    /// </summary>
+    struct process_entry_t
+    {
+        /// <summary>
+        /// The identifiers of the process and of the process that created it.
+        /// </summary>
+        std::uint64_t id, parent_id;
+
+        /// <summary>
+        /// The name of the process's executable (includes .exe).
+        /// </summary>
+        std::string name;
+    };
+
+    /// <summary>
+    /// A list of every process running on the system, captured in a single pass without opening any of them. Names are
+    /// indexed, so looking processes up by name is a hash lookup rather than a scan.
+    /// </summary>
+    class process_snapshot final
+    {
+       public:
+        /// <summary>
+        /// Captures the processes currently running.
+        /// </summary>
+        /// <returns>A new snapshot.</returns>
+        static process_snapshot capture();
+
+        process_snapshot( process_snapshot&& other ) noexcept;
+        process_snapshot& operator=( process_snapshot&& other ) noexcept;
+
+        /// <summary>
+        /// Gets every captured process.
+        /// </summary>
+        const std::vector< process_entry_t >& get_processes() const;
+
+        /// <summary>
+        /// Gets the identifiers of every process with the provided executable name (compared case-insensitively).
+        /// </summary>
+        /// <param name="name">The name of the process (includes .exe).</param>
+        /// <returns>A list of process identifiers.</returns>
+        std::vector< std::uint64_t > find( std::string_view name ) const;
+
+        /// <summary>
+        /// Gets a captured process by its identifier.
+        /// </summary>
+        /// <param name="id">The identifier of the process.</param>
+        /// <returns>The process, or nullptr if it was not running when the snapshot was taken.</returns>
+        const process_entry_t* get( std::uint64_t id ) const;
+
+        /// <summary>
+        /// Gets the full path of a process's executable. Querying a path means opening the process, so paths are only
+        /// looked up when asked for, and remembered afterwards.
+        /// </summary>
+        /// <param name="id">The identifier of the process.</param>
+        /// <returns>The path, or an empty path if the process could not be queried.</returns>
+        std::filesystem::path get_path( std::uint64_t id ) const;
+
+       private:
+        process_snapshot() = default;
+
+        std::vector< process_entry_t > processes;
+
+        /// <summary>
+        /// Maps lowercase names and identifiers onto indices into `processes`.
+        /// </summary>
+        std::unordered_map< std::string, std::vector< std::size_t > > by_name;
+        std::unordered_map< std::uint64_t, std::size_t > by_id;
+
+        mutable std::mutex path_mutex;
+        mutable std::unordered_map< std::uint64_t, std::filesystem::path > paths;
+    };
+}  // namespace extlib
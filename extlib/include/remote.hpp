@@ -0,0 +1,435 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// Declares a field of a remote struct, by the layout it belongs to, its offset and its type. Layouts are plain
+    /// structs naming their fields:
+    /// <code>
+    /// struct player_layout
+    /// {
+    ///     using health = extlib::field_t< player_layout, 0x100, float >;
+    ///     using target = extlib::pointer_field_t< player_layout, 0x140, entity_layout >;
+    /// };
+    /// </code>
+    /// </summary>
+    /// <typeparam name="layout_t">The layout the field belongs to.</typeparam>
+    /// <typeparam name="field_offset">The offset of the field from the start of the struct.</typeparam>
+    /// <typeparam name="T">The type of the field, which must be trivially copyable.</typeparam>
+    template< typename layout_t, std::size_t field_offset, typename T >
+    struct field_t
+    {
+        static_assert( std::is_trivially_copyable_v< T >, "remote fields are copied byte for byte" );
+
+        using layout = layout_t;
+        using type = T;
+
+        static constexpr std::size_t offset = field_offset;
+        static constexpr std::size_t size = sizeof( T );
+    };
+
+    /// <summary>
+    /// Declares a field holding a pointer to another remote struct, which can be followed once the field is read.
+    /// </summary>
+    /// <typeparam name="target_t">The layout of the struct pointed to.</typeparam>
+    template< typename layout_t, std::size_t field_offset, typename target_t >
+    struct pointer_field_t : field_t< layout_t, field_offset, std::uintptr_t >
+    {
+        using target = target_t;
+    };
+
+    template< typename layout_t >
+    class remote_ptr;
+
+    namespace detail
+    {
+        /// <summary>
+        /// The largest gap between two fields that are still read together. Reading a few unneeded bytes is cheaper
+        /// than another round trip into the process.
+        /// </summary>
+        constexpr std::size_t remote_merge_gap = 0x40;
+
+        /// <summary>
+        /// The largest read that reads of a batch are merged into, so one read does not serialize the whole batch.
+        /// </summary>
+        constexpr std::size_t remote_max_merged_read = 0x10000;
+
+        /// <summary>
+        /// A span of a struct that is read in one go, and where its bytes are kept in a view's buffer.
+        /// </summary>
+        struct remote_span_t
+        {
+            std::size_t offset, size, buffer_offset;
+        };
+
+        /// <summary>
+        /// The spans covering a set of fields, sorted by offset.
+        /// </summary>
+        template< std::size_t N >
+        struct remote_spans_t
+        {
+            std::array< remote_span_t, N > spans{};
+            std::size_t count = 0;
+            std::size_t buffer_size = 0;
+        };
+
+        /// <summary>
+        /// Computes the fewest spans covering a set of fields, merging fields that overlap or lie close together.
+        /// </summary>
+        template< typename... fields_t >
+        constexpr remote_spans_t< sizeof...( fields_t ) > covering_spans()
+        {
+            std::array< remote_span_t, sizeof...( fields_t ) > fields{
+                remote_span_t{ fields_t::offset, fields_t::size, 0 }... };
+
+            for ( std::size_t i = 1; i < fields.size(); ++i )
+            {
+                for ( auto j = i; j > 0 && fields[ j ].offset < fields[ j - 1 ].offset; --j )
+                {
+                    const auto field = fields[ j ];
+                    fields[ j ] = fields[ j - 1 ];
+                    fields[ j - 1 ] = field;
+                }
+            }
+
+            remote_spans_t< sizeof...( fields_t ) > result;
+
+            for ( const auto& field : fields )
+            {
+                if ( result.count )
+                {
+                    auto& last = result.spans[ result.count - 1 ];
+
+                    if ( field.offset <= last.offset + last.size + remote_merge_gap )
+                    {
+                        const auto end = field.offset + field.size;
+
+                        if ( end > last.offset + last.size )
+                            last.size = end - last.offset;
+
+                        continue;
+                    }
+                }
+
+                result.spans[ result.count++ ] = field;
+            }
+
+            for ( std::size_t i = 0; i < result.count; ++i )
+            {
+                result.spans[ i ].buffer_offset = result.buffer_size;
+                result.buffer_size += result.spans[ i ].size;
+            }
+
+            return result;
+        }
+
+        /// <summary>
+        /// Finds where a field's bytes are kept in a view's buffer.
+        /// </summary>
+        template< typename field_t, std::size_t N >
+        constexpr std::size_t buffer_offset( const remote_spans_t< N >& spans )
+        {
+            for ( std::size_t i = 0; i < spans.count; ++i )
+            {
+                const auto& span = spans.spans[ i ];
+
+                if ( field_t::offset >= span.offset && field_t::offset + field_t::size <= span.offset + span.size )
+                    return span.buffer_offset + field_t::offset - span.offset;
+            }
+
+            return spans.buffer_size;
+        }
+
+        template< typename field_t, typename... fields_t >
+        constexpr bool contains_field = ( std::is_same_v< field_t, fields_t > || ... );
+
+        /// <summary>
+        /// A read into caller provided memory, one of many gathered from several objects.
+        /// </summary>
+        struct remote_read_t
+        {
+            std::uintptr_t address;
+            std::size_t length;
+            std::uint8_t* destination;
+
+            /// <summary>
+            /// The object the read belongs to, which is only usable if all of its reads succeed.
+            /// </summary>
+            std::size_t object;
+        };
+
+        /// <summary>
+        /// Reads of a batch that are read together, as a range of the batch sorted by address.
+        /// </summary>
+        struct merged_read_t
+        {
+            std::uintptr_t start, end;
+            std::size_t first, last;
+        };
+
+        /// <summary>
+        /// Sorts a batch of reads by address and merges the reads lying close together (across objects too) into runs.
+        /// </summary>
+        /// <param name="reads">The reads, which are reordered.</param>
+        /// <returns>The runs, in order.</returns>
+        std::vector< merged_read_t > merge_reads( std::vector< remote_read_t >& reads );
+
+        /// <summary>
+        /// Merges a batch of reads as `merge_reads` does, into a list the caller keeps.
+        /// </summary>
+        /// <param name="reads">The reads, which are reordered.</param>
+        /// <param name="runs">Receives the runs, in order.</param>
+        void merge_reads( std::vector< remote_read_t >& reads, std::vector< merged_read_t >& runs );
+
+        /// <summary>
+        /// Performs the reads of one run. A run that cannot be read whole is retried read by read, so one unreadable
+        /// object does not fail its neighbours. Runs of the same batch can be read from several threads at once.
+        /// </summary>
+        /// <param name="module">The module to read through.</param>
+        /// <param name="reads">The reads, as sorted by `merge_reads`.</param>
+        /// <param name="merged">The run to read.</param>
+        /// <param name="buffer">Scratch space for the run, which is reused between calls.</param>
+        /// <param name="failed">Set to 1 for every object with a read that failed; must hold an entry per object.</param>
+        void read_merged(
+            const win::module_t& module,
+            const std::vector< remote_read_t >& reads,
+            const merged_read_t& merged,
+            std::vector< std::uint8_t >& buffer,
+            std::vector< std::uint8_t >& failed );
+
+        /// <summary>
+        /// The working memory of `read_scattered`, which callers reading every tick keep so their reads do not allocate.
+        /// </summary>
+        struct scattered_scratch_t
+        {
+            std::vector< merged_read_t > runs;
+            std::vector< std::uint8_t > buffer, failed;
+        };
+
+        /// <summary>
+        /// Performs many reads, merging those lying close together into one, as `merge_reads` and `read_merged` do.
+        /// </summary>
+        /// <param name="module">The module to read through.</param>
+        /// <param name="reads">The reads, which are reordered.</param>
+        /// <param name="failed">Set for every object with a read that failed; must hold an entry per object.</param>
+        void read_scattered( const win::module_t& module, std::vector< remote_read_t >& reads, std::vector< bool >& failed );
+
+        /// <summary>
+        /// Performs many reads as `read_scattered` does, in working memory the caller keeps.
+        /// </summary>
+        /// <param name="scratch">The working memory, which is reused between calls.</param>
+        void read_scattered(
+            const win::module_t& module,
+            std::vector< remote_read_t >& reads,
+            std::vector< bool >& failed,
+            scattered_scratch_t& scratch );
+    }  // namespace detail
+
+    /// <summary>
+    /// The fields of a remote struct, fetched together. The view holds a copy of the bytes covering the fields, so
+    /// reading a field from it costs nothing.
+    /// </summary>
+    template< typename layout_t, typename... fields_t >
+    class remote_view final
+    {
+        static_assert( sizeof...( fields_t ) > 0, "a view needs at least one field" );
+        static_assert(
+            ( std::is_same_v< typename fields_t::layout, layout_t > && ... ),
+            "every field must belong to the layout it is fetched from" );
+
+       public:
+        /// <summary>
+        /// The spans of the struct that are read, computed when the view's type is.
+        /// </summary>
+        static constexpr auto spans = detail::covering_spans< fields_t... >();
+
+        /// <summary>
+        /// Gets the address of the struct the fields were read from.
+        /// </summary>
+        std::uintptr_t get_address() const
+        {
+            return address;
+        }
+
+        /// <summary>
+        /// Gets the value of a fetched field.
+        /// </summary>
+        template< typename field_t >
+        typename field_t::type get() const
+        {
+            static_assert( detail::contains_field< field_t, fields_t... >, "the field was not fetched" );
+
+            typename field_t::type value;
+            std::memcpy( &value, buffer.data() + detail::buffer_offset< field_t >( spans ), sizeof( value ) );
+
+            return value;
+        }
+
+        /// <summary>
+        /// Gets the struct a fetched pointer field points to, which can then be fetched in turn.
+        /// </summary>
+        template< typename field_t >
+        remote_ptr< typename field_t::target > follow() const
+        {
+            return remote_ptr< typename field_t::target >( get< field_t >() );
+        }
+
+       private:
+        template< typename >
+        friend class remote_ptr;
+
+        explicit remote_view( std::uintptr_t address ) : address( address )
+        {
+        }
+
+        /// <summary>
+        /// Adds the reads filling the view to a batch.
+        /// </summary>
+        void gather( std::vector< detail::remote_read_t >& reads, std::size_t object )
+        {
+            for ( std::size_t i = 0; i < spans.count; ++i )
+            {
+                const auto& span = spans.spans[ i ];
+                reads.push_back( { address + span.offset, span.size, buffer.data() + span.buffer_offset, object } );
+            }
+        }
+
+        std::uintptr_t address;
+        std::array< std::uint8_t, spans.buffer_size > buffer{};
+    };
+
+    /// <summary>
+    /// The address of a struct in another process (or memory source), typed by its layout. Fetching a set of fields
+    /// reads only the spans covering them, which are worked out at compile time.
+    /// </summary>
+    template< typename layout_t >
+    class remote_ptr final
+    {
+       public:
+        using layout = layout_t;
+
+        remote_ptr() = default;
+
+        explicit remote_ptr( std::uintptr_t address ) : address( address )
+        {
+        }
+
+        std::uintptr_t get_address() const
+        {
+            return address;
+        }
+
+        explicit operator bool() const
+        {
+            return address != 0;
+        }
+
+        /// <summary>
+        /// Fetches fields of the struct.
+        /// </summary>
+        /// <param name="module">The module to read through.</param>
+        /// <returns>The fields.</returns>
+        template< typename... fields_t >
+        remote_view< layout_t, fields_t... > fetch( const win::module_t& module ) const
+        {
+            auto views = fetch_all< fields_t... >( module, { *this } );
+
+            if ( !views.front() )
+            {
+                std::stringstream msg;
+                msg << "Failed to read the fields of the object at 0x" << std::hex << address;
+
+                throw std::runtime_error( msg.str() );
+            }
+
+            return *views.front();
+        }
+
+        /// <summary>
+        /// Reads a single field of the struct.
+        /// </summary>
+        /// <param name="module">The module to read through.</param>
+        /// <returns>The value of the field.</returns>
+        template< typename field_t >
+        typename field_t::type read( const win::module_t& module ) const
+        {
+            static_assert( std::is_same_v< typename field_t::layout, layout_t >, "the field must belong to the layout" );
+
+            return module.read< typename field_t::type >( address + field_t::offset );
+        }
+
+        /// <summary>
+        /// Fetches the same fields of many structs of this layout in one batch. The spans of every struct are sorted
+        /// and merged with those of its neighbours, so structs lying close together (e.g. in an array or a pool) cost a
+        /// single read. Following the pointer fields of the results and fetching again walks a graph of objects
+        /// breadth first, one batch per level.
+        /// </summary>
+        /// <param name="module">The module to read through.</param>
+        /// <param name="pointers">The structs to fetch.</param>
+        /// <returns>The fields of every struct in the same order, or nothing for a null pointer or a struct that could not
+        /// be read.</returns>
+        template< typename... fields_t >
+        static std::vector< std::optional< remote_view< layout_t, fields_t... > > >
+        fetch_all( const win::module_t& module, const std::vector< remote_ptr >& pointers )
+        {
+            using view_t = remote_view< layout_t, fields_t... >;
+
+            std::vector< std::optional< view_t > > views( pointers.size() );
+            std::vector< detail::remote_read_t > reads;
+            std::vector< bool > failed( pointers.size() );
+
+            reads.reserve( pointers.size() * view_t::spans.count );
+
+            for ( std::size_t i = 0; i < pointers.size(); ++i )
+            {
+                if ( !pointers[ i ] )
+                    continue;
+
+                views[ i ].emplace( view_t( pointers[ i ].address ) );
+                views[ i ]->gather( reads, i );
+            }
+
+            detail::read_scattered( module, reads, failed );
+
+            for ( std::size_t i = 0; i < pointers.size(); ++i )
+            {
+                if ( failed[ i ] )
+                    views[ i ].reset();
+            }
+
+            return views;
+        }
+
+       private:
+        std::uintptr_t address = 0;
+    };
+
+    /// <summary>
+    /// Follows a pointer field of many fetched structs, for fetching the next level of a breadth-first walk.
+    /// </summary>
+    /// <param name="views">The fetched structs.</param>
+    /// <returns>The pointers in the same order, null where a struct is missing.</returns>
+    template< typename field_t, typename layout_t, typename... fields_t >
+    std::vector< remote_ptr< typename field_t::target > >
+    follow_all( const std::vector< std::optional< remote_view< layout_t, fields_t... > > >& views )
+    {
+        std::vector< remote_ptr< typename field_t::target > > pointers;
+        pointers.reserve( views.size() );
+
+        for ( const auto& view : views )
+            pointers.push_back( view ? view->template follow< field_t >() : remote_ptr< typename field_t::target >() );
+
+        return pointers;
+    }
+}  // namespace extlib
@@ -1,16 +1,24 @@
 #pragma once
 
 #include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "arena.hpp"
+#include "cancellation.hpp"
+#include "memory_source.hpp"
 #include "win/win.hpp"
 
 namespace extlib
 {
     struct pattern_t;
+    class scan_cache;
+    class scanner_pool;
 
     /// <summary>
     /// Options for the scanning engine.
@@ -37,6 +45,14 @@ namespace extlib
         /// <param name="current">The current module to scan.</param>
         scanner_options_t( const win::module_t& current );
 
+        /// <summary>
+        /// Creates new scanner options for a memory source other than a live process, such as a dump.
+        /// </summary>
+        /// <param name="source">The source to scan (must outlive the scanner).</param>
+        /// <param name="start">The start address for the region.</param>
+        /// <param name="end">The end address for the region.</param>
+        scanner_options_t( const memory_source& source, std::uintptr_t start, std::uintptr_t end );
+
         /// <summary>
         /// Creates new scanner options.
         /// </summary>
@@ -45,14 +61,86 @@ namespace extlib
         std::uintptr_t start, end;
         std::size_t size;
         win::handle_t handle;
+
+        /// <summary>
+        /// The number of bytes read from the process at a time. Regions larger than this are read in overlapping chunks.
+        /// </summary>
+        std::size_t read_size = 0x100000;
+
+        /// <summary>
+        /// If this value is true, the scanner's scratch memory is backed by large pages when the system allows it.
+        /// </summary>
+        bool large_pages = false;
+
+        /// <summary>
+        /// If set, memory is taken from this source instead of being read through `handle`. Memory the source can view
+        /// in place is scanned without being copied.
+        /// </summary>
+        const memory_source* source = nullptr;
+
+        /// <summary>
+        /// If not empty, only these [start, end) ranges are scanned instead of [start, end), and a match must lie
+        /// entirely within one of them. Used to scope scans to functions.
+        /// </summary>
+        std::vector< std::pair< std::uintptr_t, std::uintptr_t > > ranges;
+
+        /// <summary>
+        /// If this value is true, only matches starting on an instruction boundary are reported. Boundaries are found
+        /// by decoding every region (or range) linearly from its start, so this is meant for code, and works best with
+        /// ranges that start on instructions, such as functions. Scans through a `scan_cache` ignore it.
+        /// </summary>
+        bool instruction_aligned = false;
+
+        /// <summary>
+        /// Checked before every chunk is read. Once cancelled, the scan stops by throwing `operation_cancelled`.
+        /// </summary>
+        cancellation_token cancellation;
     };
 
-    /// Handles process scanning.
+    /// <summary>
+    /// Handles process scanning. A scanner owns the scratch memory its scans read into, so a single scanner must not be
+    /// used by several threads at once.
     /// </summary>
     class scanner final
     {
         scanner_options_t options;
 
+        /// <summary>
+        /// Scratch memory for read buffers and intermediate matches, rewound at the start of every scan.
+        /// </summary>
+        mutable arena scratch;
+
+        /// <summary>
+        /// Invokes `callback` with the start and end of every readable part of the options' range (or ranges).
+        /// </summary>
+        template< typename callback_t >
+        void for_each_region( callback_t&& callback ) const;
+
+        /// <summary>
+        /// Invokes `callback` with the start and end of every readable part of [start, end).
+        /// </summary>
+        template< typename callback_t >
+        void for_each_region( std::uintptr_t start, std::uintptr_t end, callback_t& callback ) const;
+
+        /// <summary>
+        /// Gets the bytes at `address`, either straight from the memory source or read into `buffer`. If fewer bytes
+        /// could be read, `length` is shrunk to match.
+        /// </summary>
+        const std::uint8_t* fetch( std::uintptr_t address, std::uint8_t* buffer, std::size_t& length ) const;
+
+        /// <summary>
+        /// Gets the length of the instruction at `data`, or 1 if it does not decode.
+        /// </summary>
+        static std::size_t instruction_length( const std::uint8_t* data, std::size_t size );
+
+        /// <summary>
+        /// Scans the region described by the options, appending every match to `addresses`.
+        /// </summary>
+        template< typename container_t >
+        void scan( const pattern_t& pattern, container_t& addresses ) const;
+
+        friend class scanner_pool;
+
        public:
         /// <summary>
         /// Creates a new scanner with the provided options.
@@ -71,6 +159,114 @@ namespace extlib
         /// <param name="pattern">The pattern to look for.</param>
         /// <returns>A list of locations within the process.</returns>
         std::vector< std::uintptr_t > find_all( const pattern_t& pattern ) const;
+
+        /// <summary>
+        /// Finds all instances of a given byte pattern.
+        /// </summary>
+        /// <param name="pattern">The pattern to look for.</param>
+        /// <param name="resource">The memory resource the returned list allocates from.</param>
+        /// <returns>A list of locations within the process.</returns>
+        std::pmr::vector< std::uintptr_t > find_all( const pattern_t& pattern, std::pmr::memory_resource* resource ) const;
+
+        /// <summary>
+        /// Finds all instances of a given byte pattern, only re-matching the pages that changed since the last scan
+        /// with the same cache. Matches on unchanged pages are taken from the cache.
+        /// </summary>
+        /// <param name="pattern">The pattern to look for.</param>
+        /// <param name="cache">The cache holding the state of previous scans (reset if the pattern changes).</param>
+        /// <returns>A list of locations within the process.</returns>
+        std::vector< std::uintptr_t > find_all( const pattern_t& pattern, scan_cache& cache ) const;
+    };
+
+    /// <summary>
+    /// Scanners kept between scans, so repeated scans reuse their scratch arenas instead of creating them anew. Every
+    /// scan takes a scanner of its own, so scans running on several threads at once are each given one.
+    /// </summary>
+    class scanner_pool final
+    {
+       public:
+        /// <summary>
+        /// Runs a scan with a kept scanner pointed at the provided options, creating one if every kept scanner is in
+        /// use.
+        /// </summary>
+        /// <param name="options">The options for the scan.</param>
+        /// <param name="body">Invoked with the scanner, and returns the result of the scan.</param>
+        /// <returns>What `body` returned.</returns>
+        template< typename body_t >
+        auto scan( const scanner_options_t& options, body_t&& body )
+        {
+            auto kept = take( options );
+            auto result = body( static_cast< const scanner& >( *kept ) );
+
+            // A scan that threw leaves its scanner to be destroyed rather than kept.
+            give_back( std::move( kept ) );
+
+            return result;
+        }
+
+       private:
+        std::unique_ptr< scanner > take( const scanner_options_t& options );
+        void give_back( std::unique_ptr< scanner > kept );
+
+        std::mutex mutex;
+        std::vector< std::unique_ptr< scanner > > idle;
+    };
+
+    /// <summary>
+    /// Remembers the page contents and matches of previous scans. Pages are fingerprinted with a fast hash of the bytes
+    /// their matches depend on, so a repeated scan only re-matches pages whose fingerprint changed.
+    /// </summary>
+    class scan_cache final
+    {
+       public:
+        /// <summary>
+        /// Forgets every cached page.
+        /// </summary>
+        void clear();
+
+        /// <summary>
+        /// Gets the number of pages whose matches were taken from the cache during the last scan.
+        /// </summary>
+        std::size_t pages_reused() const;
+
+        /// <summary>
+        /// Gets the number of pages that were matched again during the last scan.
+        /// </summary>
+        std::size_t pages_matched() const;
+
+       private:
+        friend class scanner;
+
+        /// <summary>
+        /// The cached state of a single page.
+        /// </summary>
+        struct page_t
+        {
+            /// <summary>
+            /// The hash of the page and the bytes past it a match starting in the page can reach.
+            /// </summary>
+            std::uint64_t hash;
+
+            /// <summary>
+            /// The scan that last saw this page.
+            /// </summary>
+            std::uint64_t generation;
+
+            /// <summary>
+            /// The offsets within the page where matches start.
+            /// </summary>
+            std::vector< std::uint16_t > hits;
+        };
+
+        std::unordered_map< std::uintptr_t, page_t > pages;
+
+        /// <summary>
+        /// The pattern the cached matches belong to.
+        /// </summary>
+        std::vector< std::pair< std::uint8_t, bool > > pattern;
+
+        std::uint64_t generation = 0;
+        std::size_t reused = 0, matched = 0;
     };
 
     /// <summary>
@@ -110,13 +306,142 @@ namespace extlib
         /// Finds all instances of the current pattern in the byte vector.
         /// </summary>
         /// <param name="bytes">The list of bytes to search.</param>
-        /// <returns>A list of locations.</returns>
-        std::vector< std::size_t > find_matches( std::vector< std::uint8_t > page ) const;
+        /// <returns>A list of offsets into `page` where the pattern starts.</returns>
+        std::vector< std::size_t > find_matches( const std::vector< std::uint8_t >& page ) const;
+
+        /// <summary>
+        /// Finds all instances of the current pattern in a buffer.
+        /// </summary>
+        /// <param name="data">The buffer to search.</param>
+        /// <param name="size">The size of the buffer.</param>
+        /// <param name="resource">The memory resource the returned list allocates from.</param>
+        /// <returns>A list of offsets into `data` where the pattern starts.</returns>
+        std::pmr::vector< std::size_t > find_matches(
+            const std::uint8_t* data,
+            std::size_t size,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource() ) const;
 
         /// <summary>
         /// Represents a list of bytes and mask flag. If the flag is true, the byte is a wildcard.
         /// </summary>
         std::vector< std::pair< std::uint8_t, bool > > bytes;
+
+       private:
+        /// <summary>
+        /// Creates an empty pattern.
+        /// </summary>
+        pattern_t() = default;
+
+        /// <summary>
+        /// Finds all instances of the current pattern in a buffer, appending their offsets to `match_locations`.
+        /// </summary>
+        template< typename container_t >
+        void match( const std::uint8_t* data, std::size_t size, container_t& match_locations ) const;
+    };
+
+    namespace detail
+    {
+        /// <summary>
+        /// A pattern anchored on one of its concrete bytes.
+        /// </summary>
+        struct pattern_anchor_t
+        {
+            std::uint32_t pattern, offset;
+        };
+
+        /// <summary>
+        /// The anchors of a set of patterns, grouped by their byte, which is how `pattern_set` (and the signature
+        /// database compiler, which stores the table in its blobs) finds the patterns to check at each byte of the input.
+        /// </summary>
+        struct anchor_table_t
+        {
+            /// <summary>
+            /// The anchors, with the anchors on byte `b` at `anchors[ first[ b ] ]` up to `anchors[ first[ b + 1 ] ]`.
+            /// </summary>
+            std::vector< pattern_anchor_t > anchors;
+            std::uint32_t first[ 257 ]{};
+
+            /// <summary>
+            /// The patterns made of wildcards only, which have no byte to be anchored on.
+            /// </summary>
+            std::vector< std::uint32_t > unanchored;
+        };
+
+        /// <summary>
+        /// Anchors every pattern on its first concrete byte that is not one of the bytes filling most code and data,
+        /// or its first concrete byte if it has no other, and groups the anchors by their byte.
+        /// </summary>
+        /// <param name="patterns">The patterns, whose positions in the list are the indices the anchors refer to.</param>
+        /// <returns>The anchor table.</returns>
+        anchor_table_t build_anchor_table( const std::vector< const pattern_t* >& patterns );
+    }  // namespace detail
+
+    /// <summary>
+    /// A set of patterns compiled for matching in a single pass. Every pattern is anchored on one of its concrete bytes,
+    /// and the patterns are grouped by their anchor byte, so each byte of the input only has to be checked against the
+    /// patterns anchored on it. A set is immutable once built, so it can be shared between threads and scans.
+    /// </summary>
+    class pattern_set final
+    {
+       public:
+        /// <summary>
+        /// A match of one of the set's patterns.
+        /// </summary>
+        struct match_t
+        {
+            /// <summary>
+            /// The index of the pattern in the set.
+            /// </summary>
+            std::size_t pattern;
+
+            /// <summary>
+            /// The offset into the searched buffer where the match starts.
+            /// </summary>
+            std::size_t offset;
+        };
+
+        /// <summary>
+        /// Compiles a set of patterns.
+        /// </summary>
+        /// <param name="patterns">The patterns, which keep their order as their indices.</param>
+        explicit pattern_set( std::vector< pattern_t > patterns );
+
+        /// <summary>
+        /// Gets the patterns in the set.
+        /// </summary>
+        const std::vector< pattern_t >& get_patterns() const;
+
+        /// <summary>
+        /// Gets the length of the longest pattern in the set.
+        /// </summary>
+        std::size_t max_length() const;
+
+        /// <summary>
+        /// Finds every match of every pattern in a buffer, appending them to `matches` ordered by offset.
+        /// </summary>
+        /// <param name="data">The buffer to search.</param>
+        /// <param name="size">The size of the buffer.</param>
+        /// <param name="matches">The list the matches are appended to.</param>
+        void find_matches( const std::uint8_t* data, std::size_t size, std::vector< match_t >& matches ) const;
+
+       private:
+        using anchor_t = detail::pattern_anchor_t;
+
+        std::vector< pattern_t > patterns;
+
+        /// <summary>
+        /// The anchors grouped by their byte, with the anchors on byte `b` at `anchors[ first[ b ] ]` up to
+        /// `anchors[ first[ b + 1 ] ]`.
+        /// </summary>
+        std::vector< anchor_t > anchors;
+        std::uint32_t first[ 257 ]{};
+
+        /// <summary>
+        /// The patterns made of wildcards only, which match everywhere they fit.
+        /// </summary>
+        std::vector< std::uint32_t > unanchored;
+
+        std::size_t longest = 0;
     };
 
 }  // namespace extlib
\ No newline at end of file
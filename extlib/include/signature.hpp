@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "scan.hpp"
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// Options for generating signatures.
+    /// </summary>
+    struct signature_options_t
+    {
+        /// <summary>
+        /// The longest signature to try before giving up on an address.
+        /// </summary>
+        std::size_t max_length = 64;
+
+        /// <summary>
+        /// Whether to wildcard the bytes the loader relocates and the displacements of rel32 branches and RIP-relative
+        /// operands, which change whenever the surrounding code or data moves. Displacements are found by decoding
+        /// the instructions from the address on, so the address should be the start of an instruction.
+        /// </summary>
+        bool wildcard_volatile = true;
+    };
+
+    /// <summary>
+    /// Generates the shortest byte patterns that uniquely identify addresses in a module.
+    /// <para>
+    /// The module's image is copied once and indexed by its 3-byte grams, so counting the matches of a candidate
+    /// pattern only has to look at the positions sharing one of its grams rather than scanning the whole module.
+    /// Growing a signature then only narrows down the matches of the previous, shorter candidate.
+    /// </para>
+    /// </summary>
+    class signature_generator final
+    {
+       public:
+        /// <summary>
+        /// Copies and indexes a module's image.
+        /// </summary>
+        /// <param name="module">The module to generate signatures in.</param>
+        explicit signature_generator( const win::module_t& module );
+
+        /// <summary>
+        /// Generates the shortest signature starting at an address that matches nowhere else in the module.
+        /// </summary>
+        /// <param name="address">The address to generate a signature for.</param>
+        /// <param name="options">The options for the signature.</param>
+        /// <returns>The signature in `pattern_t::from_byte_pattern` syntax, or nothing if no signature up to the
+        /// maximum length is unique.</returns>
+        std::optional< std::string > generate( std::uintptr_t address, const signature_options_t& options = {} ) const;
+
+        /// <summary>
+        /// Generates signatures for many addresses, in parallel.
+        /// </summary>
+        /// <param name="addresses">The addresses to generate signatures for.</param>
+        /// <param name="options">The options for the signatures.</param>
+        /// <returns>A signature (or nothing) for every address, in the same order.</returns>
+        std::vector< std::optional< std::string > > generate(
+            const std::vector< std::uintptr_t >& addresses,
+            const signature_options_t& options = {} ) const;
+
+        /// <summary>
+        /// Counts the matches of a pattern in the module's image, using the index where the pattern allows.
+        /// </summary>
+        /// <param name="pattern">The pattern to count.</param>
+        /// <param name="limit">The count to stop at, for callers that only need to know whether a pattern is unique.</param>
+        /// <returns>The number of matches, up to `limit`.</returns>
+        std::size_t count( const pattern_t& pattern, std::size_t limit = SIZE_MAX ) const;
+
+       private:
+        /// <summary>
+        /// Marks the bytes of a window whose values change between builds or loads.
+        /// </summary>
+        std::vector< bool > find_volatile( std::size_t offset, std::size_t length ) const;
+
+        /// <summary>
+        /// Gets the positions in the image where the 3-byte gram at `data` may start.
+        /// </summary>
+        std::pair< const std::uint32_t*, const std::uint32_t* > candidates( const std::uint8_t* data ) const;
+
+        /// <summary>
+        /// Gets the bucket of a 3-byte gram.
+        /// </summary>
+        std::size_t bucket( const std::uint8_t* data ) const;
+
+        std::uintptr_t base;
+
+        std::vector< std::uint8_t > image;
+
+        /// <summary>
+        /// The bytes the loader rewrites when the module is not loaded at its preferred base.
+        /// </summary>
+        std::vector< bool > relocated;
+
+        /// <summary>
+        /// The gram index, with the positions of bucket `i` at `positions[ offsets[ i ] ]` up to
+        /// `positions[ offsets[ i + 1 ] ]`.
+        /// </summary>
+        std::vector< std::uint32_t > offsets, positions;
+
+        std::size_t bucket_bits;
+    };
+}  // namespace extlib
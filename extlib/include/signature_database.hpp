@@ -0,0 +1,353 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "win/mapped_file.hpp"
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// The on-disk layout of a compiled signature database: a header, then the signature, group, anchor and operation
+    /// tables, the pattern values and masks, and the strings, each starting on an 8 byte boundary. All fields are
+    /// little-endian.
+    /// <para>
+    /// Signatures are grouped by the module and section they are searched in, and every group carries the anchor
+    /// table `pattern_set` would build for its patterns, so a loaded database matches without compiling anything.
+    /// </para>
+    /// </summary>
+    namespace signature_database_format
+    {
+        /// <summary>
+        /// "EXTLSGDB" in little-endian.
+        /// </summary>
+        constexpr std::uint64_t magic = 0x424447534C545845;
+
+        constexpr std::uint32_t version = 1;
+
+        struct header_t
+        {
+            std::uint64_t magic;
+            std::uint32_t version, reserved;
+
+            std::uint64_t signature_count, group_count, anchor_count, operation_count, pattern_size, string_size;
+            std::uint64_t signature_offset, group_offset, anchor_offset, operation_offset, value_offset, mask_offset,
+                string_offset;
+        };
+
+        static_assert( sizeof( header_t ) == 120 );
+
+        struct signature_t
+        {
+            /// <summary>
+            /// The name, as a range of the string table.
+            /// </summary>
+            std::uint64_t name_offset, name_size;
+
+            /// <summary>
+            /// The pattern, as a range of the value and mask tables.
+            /// </summary>
+            std::uint64_t pattern_offset, pattern_size;
+
+            /// <summary>
+            /// The post-processing, as a range of the operation table.
+            /// </summary>
+            std::uint32_t first_operation, operation_count;
+
+            /// <summary>
+            /// The group the signature is searched in.
+            /// </summary>
+            std::uint32_t group, reserved;
+        };
+
+        static_assert( sizeof( signature_t ) == 48 );
+
+        struct group_t
+        {
+            /// <summary>
+            /// The module and section, as ranges of the string table. A module of `*` is the first module resolved
+            /// against, and a section of `*` is the whole image.
+            /// </summary>
+            std::uint64_t module_offset, module_size, section_offset, section_size;
+
+            /// <summary>
+            /// The group's anchors, as a range of the anchor table.
+            /// </summary>
+            std::uint32_t first_anchor, anchor_count;
+
+            /// <summary>
+            /// The length of the group's longest pattern.
+            /// </summary>
+            std::uint32_t longest, reserved;
+
+            /// <summary>
+            /// The anchors grouped by their byte, with the anchors on byte `b` at `first_anchor + buckets[ b ]` up to
+            /// `first_anchor + buckets[ b + 1 ]`. The last entry only pads the group to 8 bytes.
+            /// </summary>
+            std::uint32_t buckets[ 258 ];
+        };
+
+        static_assert( sizeof( group_t ) == 1080 );
+
+        /// <summary>
+        /// A signature anchored on one of its concrete bytes.
+        /// </summary>
+        struct anchor_t
+        {
+            std::uint32_t signature, offset;
+        };
+
+        enum class operation_kind_t : std::uint32_t
+        {
+            /// <summary>
+            /// Adds `operand` to the address.
+            /// </summary>
+            add,
+
+            /// <summary>
+            /// Follows a 32-bit displacement at `operand` bytes into an instruction that is `length` bytes long, as for
+            /// `call rel32` or `mov rax, [rip + disp32]`.
+            /// </summary>
+            rel32,
+
+            /// <summary>
+            /// Reads the pointer at the address.
+            /// </summary>
+            deref,
+        };
+
+        struct operation_t
+        {
+            operation_kind_t kind;
+            std::uint32_t reserved;
+
+            std::int64_t operand, length;
+        };
+
+        static_assert( sizeof( operation_t ) == 24 );
+    }  // namespace signature_database_format
+
+    /// <summary>
+    /// The outcome of resolving a signature.
+    /// </summary>
+    enum class signature_status_t : std::uint8_t
+    {
+        resolved,
+
+        /// <summary>
+        /// The pattern matched nowhere.
+        /// </summary>
+        not_found,
+
+        /// <summary>
+        /// The pattern matched more than once.
+        /// </summary>
+        ambiguous,
+
+        /// <summary>
+        /// None of the modules resolved against is the signature's module.
+        /// </summary>
+        missing_module,
+
+        /// <summary>
+        /// The signature's module has no such section.
+        /// </summary>
+        missing_section,
+
+        /// <summary>
+        /// The section could not be read, or post-processing read memory that could not be.
+        /// </summary>
+        unreadable,
+    };
+
+    /// <summary>
+    /// A resolved signature.
+    /// </summary>
+    struct signature_result_t
+    {
+        std::string name;
+        signature_status_t status;
+
+        /// <summary>
+        /// The address after post-processing, or 0 if the signature did not resolve.
+        /// </summary>
+        std::uintptr_t address;
+
+        /// <summary>
+        /// The number of matches of the pattern, and the first of them.
+        /// </summary>
+        std::size_t match_count;
+        std::uintptr_t match;
+
+        /// <summary>
+        /// The time taken to read and search the signature's section, which it shares with every signature in it.
+        /// </summary>
+        std::chrono::nanoseconds scan_time;
+
+        /// <summary>
+        /// The time taken by the signature's own post-processing.
+        /// </summary>
+        std::chrono::nanoseconds resolve_time;
+    };
+
+    /// <summary>
+    /// A section searched while resolving a database.
+    /// </summary>
+    struct signature_scan_t
+    {
+        std::string module, section;
+
+        std::size_t size, signature_count;
+        std::chrono::nanoseconds time;
+    };
+
+    /// <summary>
+    /// Everything resolving a database did.
+    /// </summary>
+    struct signature_report_t
+    {
+        /// <summary>
+        /// The result of every signature, in the order of the database.
+        /// </summary>
+        std::vector< signature_result_t > results;
+
+        /// <summary>
+        /// The sections searched, one scan each.
+        /// </summary>
+        std::vector< signature_scan_t > scans;
+
+        std::chrono::nanoseconds time;
+
+        /// <summary>
+        /// Gets the result of a signature by name.
+        /// </summary>
+        /// <returns>The result, or nullptr if the database has no such signature.</returns>
+        const signature_result_t* find( std::string_view name ) const;
+
+        /// <summary>
+        /// Gets the number of signatures that resolved.
+        /// </summary>
+        std::size_t resolved_count() const;
+    };
+
+    /// <summary>
+    /// A set of named signatures compiled ahead of time, which resolves every signature with one scan per section.
+    /// <para>
+    /// Databases are written as text, one signature per line: a name, the module and section to search, the pattern in
+    /// `pattern_t::from_byte_pattern` syntax and any post-processing, each operation after a `|`:
+    /// </para>
+    /// <code>
+    /// # name        module    section  pattern                              post-processing
+    /// local_player  game.exe  .text    48 8B 05 ?? ?? ?? ?? 48 85 C0 74 ??  | rel32 3 7 | deref
+    /// update        *         .text    40 53 48 83 EC 20 8B D9 E8           | add -0x10
+    /// </code>
+    /// <para>
+    /// The operations are `add &lt;offset&gt;`, `rel32 &lt;displacement offset&gt; [&lt;instruction length&gt;]`
+    /// (which defaults to the displacement offset plus 4) and `deref`. `extlib_sigc` compiles the text into a blob,
+    /// which `load` maps and uses in place.
+    /// </para>
+    /// </summary>
+    class signature_database final
+    {
+       public:
+        /// <summary>
+        /// Compiles the text of a database.
+        /// </summary>
+        /// <param name="source">The text.</param>
+        /// <returns>The compiled blob, as `load` reads it.</returns>
+        static std::vector< std::uint8_t > compile( std::string_view source );
+
+        /// <summary>
+        /// Compiles the text of a database into a database held in memory, for callers without a compiled blob.
+        /// </summary>
+        /// <param name="source">The text.</param>
+        /// <returns>The database.</returns>
+        static signature_database parse( std::string_view source );
+
+        /// <summary>
+        /// Maps a compiled database into memory.
+        /// </summary>
+        /// <param name="path">The path of the compiled blob.</param>
+        /// <returns>The database, which keeps the file mapped for as long as it lives.</returns>
+        static signature_database load( const std::filesystem::path& path );
+
+        signature_database( signature_database&& ) = default;
+        signature_database& operator=( signature_database&& ) = default;
+
+        signature_database( const signature_database& ) = delete;
+        signature_database& operator=( const signature_database& ) = delete;
+
+        /// <summary>
+        /// Resolves every signature against a set of modules. Every module and section the database names is read and
+        /// searched once, for all of its signatures together.
+        /// </summary>
+        /// <param name="modules">The modules, matched to signatures by name regardless of case. Signatures whose module
+        /// is `*` are resolved against the first.</param>
+        /// <returns>The status, address and timing of every signature.</returns>
+        signature_report_t resolve( const std::vector< win::module_t >& modules ) const;
+
+        /// <summary>
+        /// Gets the number of signatures in the database.
+        /// </summary>
+        std::size_t size() const;
+
+        /// <summary>
+        /// Gets the name of a signature.
+        /// </summary>
+        std::string_view get_name( std::size_t signature ) const;
+
+        /// <summary>
+        /// Gets the index of a signature by name.
+        /// </summary>
+        /// <returns>The index, or nothing if the database has no such signature.</returns>
+        std::optional< std::size_t > find( std::string_view name ) const;
+
+       private:
+        signature_database() = default;
+
+        /// <summary>
+        /// Checks a blob and points the database at its tables.
+        /// </summary>
+        /// <param name="origin">What the blob is, for error messages.</param>
+        void attach( const std::uint8_t* data, std::size_t size, const std::string& origin );
+
+        /// <summary>
+        /// Finds every match of a group's signatures in a buffer, counting them and keeping the first of each.
+        /// </summary>
+        void match(
+            const signature_database_format::group_t& group,
+            const std::uint8_t* data,
+            std::size_t size,
+            std::vector< std::size_t >& counts,
+            std::vector< std::size_t >& firsts ) const;
+
+        std::string_view get_string( std::uint64_t offset, std::uint64_t size ) const;
+
+        const signature_database_format::signature_t* signatures = nullptr;
+        const signature_database_format::group_t* groups = nullptr;
+        const signature_database_format::anchor_t* anchors = nullptr;
+        const signature_database_format::operation_t* operations = nullptr;
+        const std::uint8_t* values = nullptr;
+        const std::uint8_t* masks = nullptr;
+        const char* strings = nullptr;
+
+        std::size_t signature_count = 0, group_count = 0;
+
+        /// <summary>
+        /// The blob of a database that was parsed rather than loaded.
+        /// </summary>
+        std::vector< std::uint64_t > owned;
+
+        /// <summary>
+        /// The file a loaded database points into.
+        /// </summary>
+        std::unique_ptr< win::mapped_file > file;
+    };
+}  // namespace extlib
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <emmintrin.h>
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+namespace extlib::simd
+{
+    /// <summary>
+    /// Gets the index of the lowest set bit in a non-zero mask.
+    /// </summary>
+    /// <param name="mask">The mask (must not be zero).</param>
+    /// <returns>The index of the lowest set bit.</returns>
+    inline std::uint32_t lowest_bit( std::uint32_t mask )
+    {
+#if defined( _MSC_VER )
+        unsigned long index;
+        _BitScanForward( &index, mask );
+
+        return index;
+#else
+        return static_cast< std::uint32_t >( __builtin_ctz( mask ) );
+#endif
+    }
+
+    /// <summary>
+    /// Finds the first byte at which two buffers differ, comparing 16 bytes at a time.
+    /// </summary>
+    /// <param name="lhs">The first buffer.</param>
+    /// <param name="rhs">The second buffer.</param>
+    /// <param name="size">The number of bytes to compare.</param>
+    /// <returns>The offset of the first differing byte, or `size` if the buffers are equal.</returns>
+    inline std::size_t mismatch( const std::uint8_t* lhs, const std::uint8_t* rhs, std::size_t size )
+    {
+        std::size_t i = 0;
+
+        for ( ; i + 16 <= size; i += 16 )
+        {
+            const auto a = _mm_loadu_si128( reinterpret_cast< const __m128i* >( lhs + i ) );
+            const auto b = _mm_loadu_si128( reinterpret_cast< const __m128i* >( rhs + i ) );
+
+            const auto equal = static_cast< std::uint32_t >( _mm_movemask_epi8( _mm_cmpeq_epi8( a, b ) ) );
+
+            if ( equal != 0xFFFF )
+                return i + lowest_bit( ~equal & 0xFFFF );
+        }
+
+        for ( ; i < size; ++i )
+        {
+            if ( lhs[ i ] != rhs[ i ] )
+                return i;
+        }
+
+        return size;
+    }
+
+    /// <summary>
+    /// Finds the first byte at which two buffers are equal, comparing 16 bytes at a time.
+    /// </summary>
+    /// <param name="lhs">The first buffer.</param>
+    /// <param name="rhs">The second buffer.</param>
+    /// <param name="size">The number of bytes to compare.</param>
+    /// <returns>The offset of the first equal byte, or `size` if every byte differs.</returns>
+    inline std::size_t match( const std::uint8_t* lhs, const std::uint8_t* rhs, std::size_t size )
+    {
+        std::size_t i = 0;
+
+        for ( ; i + 16 <= size; i += 16 )
+        {
+            const auto a = _mm_loadu_si128( reinterpret_cast< const __m128i* >( lhs + i ) );
+            const auto b = _mm_loadu_si128( reinterpret_cast< const __m128i* >( rhs + i ) );
+
+            const auto equal = static_cast< std::uint32_t >( _mm_movemask_epi8( _mm_cmpeq_epi8( a, b ) ) );
+
+            if ( equal )
+                return i + lowest_bit( equal );
+        }
+
+        for ( ; i < size; ++i )
+        {
+            if ( lhs[ i ] == rhs[ i ] )
+                return i;
+        }
+
+        return size;
+    }
+}  // namespace extlib::simd
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// A contiguous block of memory captured from a process.
+    /// </summary>
+    struct snapshot_block_t
+    {
+        /// <summary>
+        /// The address the block was captured from.
+        /// </summary>
+        std::uintptr_t address;
+
+        /// <summary>
+        /// The captured bytes.
+        /// </summary>
+        std::vector< std::uint8_t > bytes;
+    };
+
+    /// <summary>
+    /// Options that narrow down which changes a diff reports.
+    /// </summary>
+    struct diff_options_t
+    {
+        /// <summary>
+        /// If non-zero, changes are reported as whole fields of this size (1, 2, 4 or 8) aligned to their size, and
+        /// changed bytes outside a complete field are ignored.
+        /// </summary>
+        std::size_t field_size = 0;
+
+        /// <summary>
+        /// If set, only fields whose signed value changed by exactly this amount (new - old) are reported. Without a
+        /// field size, single bytes are compared.
+        /// </summary>
+        std::optional< std::int64_t > changed_by;
+    };
+
+    /// <summary>
+    /// The changes between two snapshots, as a sorted list of runs. The old and new bytes of every run are stored back
+    /// to back in two shared buffers, so the list stays compact.
+    /// </summary>
+    struct snapshot_diff_t
+    {
+        /// <summary>
+        /// A contiguous range of changed bytes.
+        /// </summary>
+        struct run_t
+        {
+            /// <summary>
+            /// The address of the first changed byte.
+            /// </summary>
+            std::uintptr_t address;
+
+            /// <summary>
+            /// The number of changed bytes, and where they start in `old_bytes` and `new_bytes`.
+            /// </summary>
+            std::size_t size, offset;
+        };
+
+        /// <summary>
+        /// Gets the total number of changed bytes.
+        /// </summary>
+        std::size_t changed_bytes() const;
+
+        std::vector< run_t > runs;
+        std::vector< std::uint8_t > old_bytes, new_bytes;
+    };
+
+    /// <summary>
+    /// A copy of selected regions of a process at a point in time.
+    /// </summary>
+    class snapshot final
+    {
+       public:
+        /// <summary>
+        /// Captures the readable, committed parts of the provided regions. Regions are read in parallel.
+        /// </summary>
+        /// <param name="handle">The handle to the target process.</param>
+        /// <param name="regions">The regions to capture.</param>
+        /// <returns>A new snapshot.</returns>
+        static snapshot capture( win::handle_t handle, const std::vector< win::region_t >& regions );
+
+        /// <summary>
+        /// Captures the readable, committed parts of a module.
+        /// </summary>
+        /// <param name="module">The module to capture.</param>
+        /// <returns>A new snapshot.</returns>
+        static snapshot capture( const win::module_t& module );
+
+        /// <summary>
+        /// Computes the changes between two snapshots. Only memory present in both is compared, and the overlapping
+        /// blocks are compared in parallel.
+        /// </summary>
+        /// <param name="before">The earlier snapshot.</param>
+        /// <param name="after">The later snapshot.</param>
+        /// <param name="options">The filters to apply.</param>
+        /// <returns>The changes.</returns>
+        static snapshot_diff_t diff( const snapshot& before, const snapshot& after, const diff_options_t& options = {} );
+
+        /// <summary>
+        /// Gets the captured blocks, sorted by address.
+        /// </summary>
+        const std::vector< snapshot_block_t >& get_blocks() const;
+
+        /// <summary>
+        /// Gets the total number of bytes captured.
+        /// </summary>
+        std::size_t size() const;
+
+       private:
+        std::vector< snapshot_block_t > blocks;
+    };
+}  // namespace extlib
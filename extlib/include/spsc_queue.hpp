@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace extlib
+{
+    /// <summary>
+    /// A bounded, lock-free queue for exactly one producer thread and one consumer thread.
+    /// </summary>
+    /// <typeparam name="T">The type of the elements.</typeparam>
+    /// <typeparam name="capacity">The number of slots (a power of two).</typeparam>
+    template< typename T, std::size_t capacity >
+    class spsc_queue final
+    {
+        static_assert( capacity && !( capacity & ( capacity - 1 ) ), "capacity must be a power of two" );
+
+       public:
+        /// <summary>
+        /// Pushes an element onto the queue. Must only be called by the producer.
+        /// </summary>
+        /// <param name="value">The element to push.</param>
+        /// <returns>True, if there was room for the element.</returns>
+        bool try_push( const T& value )
+        {
+            const auto tail = write_index.load( std::memory_order_relaxed );
+
+            if ( tail - read_index.load( std::memory_order_acquire ) == capacity )
+                return false;
+
+            slots[ tail & ( capacity - 1 ) ] = value;
+            write_index.store( tail + 1, std::memory_order_release );
+
+            return true;
+        }
+
+        /// <summary>
+        /// Pops an element off the queue. Must only be called by the consumer.
+        /// </summary>
+        /// <param name="value">Receives the element.</param>
+        /// <returns>True, if an element was available.</returns>
+        bool try_pop( T& value )
+        {
+            const auto head = read_index.load( std::memory_order_relaxed );
+
+            if ( head == write_index.load( std::memory_order_acquire ) )
+                return false;
+
+            value = slots[ head & ( capacity - 1 ) ];
+            read_index.store( head + 1, std::memory_order_release );
+
+            return true;
+        }
+
+        /// <summary>
+        /// Gets the number of elements currently queued (approximate while both threads are active).
+        /// </summary>
+        std::size_t size() const
+        {
+            return write_index.load( std::memory_order_acquire ) - read_index.load( std::memory_order_acquire );
+        }
+
+       private:
+        // Keep the two indices on separate cache lines so the threads don't fight over them.
+        alignas( 64 ) std::atomic< std::size_t > write_index{ 0 };
+        alignas( 64 ) std::atomic< std::size_t > read_index{ 0 };
+
+        std::array< T, capacity > slots{};
+    };
+}  // namespace extlib
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "memory_source.hpp"
+
+namespace extlib::synth
+{
+    /// <summary>
+    /// Options for generating a synthetic image. The same options always generate the same image.
+    /// </summary>
+    struct image_options_t
+    {
+        std::uint64_t seed = 1;
+
+        /// <summary>
+        /// The address the image is built to be loaded at.
+        /// </summary>
+        std::uintptr_t base = 0x140000000;
+
+        /// <summary>
+        /// The size of `.text` to fill with generated functions, which is what mostly decides the size of the image.
+        /// </summary>
+        std::size_t code_size = 0x100000;
+
+        /// <summary>
+        /// The number of classes with MSVC RTTI and vtables.
+        /// </summary>
+        std::size_t classes = 1000;
+
+        /// <summary>
+        /// The most direct bases a class can have. Classes with more than one use multiple inheritance, and get a
+        /// vtable (and complete object locator) for every base subobject.
+        /// </summary>
+        std::size_t max_bases = 3;
+
+        /// <summary>
+        /// The most functions in a vtable.
+        /// </summary>
+        std::size_t max_virtual_functions = 16;
+
+        /// <summary>
+        /// The number of string literals in `.rdata`.
+        /// </summary>
+        std::size_t strings = 1000;
+
+        /// <summary>
+        /// The size of the global variables in `.data`, on top of the type descriptors.
+        /// </summary>
+        std::size_t data_size = 0x10000;
+
+        /// <summary>
+        /// The number of standard containers in `.data`, laid out as MSVC's x64 standard library lays them out and split
+        /// evenly between `std::vector< std::uint32_t >`, `std::string` and
+        /// `std::unordered_map< std::uint32_t, std::uint32_t >`.
+        /// </summary>
+        std::size_t containers = 300;
+
+        /// <summary>
+        /// Byte patterns (in `pattern_t::from_byte_pattern` syntax) planted once each at the start of a function.
+        /// Wildcards are filled with random bytes. Short patterns may also occur elsewhere by chance.
+        /// </summary>
+        std::vector< std::string > signatures;
+
+        /// <summary>
+        /// The namespace every class is declared in.
+        /// </summary>
+        std::string namespace_name = "synth";
+    };
+
+    /// <summary>
+    /// A vtable of a synthetic class. A class has one for every base subobject with a vfptr of its own.
+    /// </summary>
+    struct vtable_t
+    {
+        std::uint32_t rva;
+
+        /// <summary>
+        /// The RVA of the complete object locator in the slot before the vtable.
+        /// </summary>
+        std::uint32_t locator_rva;
+
+        /// <summary>
+        /// The offset of the vtable's vfptr within the complete object.
+        /// </summary>
+        std::uint32_t offset;
+
+        /// <summary>
+        /// The RVAs of the functions in the vtable.
+        /// </summary>
+        std::vector< std::uint32_t > functions;
+    };
+
+    /// <summary>
+    /// A class of a synthetic image, and where its RTTI was placed.
+    /// </summary>
+    struct class_t
+    {
+        /// <summary>
+        /// The qualified name of the class (e.g. `synth::class_12`), as taken by `object_pattern_t::from_class_name`.
+        /// </summary>
+        std::string name;
+
+        /// <summary>
+        /// The direct bases of the class, as indices into the image's classes.
+        /// </summary>
+        std::vector< std::size_t > bases;
+
+        std::uint32_t type_descriptor_rva;
+        std::uint32_t hierarchy_rva;
+
+        /// <summary>
+        /// The vtables of the class, the primary one first.
+        /// </summary>
+        std::vector< vtable_t > vtables;
+    };
+
+    /// <summary>
+    /// Where one of the requested signatures was planted.
+    /// </summary>
+    struct planted_signature_t
+    {
+        /// <summary>
+        /// The index of the signature in `image_options_t::signatures`.
+        /// </summary>
+        std::size_t signature;
+
+        std::uint32_t rva;
+    };
+
+    /// <summary>
+    /// A string literal of a synthetic image.
+    /// </summary>
+    struct planted_string_t
+    {
+        std::string value;
+        std::uint32_t rva;
+    };
+
+    /// <summary>
+    /// The kinds of standard container in a synthetic image.
+    /// </summary>
+    enum class container_kind_t : std::uint8_t
+    {
+        /// <summary>
+        /// `std::vector< std::uint32_t >`.
+        /// </summary>
+        vector,
+
+        /// <summary>
+        /// `std::string`, held inline or on the heap depending on its length.
+        /// </summary>
+        string,
+
+        /// <summary>
+        /// `std::unordered_map< std::uint32_t, std::uint32_t >`.
+        /// </summary>
+        unordered_map,
+    };
+
+    /// <summary>
+    /// A standard container of a synthetic image, and what it holds.
+    /// </summary>
+    struct planted_container_t
+    {
+        container_kind_t kind;
+
+        /// <summary>
+        /// The RVA of the container object. Its storage is elsewhere in `.data`.
+        /// </summary>
+        std::uint32_t rva;
+
+        /// <summary>
+        /// The elements of a vector, or the key and value of every entry of a map one after another, in iteration order.
+        /// </summary>
+        std::vector< std::uint32_t > values;
+
+        /// <summary>
+        /// The characters of a string.
+        /// </summary>
+        std::string string;
+    };
+
+    /// <summary>
+    /// A PE64 image generated from scratch, with `.text`, `.rdata` and `.data` sections laid out like an MSVC build:
+    /// functions with ordinary prologues and epilogues, RTTI and vtables for a class hierarchy, string literals,
+    /// standard containers and globals. Everything placed in it is recorded, so tests and benchmarks know what the
+    /// library should find.
+    /// <para>
+    /// The file alignment matches the section alignment, so the image is laid out identically in memory and on disk.
+    /// </para>
+    /// <para>
+    /// The generator needs no live process, but it is not portable: it takes the PE structures it writes from
+    /// `Windows.h`, and builds on `memory_source`, `pattern_t` and `object_pattern_t`, which need it too. It builds
+    /// wherever the rest of the library does, which is Windows only.
+    /// </para>
+    /// </summary>
+    class image final
+    {
+       public:
+        /// <summary>
+        /// Generates an image.
+        /// </summary>
+        /// <param name="options">What to put in the image.</param>
+        /// <returns>The image.</returns>
+        static image generate( const image_options_t& options = {} );
+
+        /// <summary>
+        /// Gets the bytes of the image, as loaded.
+        /// </summary>
+        const std::vector< std::uint8_t >& get_bytes() const;
+
+        /// <summary>
+        /// Gets the address the image was built to be loaded at.
+        /// </summary>
+        std::uintptr_t get_base() const;
+
+        /// <summary>
+        /// Gets the classes of the image. A class's bases always come before it.
+        /// </summary>
+        const std::vector< class_t >& get_classes() const;
+
+        /// <summary>
+        /// Gets the RVAs of every function in `.text`, in order.
+        /// </summary>
+        const std::vector< std::uint32_t >& get_functions() const;
+
+        /// <summary>
+        /// Gets where every requested signature was planted.
+        /// </summary>
+        const std::vector< planted_signature_t >& get_signatures() const;
+
+        /// <summary>
+        /// Gets the string literals of the image.
+        /// </summary>
+        const std::vector< planted_string_t >& get_strings() const;
+
+        /// <summary>
+        /// Gets the standard containers of the image.
+        /// </summary>
+        const std::vector< planted_container_t >& get_containers() const;
+
+        /// <summary>
+        /// Creates a memory source presenting a copy of the image at its base, as if it had been loaded.
+        /// </summary>
+        /// <param name="name">The name of the module.</param>
+        std::shared_ptr< buffer_source > create_source( std::string name = "synth.exe" ) const;
+
+        /// <summary>
+        /// Writes the image to a file, which `pe_file_source` (or any PE parser) can open.
+        /// </summary>
+        /// <param name="path">The path of the file.</param>
+        void save( const std::filesystem::path& path ) const;
+
+       private:
+        image() = default;
+
+        std::vector< std::uint8_t > bytes;
+        std::uintptr_t base = 0;
+
+        std::vector< class_t > classes;
+        std::vector< std::uint32_t > functions;
+        std::vector< planted_signature_t > signatures;
+        std::vector< planted_string_t > strings;
+        std::vector< planted_container_t > containers;
+    };
+}  // namespace extlib::synth
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace extlib
+{
+    /// <summary>
+    /// A fixed set of worker threads that run queued tasks.
+    /// </summary>
+    class thread_pool final
+    {
+       public:
+        /// <summary>
+        /// Creates a new thread pool.
+        /// </summary>
+        /// <param name="threads">The number of worker threads (at least one).</param>
+        explicit thread_pool( std::size_t threads = std::thread::hardware_concurrency() );
+
+        thread_pool( const thread_pool& ) = delete;
+        thread_pool& operator=( const thread_pool& ) = delete;
+
+        /// <summary>
+        /// Finishes the queued tasks and joins every worker.
+        /// </summary>
+        ~thread_pool();
+
+        /// <summary>
+        /// Gets the pool shared by the library's parallel algorithms.
+        /// </summary>
+        static thread_pool& shared();
+
+        /// <summary>
+        /// Gets the number of worker threads.
+        /// </summary>
+        std::size_t size() const;
+
+        /// <summary>
+        /// Queues a task.
+        /// </summary>
+        /// <param name="task">The task to run.</param>
+        /// <returns>A future for the task's result.</returns>
+        template< typename function_t >
+        auto submit( function_t&& task ) -> std::future< std::invoke_result_t< std::decay_t< function_t > > >
+        {
+            using result_t = std::invoke_result_t< std::decay_t< function_t > >;
+
+            // std::function needs a copyable target, so the packaged task is shared.
+            auto packaged = std::make_shared< std::packaged_task< result_t() > >( std::forward< function_t >( task ) );
+            auto future = packaged->get_future();
+
+            enqueue( [ packaged ]() { ( *packaged )(); } );
+
+            return future;
+        }
+
+        /// <summary>
+        /// Queues a task whose result nobody waits for. The task must not throw.
+        /// </summary>
+        /// <param name="task">The task to run.</param>
+        void post( std::function< void() > task );
+
+        /// <summary>
+        /// Runs `body` for every index in [0, count) across the pool and waits for all of them. The calling thread
+        /// takes part, so this is safe to call from inside a task. The first exception thrown is rethrown.
+        /// </summary>
+        /// <param name="count">The number of indices.</param>
+        /// <param name="body">The function invoked with every index.</param>
+        template< typename function_t >
+        void parallel_for( std::size_t count, function_t&& body );
+
+       private:
+        /// <summary>
+        /// Pushes a task onto the queue and wakes a worker.
+        /// </summary>
+        void enqueue( std::function< void() > task );
+
+        /// <summary>
+        /// The body of every worker thread.
+        /// </summary>
+        void run();
+
+        std::vector< std::thread > workers;
+        std::deque< std::function< void() > > tasks;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+
+        bool stopping;
+    };
+
+    template< typename function_t >
+    inline void thread_pool::parallel_for( std::size_t count, function_t&& body )
+    {
+        if ( !count )
+            return;
+
+        // Tasks that start after every index has been claimed must still find this alive, so it is shared.
+        struct state_t
+        {
+            std::atomic< std::size_t > next{ 0 }, done{ 0 };
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::exception_ptr error;
+        };
+
+        const auto state = std::make_shared< state_t >();
+
+        const auto work = [ state, count, &body ]() {
+            for ( auto index = state->next++; index < count; index = state->next++ )
+            {
+                try
+                {
+                    body( index );
+                }
+                catch ( ... )
+                {
+                    std::lock_guard< std::mutex > lock( state->mutex );
+
+                    if ( !state->error )
+                        state->error = std::current_exception();
+                }
+
+                if ( ++state->done == count )
+                {
+                    std::lock_guard< std::mutex > lock( state->mutex );
+                    state->condition.notify_all();
+                }
+            }
+        };
+
+        const auto helpers = std::min( count, workers.size() ) - 1;
+
+        for ( std::size_t i = 0; i < helpers; ++i )
+            enqueue( work );
+
+        work();
+
+        std::unique_lock< std::mutex > lock( state->mutex );
+        state->condition.wait( lock, [ &state, count ]() { return state->done == count; } );
+
+        if ( state->error )
+            std::rethrow_exception( state->error );
+    }
+}  // namespace extlib
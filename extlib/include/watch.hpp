@@ -0,0 +1,348 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "spsc_queue.hpp"
+#include "win/win.hpp"
+
+namespace extlib
+{
+    /// <summary>
+    /// The largest value a single watch entry can cover, in bytes.
+    /// </summary>
+    constexpr std::size_t max_watch_size = 32;
+
+    /// <summary>
+    /// The type of value a watch entry holds.
+    /// </summary>
+    enum class watch_type_t : std::uint8_t
+    {
+        u8,
+        i8,
+        u16,
+        i16,
+        u32,
+        i32,
+        u64,
+        i64,
+        f32,
+        f64,
+        pointer,
+        bytes
+    };
+
+    /// <summary>
+    /// Gets the watch type that corresponds to T.
+    /// </summary>
+    /// <typeparam name="T">The type of the value.</typeparam>
+    template< typename T >
+    constexpr watch_type_t watch_type_of()
+    {
+        if constexpr ( std::is_pointer_v< T > )
+            return watch_type_t::pointer;
+        else if constexpr ( std::is_same_v< T, float > )
+            return watch_type_t::f32;
+        else if constexpr ( std::is_same_v< T, double > )
+            return watch_type_t::f64;
+        else if constexpr ( std::is_integral_v< T > && sizeof( T ) == 1 )
+            return std::is_signed_v< T > ? watch_type_t::i8 : watch_type_t::u8;
+        else if constexpr ( std::is_integral_v< T > && sizeof( T ) == 2 )
+            return std::is_signed_v< T > ? watch_type_t::i16 : watch_type_t::u16;
+        else if constexpr ( std::is_integral_v< T > && sizeof( T ) == 4 )
+            return std::is_signed_v< T > ? watch_type_t::i32 : watch_type_t::u32;
+        else if constexpr ( std::is_integral_v< T > && sizeof( T ) == 8 )
+            return std::is_signed_v< T > ? watch_type_t::i64 : watch_type_t::u64;
+        else
+            return watch_type_t::bytes;
+    }
+
+    /// <summary>
+    /// A change in a watched value.
+    /// </summary>
+    struct watch_change_t
+    {
+        /// <summary>
+        /// Reinterprets the previous value as T.
+        /// </summary>
+        template< typename T >
+        T old_value() const
+        {
+            static_assert( sizeof( T ) <= max_watch_size && std::is_trivially_copyable_v< T > );
+
+            T value;
+            std::memcpy( &value, previous.data(), sizeof( T ) );
+
+            return value;
+        }
+
+        /// <summary>
+        /// Reinterprets the new value as T.
+        /// </summary>
+        template< typename T >
+        T new_value() const
+        {
+            static_assert( sizeof( T ) <= max_watch_size && std::is_trivially_copyable_v< T > );
+
+            T value;
+            std::memcpy( &value, current.data(), sizeof( T ) );
+
+            return value;
+        }
+
+        /// <summary>
+        /// The identifier returned when the entry was added.
+        /// </summary>
+        std::size_t id;
+
+        /// <summary>
+        /// The location and size of the watched value.
+        /// </summary>
+        std::uintptr_t address;
+        std::size_t size;
+
+        /// <summary>
+        /// The type of the watched value.
+        /// </summary>
+        watch_type_t type;
+
+        /// <summary>
+        /// The tick the change was observed on.
+        /// </summary>
+        std::uint64_t tick;
+
+        /// <summary>
+        /// The value before and after the change (only the first `size` bytes are meaningful).
+        /// </summary>
+        std::array< std::uint8_t, max_watch_size > previous, current;
+    };
+
+    /// <summary>
+    /// Timing and throughput figures for a watch list.
+    /// </summary>
+    struct watch_stats_t
+    {
+        /// <summary>
+        /// The number of ticks polled, and the number that ran past their deadline.
+        /// </summary>
+        std::uint64_t ticks, overruns;
+
+        /// <summary>
+        /// The number of span reads that failed, and the number of changes dropped because the queue was full.
+        /// </summary>
+        std::uint64_t read_failures, dropped;
+
+        /// <summary>
+        /// The number of reads issued per tick.
+        /// </summary>
+        std::size_t spans;
+
+        /// <summary>
+        /// How long a tick takes, from the first read to the last notification.
+        /// </summary>
+        std::chrono::nanoseconds mean_latency, p99_latency, max_latency;
+
+        /// <summary>
+        /// How far ticks start from their scheduled time.
+        /// </summary>
+        std::chrono::nanoseconds mean_jitter, max_jitter;
+    };
+
+    /// <summary>
+    /// Options for a watch list.
+    /// </summary>
+    struct watch_options_t
+    {
+        /// <summary>
+        /// The number of ticks per second the polling thread aims for.
+        /// </summary>
+        double rate = 100.0;
+
+        /// <summary>
+        /// Entries closer than this many bytes are read together in a single span.
+        /// </summary>
+        std::size_t max_gap = 64;
+
+        /// <summary>
+        /// The largest span read in a single call.
+        /// </summary>
+        std::size_t max_span = 0x10000;
+    };
+
+    /// <summary>
+    /// Polls a set of addresses at a fixed rate and reports the ones that change. Entries are compiled into as few
+    /// coalesced reads as possible, and every tick is compared against the previous one with SIMD, so only changed
+    /// entries reach the callback (or, without a callback, the queue).
+    /// </summary>
+    class watch_list final
+    {
+       public:
+        /// <summary>
+        /// The callback invoked, on the polling thread, for every change.
+        /// </summary>
+        using callback_t = std::function< void( const watch_change_t& ) >;
+
+        /// <summary>
+        /// The number of changes the queue holds before it starts dropping them.
+        /// </summary>
+        static constexpr std::size_t queue_capacity = 4096;
+
+        /// <summary>
+        /// Creates a new, empty watch list.
+        /// </summary>
+        /// <param name="handle">The handle to the target process.</param>
+        /// <param name="options">The options for the watch list.</param>
+        explicit watch_list( win::handle_t handle, const watch_options_t& options = {} );
+
+        watch_list( const watch_list& ) = delete;
+        watch_list& operator=( const watch_list& ) = delete;
+
+        /// <summary>
+        /// Stops the polling thread.
+        /// </summary>
+        ~watch_list();
+
+        /// <summary>
+        /// Registers a value to watch. Entries can only be added while the list is stopped.
+        /// </summary>
+        /// <param name="address">The location of the value.</param>
+        /// <param name="size">The size of the value (at most `max_watch_size`).</param>
+        /// <param name="type">The type of the value.</param>
+        /// <returns>The identifier reported with changes to this entry.</returns>
+        std::size_t add( std::uintptr_t address, std::size_t size, watch_type_t type = watch_type_t::bytes );
+
+        /// <summary>
+        /// Registers a value of type T to watch.
+        /// </summary>
+        /// <typeparam name="T">The type of the value.</typeparam>
+        /// <param name="address">The location of the value.</param>
+        /// <returns>The identifier reported with changes to this entry.</returns>
+        template< typename T >
+        std::size_t add( std::uintptr_t address )
+        {
+            return add( address, sizeof( T ), watch_type_of< T >() );
+        }
+
+        /// <summary>
+        /// Sets the callback invoked for every change. Without a callback, changes are delivered through `poll`.
+        /// </summary>
+        /// <param name="callback">The callback.</param>
+        void on_change( callback_t callback );
+
+        /// <summary>
+        /// Pops a change off the queue. Safe to call from one consumer thread while the list is running.
+        /// </summary>
+        /// <param name="change">Receives the change.</param>
+        /// <returns>True, if a change was available.</returns>
+        bool poll( watch_change_t& change );
+
+        /// <summary>
+        /// Starts the polling thread.
+        /// </summary>
+        void start();
+
+        /// <summary>
+        /// Stops the polling thread and waits for it to exit.
+        /// </summary>
+        void stop();
+
+        /// <summary>
+        /// Specifies whether or not the polling thread is running.
+        /// </summary>
+        bool is_running() const;
+
+        /// <summary>
+        /// Polls every entry once on the calling thread. Must not be called while the list is running.
+        /// </summary>
+        void tick();
+
+        /// <summary>
+        /// Gets the timing and throughput figures gathered so far.
+        /// </summary>
+        watch_stats_t stats() const;
+
+       private:
+        /// <summary>
+        /// A registered entry.
+        /// </summary>
+        struct entry_t
+        {
+            std::uintptr_t address;
+            std::size_t size;
+            watch_type_t type;
+        };
+
+        /// <summary>
+        /// A single coalesced read, covering the sorted entries [first, last).
+        /// </summary>
+        struct span_t
+        {
+            std::uintptr_t address;
+            std::size_t size, offset;
+            std::size_t first, last;
+            bool valid;
+        };
+
+        /// <summary>
+        /// Compiles the registered entries into spans.
+        /// </summary>
+        void compile();
+
+        /// <summary>
+        /// Reads every span and reports the entries that changed since the previous tick.
+        /// </summary>
+        void poll_once();
+
+        /// <summary>
+        /// Delivers a single change.
+        /// </summary>
+        void deliver( std::size_t index, const span_t& span );
+
+        /// <summary>
+        /// Adds a finished tick to the statistics.
+        /// </summary>
+        void record( std::chrono::nanoseconds latency, std::chrono::nanoseconds jitter, bool overrun );
+
+        /// <summary>
+        /// The body of the polling thread.
+        /// </summary>
+        void run();
+
+        win::handle_t handle;
+        watch_options_t options;
+
+        std::vector< entry_t > entries;
+
+        // Entries sorted by address, as indices into `entries`.
+        std::vector< std::size_t > order;
+        std::vector< span_t > spans;
+
+        // The buffers the spans are read into; swapped every tick.
+        std::vector< std::uint8_t > previous, current;
+
+        // The tick each sorted entry was last reported on, so overlapping entries are reported once.
+        std::vector< std::uint64_t > reported;
+
+        std::uint64_t tick_count;
+        bool compiled;
+
+        callback_t callback;
+        std::unique_ptr< spsc_queue< watch_change_t, queue_capacity > > queue;
+
+        std::thread worker;
+        std::atomic< bool > running;
+
+        mutable std::mutex stats_mutex;
+        watch_stats_t totals;
+        std::vector< std::chrono::nanoseconds > latencies;
+        std::chrono::nanoseconds total_latency, total_jitter;
+    };
+}  // namespace extlib
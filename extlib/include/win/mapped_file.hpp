@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "win.hpp"
+
+namespace extlib::win
+{
+    /// <summary>
+    /// A read-only view of an entire file mapped into the current process. Pages are only loaded when touched.
+    /// </summary>
+    class mapped_file final
+    {
+       public:
+        /// <summary>
+        /// Maps a file into memory.
+        /// </summary>
+        /// <param name="path">The path to the file.</param>
+        explicit mapped_file( const std::filesystem::path& path );
+
+        mapped_file( const mapped_file& ) = delete;
+        mapped_file& operator=( const mapped_file& ) = delete;
+
+        /// <summary>
+        /// Unmaps the file.
+        /// </summary>
+        ~mapped_file();
+
+        /// <summary>
+        /// Gets the first byte of the file.
+        /// </summary>
+        const std::uint8_t* data() const;
+
+        /// <summary>
+        /// Gets the size of the file.
+        /// </summary>
+        std::size_t size() const;
+
+       private:
+        HANDLE file, mapping;
+
+        const std::uint8_t* view;
+        std::size_t length;
+    };
+}  // namespace extlib::win
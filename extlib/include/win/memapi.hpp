@@ -34,6 +34,47 @@ namespace extlib::win
         static std::vector< std::uint8_t >
         read_process_memory( const handle_t& handle, std::uintptr_t address, std::size_t length );
 
+        /// <summary>
+        /// Reads process memory at a location into a caller provided buffer.
+        /// </summary>
+        /// <param name="handle">The handle to the process to read from.</param>
+        /// <param name="address">The location to read from.</param>
+        /// <param name="buffer">The buffer that receives the bytes (at least `length` bytes long).</param>
+        /// <param name="length">The number of bytes to read.</param>
+        /// <returns>The number of bytes read.</returns>
+        static std::size_t
+        read_process_memory( const handle_t& handle, std::uintptr_t address, void* buffer, std::size_t length );
+
+        /// <summary>
+        /// Writes process memory at a location.
+        /// </summary>
+        /// <param name="handle">The handle to the process to write to.</param>
+        /// <param name="address">The location to write to.</param>
+        /// <param name="buffer">The bytes to write.</param>
+        /// <param name="length">The number of bytes to write.</param>
+        /// <returns>The number of bytes written.</returns>
+        static std::size_t
+        write_process_memory( const handle_t& handle, std::uintptr_t address, const void* buffer, std::size_t length );
+
+        /// <summary>
+        /// Changes the protection on a region of committed pages in the virtual address space of a specified process.
+        /// </summary>
+        /// <param name="handle">A handle to the process whose memory protection is to be changed.</param>
+        /// <param name="address">The base address of the region of pages.</param>
+        /// <param name="size">The size of the region whose protection is changed, in bytes.</param>
+        /// <param name="protect">The new memory protection option.</param>
+        /// <returns>The previous protection of the first page in the region.</returns>
+        static std::uint64_t
+        virtual_protect_ex( const handle_t& handle, std::uintptr_t address, std::size_t size, std::uint64_t protect );
+
+        /// <summary>
+        /// Flushes the instruction cache for the specified process.
+        /// </summary>
+        /// <param name="handle">A handle to the process whose instruction cache is to be flushed.</param>
+        /// <param name="address">The base address of the region to be flushed.</param>
+        /// <param name="size">The size of the region to be flushed, in bytes.</param>
+        static void flush_instruction_cache( const handle_t& handle, std::uintptr_t address, std::size_t size );
+
         /// <summary>
         /// Retrieves information about a range of pages within the virtual address space of a specified process.
         /// </summary>
@@ -33,7 +33,7 @@ namespace extlib::win
         /// <param name="filter">The filter criteria.</param>
         /// <returns>An array that receives the list of modules.</returns>
         static std::vector< module_t > enum_process_modules(
-            std::unique_ptr< handle_t >& handle,
+            const std::unique_ptr< handle_t >& handle,
             module_filter_flag filter );
 
         /// <summary>
@@ -43,7 +43,7 @@ namespace extlib::win
         /// <param name="filter">The filter criteria.</param>
         /// <returns>An array that receives the list of modules.</returns>
         static std::vector< module_t > try_enum_process_modules(
-            std::unique_ptr< handle_t >& handle,
+            const std::unique_ptr< handle_t >& handle,
             module_filter_flag filter );
 
         /// <summary>
@@ -52,7 +52,7 @@ namespace extlib::win
         /// <param name="handle">A handle to the process that contains the module.</param>
         /// <param name="module">A handle to the module.</param>
         /// <returns>The base name of the module.</returns>
-        static std::string get_module_base_name( std::unique_ptr< handle_t >& handle, const module_t& module );
+        static std::string get_module_base_name( const std::unique_ptr< handle_t >& handle, const module_t& module );
 
         /// <summary>
         /// Retrieves the fully qualified path for the file containing the specified module.
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <filesystem>
 #include <vector>
 
 #include "win.hpp"
@@ -37,6 +38,29 @@ namespace extlib::win
             bool inherit,
             std::uint64_t id );
 
+        /// <summary>
+        /// Retrieves the full name of the executable image for the specified process.
+        /// </summary>
+        /// <param name="handle">A handle to the process (needs `PROCESS_QUERY_LIMITED_INFORMATION`).</param>
+        /// <returns>The path of the executable, or an empty path if it could not be queried.</returns>
+        static std::filesystem::path query_full_process_image_name( const handle_t& handle );
+
+        /// <summary>
+        /// Gets the time a process was created, which tells it apart from any later process reusing its id.
+        /// </summary>
+        /// <param name="handle">A handle to the process (needs `PROCESS_QUERY_LIMITED_INFORMATION`).</param>
+        /// <returns>The creation time in 100 nanosecond intervals since 1601, or 0 if it could not be queried.</returns>
+        static std::uint64_t get_process_creation_time( HANDLE handle );
+
+        /// <summary>
+        /// Checks whether a process is still running.
+        /// </summary>
+        /// <param name="id">The identifier of the process.</param>
+        /// <param name="creation_time">When the process was created (see `get_process_creation_time`), so that a later
+        /// process reusing the id is not mistaken for it.</param>
+        /// <returns>True if the process is running, false if it has exited or cannot be opened.</returns>
+        static bool is_process_running( std::uint64_t id, std::uint64_t creation_time );
+
         /// <summary>
         /// Closes an open object handle.
         /// </summary>
@@ -3,9 +3,14 @@
 #include <Windows.h>
 
 #include <filesystem>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "memory_source.hpp"
 #include "win/memapi.hpp"
 #include "win/region.hpp"
 
@@ -13,14 +18,12 @@
 namespace extlib
 {
     struct pattern_t;
+    class patch_set;
+    class scanner_pool;
 }
 
 namespace extlib::win
 {
-    // System default values.
-    constexpr auto MAX_MODULE_COUNT = 512;
-    constexpr auto MAX_PROCESSES_COUNT = 1024;
-
     /// <summary>
     /// Describes the kind of portable executable we have at hand.
     /// </summary>
@@ -77,16 +80,125 @@ namespace extlib::win
         std::uintptr_t address;
     };
 
+    /// <summary>
+    /// A function or variable exported by a module.
+    /// </summary>
+    struct export_t
+    {
+        /// <summary>
+        /// The exported name, or empty for exports only reachable by ordinal.
+        /// </summary>
+        std::string name;
+
+        std::uint16_t ordinal;
+
+        /// <summary>
+        /// The address of the export, or 0 if it is forwarded.
+        /// </summary>
+        std::uintptr_t address;
+
+        /// <summary>
+        /// The export this one forwards to (e.g. `NTDLL.RtlAllocateHeap`), or empty.
+        /// </summary>
+        std::string forwarder;
+    };
+
+    /// <summary>
+    /// A function or variable a module imports from another one.
+    /// </summary>
+    struct import_t
+    {
+        /// <summary>
+        /// The name of the module the import comes from (e.g. `KERNEL32.dll`).
+        /// </summary>
+        std::string module;
+
+        /// <summary>
+        /// The imported name, or empty if the import is by ordinal.
+        /// </summary>
+        std::string name;
+
+        /// <summary>
+        /// The imported ordinal, or for imports by name, the hint the linker recorded for where the name probably is in
+        /// the exporting module's name table.
+        /// </summary>
+        std::uint16_t ordinal;
+
+        /// <summary>
+        /// The address of the import's slot in the import address table, which holds the resolved address once the
+        /// module is loaded.
+        /// </summary>
+        std::uintptr_t slot;
+    };
+
+    /// <summary>
+    /// A function described by the exception directory of a 64-bit module.
+    /// </summary>
+    struct function_t
+    {
+        /// <summary>
+        /// The address of the function's first byte.
+        /// </summary>
+        std::uintptr_t start;
+
+        /// <summary>
+        /// The address just past the function's last byte.
+        /// </summary>
+        std::uintptr_t end;
+
+        /// <summary>
+        /// The address of the function's unwind info.
+        /// </summary>
+        std::uintptr_t unwind_info;
+
+        /// <summary>
+        /// Checks to see if this function contains the provided address.
+        /// </summary>
+        constexpr bool contains( std::uintptr_t address ) const
+        {
+            return address >= start && address < end;
+        }
+    };
+
+    /// <summary>
+    /// A location the loader rewrites when a module is not loaded at its preferred base.
+    /// </summary>
+    struct relocation_t
+    {
+        std::uint32_t rva;
+
+        /// <summary>
+        /// The size of the rewritten value (4 or 8).
+        /// </summary>
+        std::uint32_t size;
+    };
+
     /// <summary>
     /// Module wrapper structure.
     /// </summary>
     struct module_t
     {
         /// <summary>
-        /// Creates a new module.
+        /// Creates a new module. Only the module's bounds are queried; its headers are read on first use.
         /// </summary>
         module_t( HANDLE hHandle, HMODULE hModule );
 
+        /// <summary>
+        /// Creates a new module from bounds that are already known, without touching the process.
+        /// </summary>
+        /// <param name="handle">The handle to the parent process.</param>
+        /// <param name="base">The base address of the module's image.</param>
+        /// <param name="size">The size of the module's image.</param>
+        module_t( HANDLE handle, std::uintptr_t base, std::size_t size );
+
+        /// <summary>
+        /// Creates a new module whose memory is read from a memory source instead of a live process.
+        /// </summary>
+        /// <param name="source">The source holding the module.</param>
+        /// <param name="base">The base address of the module's image.</param>
+        /// <param name="size">The size of the module's image.</param>
+        module_t( std::shared_ptr< const memory_source > source, std::uintptr_t base, std::size_t size );
+
         /// <summary>
         /// Creates a new module.
         /// </summary>
@@ -114,6 +226,13 @@ namespace extlib::win
         /// <returns>An array of bytes.</returns>
         std::vector< std::uint8_t > read( std::uintptr_t address, std::size_t length ) const;
 
+        /// <summary>
+        /// Copies the module's whole image. The headers and every section are read separately, so a part that cannot
+        /// be read (e.g. a section that is only partly committed) is left as zeros rather than failing the copy.
+        /// </summary>
+        /// <returns>The image, indexed by RVA.</returns>
+        std::vector< std::uint8_t > read_image() const;
+
         /// <summary>
         /// Gets a section in the module by name.
         /// </summary>
@@ -125,7 +244,80 @@ namespace extlib::win
         /// Gets all of the sections in the module.
         /// </summary>
         /// <returns>List of sections.</returns>
-        std::vector< section_t > get_sections();
+        std::vector< section_t > get_sections() const;
+
+        /// <summary>
+        /// Gets the kind of portable executable the module is.
+        /// </summary>
+        pe_kind_t get_kind() const;
+
+        /// <summary>
+        /// Gets the module's DOS header.
+        /// </summary>
+        const IMAGE_DOS_HEADER& get_dos_header() const;
+
+        /// <summary>
+        /// Gets the module's NT headers. For 32-bit modules, only the fields shared with 64-bit headers are meaningful.
+        /// </summary>
+        const IMAGE_NT_HEADERS& get_nt_headers() const;
+
+        /// <summary>
+        /// Gets one of the module's data directories, for 32 and 64-bit modules alike.
+        /// </summary>
+        /// <param name="index">The index of the directory (e.g. `IMAGE_DIRECTORY_ENTRY_EXPORT`).</param>
+        /// <returns>The directory, which is all zeros if the module does not have it.</returns>
+        IMAGE_DATA_DIRECTORY get_data_directory( std::size_t index ) const;
+
+        /// <summary>
+        /// Gets every export of the module. The export directory is read in one go and parsed on first use.
+        /// </summary>
+        const std::vector< export_t >& get_exports() const;
+
+        /// <summary>
+        /// Finds an export by name.
+        /// </summary>
+        /// <param name="name">The exported name.</param>
+        /// <returns>The export, or nullptr if the module does not export the name.</returns>
+        const export_t* find_export( std::string_view name ) const;
+
+        /// <summary>
+        /// Finds an export by ordinal.
+        /// </summary>
+        /// <param name="ordinal">The ordinal of the export.</param>
+        /// <returns>The export, or nullptr if the module does not export the ordinal.</returns>
+        const export_t* find_export( std::uint16_t ordinal ) const;
+
+        /// <summary>
+        /// Gets every import of the module, parsed on first use.
+        /// </summary>
+        const std::vector< import_t >& get_imports() const;
+
+        /// <summary>
+        /// Finds an import by the module it comes from and its name.
+        /// </summary>
+        /// <param name="module">The name of the imported module (compared case-insensitively).</param>
+        /// <param name="name">The imported name.</param>
+        /// <returns>The import, or nullptr if the module does not import the name.</returns>
+        const import_t* find_import( std::string_view module, std::string_view name ) const;
+
+        /// <summary>
+        /// Gets every function listed in the module's exception directory, sorted by address. The directory is read in
+        /// one go on first use; 32-bit modules have none, so their list is empty.
+        /// </summary>
+        const std::vector< function_t >& get_functions() const;
+
+        /// <summary>
+        /// Finds the function containing an address.
+        /// </summary>
+        /// <param name="address">The address to look up.</param>
+        /// <returns>The function, or nullptr if no function in the exception directory contains the address.</returns>
+        const function_t* find_function( std::uintptr_t address ) const;
+
+        /// <summary>
+        /// Gets every location listed in the module's base relocation directory, sorted by RVA. The directory is read
+        /// in one go on first use.
+        /// </summary>
+        const std::vector< relocation_t >& get_relocations() const;
 
         /// <summary>
         /// Gets all locations of strings with the matching name.
@@ -148,6 +340,36 @@ namespace extlib::win
         /// <returns>A list of locations.</returns>
         std::vector< std::uintptr_t > find_all( const pattern_t& pattern ) const;
 
+        /// <summary>
+        /// Finds all matches for the given pattern in this module.
+        /// </summary>
+        /// <param name="pattern">The pattern to use.</param>
+        /// <param name="resource">The memory resource the returned list allocates from.</param>
+        /// <returns>A list of locations.</returns>
+        std::pmr::vector< std::uintptr_t > find_all( const pattern_t& pattern, std::pmr::memory_resource* resource ) const;
+
+        /// <summary>
+        /// Finds all matches for the given pattern that lie entirely within a function.
+        /// </summary>
+        /// <param name="pattern">The pattern to use.</param>
+        /// <param name="function">The function to search.</param>
+        /// <returns>A list of locations.</returns>
+        std::vector< std::uintptr_t > find_all( const pattern_t& pattern, const function_t& function ) const;
+
+        /// <summary>
+        /// Finds all matches for the given pattern that lie entirely within one of the given functions.
+        /// </summary>
+        /// <param name="pattern">The pattern to use.</param>
+        /// <param name="functions">The functions to search.</param>
+        /// <returns>A list of locations.</returns>
+        std::vector< std::uintptr_t > find_all( const pattern_t& pattern, const std::vector< function_t >& functions ) const;
+
+        /// <summary>
+        /// Creates an empty patch set for writing to the process this module belongs to.
+        /// </summary>
+        /// <returns>A new patch set.</returns>
+        patch_set create_patch_set() const;
+
         /// <summary>
         /// Checks to see if this module contains the provided address.
         /// </summary>
@@ -179,15 +401,100 @@ namespace extlib::win
         HMODULE module;
         HANDLE handle;
 
+        /// <summary>
+        /// The memory source the module is read from, or null for a module of a live process.
+        /// </summary>
+        std::shared_ptr< const memory_source > source;
+
         std::uintptr_t start, end;
 
-        pe_kind_t kind{};
+       private:
+        /// <summary>
+        /// Everything read from the module on first use: its headers, then each data directory as it is needed.
+        /// </summary>
+        struct state_t
+        {
+            std::once_flag headers_loaded;
+
+            pe_kind_t kind{};
 
-        IMAGE_DOS_HEADER dos{};
-        IMAGE_NT_HEADERS nt{};
-        IMAGE_SECTION_HEADER section{};
+            IMAGE_DOS_HEADER dos{};
+            IMAGE_NT_HEADERS nt{};
 
-        std::vector< section_t > sections;
+            std::vector< IMAGE_SECTION_HEADER > sections;
+
+            /// <summary>
+            /// The data directories, which live at different offsets in 32 and 64-bit optional headers.
+            /// </summary>
+            IMAGE_DATA_DIRECTORY directories[ IMAGE_NUMBEROF_DIRECTORY_ENTRIES ]{};
+
+            std::once_flag exports_loaded;
+
+            std::vector< export_t > exports;
+            std::unordered_map< std::string, std::size_t > exports_by_name;
+            std::unordered_map< std::uint16_t, std::size_t > exports_by_ordinal;
+
+            std::once_flag imports_loaded;
+
+            std::vector< import_t > imports;
+
+            /// <summary>
+            /// The imports by name, keyed by the lowercase module name and the imported name (see `import_key`).
+            /// </summary>
+            std::unordered_map< std::string, std::size_t > imports_by_name;
+
+            std::once_flag functions_loaded;
+
+            std::vector< function_t > functions;
+
+            std::once_flag relocations_loaded;
+
+            std::vector< relocation_t > relocations;
+
+            std::once_flag scanners_created;
+
+            /// <summary>
+            /// The scanners `find_all` scans the module and its sections with, kept so repeated scans reuse them.
+            /// </summary>
+            std::shared_ptr< scanner_pool > scanners;
+        };
+
+        /// <summary>
+        /// Gets the module's headers, reading them if this is the first time they are needed.
+        /// </summary>
+        const state_t& load_headers() const;
+
+        /// <summary>
+        /// Gets the module's exports, parsing them if this is the first time they are needed.
+        /// </summary>
+        const state_t& load_exports() const;
+
+        /// <summary>
+        /// Gets the module's imports, parsing them if this is the first time they are needed.
+        /// </summary>
+        const state_t& load_imports() const;
+
+        /// <summary>
+        /// Gets the module's functions, parsing them if this is the first time they are needed.
+        /// </summary>
+        const state_t& load_functions() const;
+
+        /// <summary>
+        /// Gets the module's relocations, parsing them if this is the first time they are needed.
+        /// </summary>
+        const state_t& load_relocations() const;
+
+        /// <summary>
+        /// Gets the module's scanners, creating them if this is the first scan.
+        /// </summary>
+        scanner_pool& get_scanners() const;
+
+        friend struct section_t;
+
+        /// <summary>
+        /// Shared between copies, so nothing is read more than once however often the module is copied.
+        /// </summary>
+        std::shared_ptr< state_t > state;
     };
 
     /// <summary>
@@ -231,6 +538,14 @@ namespace extlib::win
         /// <returns>A list of locations.</returns>
         std::vector< std::uintptr_t > find_all( const pattern_t& pattern ) const;
 
+        /// <summary>
+        /// Finds all matches for the given pattern in this section.
+        /// </summary>
+        /// <param name="pattern">The pattern to use.</param>
+        /// <param name="resource">The memory resource the returned list allocates from.</param>
+        /// <returns>A list of locations.</returns>
+        std::pmr::vector< std::uintptr_t > find_all( const pattern_t& pattern, std::pmr::memory_resource* resource ) const;
+
         /// <summary>
         /// Gets all regions within the current section.
         /// </summary>
@@ -262,6 +577,15 @@ namespace extlib::win
     template< typename T >
     inline T module_t::read( std::uintptr_t address, std::size_t* bytes_read ) const
     {
-        return memapi::read_process_memory< T >( handle, address, bytes_read );
+        if ( !source )
+            return memapi::read_process_memory< T >( handle, address, bytes_read );
+
+        T value{};
+        source->read_exact( address, &value, sizeof( value ) );
+
+        if ( bytes_read )
+            *bytes_read = sizeof( value );
+
+        return value;
     }
 }  // namespace extlib::win
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace extlib::x64
+{
+    /// <summary>
+    /// The longest an x64 instruction can be.
+    /// </summary>
+    constexpr std::size_t max_instruction_length = 15;
+
+    /// <summary>
+    /// The layout of a decoded instruction. Only lengths and operand positions are decoded, not what the instruction
+    /// does.
+    /// </summary>
+    struct instruction_t
+    {
+        /// <summary>
+        /// The length of the whole instruction.
+        /// </summary>
+        std::uint8_t length;
+
+        /// <summary>
+        /// Where the memory operand's displacement starts and its size, or a size of 0 if there is none.
+        /// </summary>
+        std::uint8_t displacement_offset, displacement_size;
+
+        /// <summary>
+        /// Where the immediate starts and its size, or a size of 0 if there is none.
+        /// </summary>
+        std::uint8_t immediate_offset, immediate_size;
+
+        /// <summary>
+        /// Whether the displacement is relative to the next instruction (RIP-relative addressing).
+        /// </summary>
+        bool rip_relative;
+
+        /// <summary>
+        /// Whether the immediate is a branch displacement relative to the next instruction (e.g. `call rel32`).
+        /// </summary>
+        bool relative_branch;
+    };
+
+    /// <summary>
+    /// Decodes the length and operand layout of the instruction at `data`. Legacy and REX prefixes, VEX and EVEX
+    /// encodings, ModRM and SIB bytes, displacements and immediates are all accounted for, using lookup tables for the
+    /// one and two-byte opcode maps.
+    /// </summary>
+    /// <param name="data">The first byte of the instruction.</param>
+    /// <param name="size">The number of bytes available at `data`.</param>
+    /// <returns>The instruction, or nothing if the bytes are not a valid 64-bit instruction or are cut short.</returns>
+    std::optional< instruction_t > decode( const std::uint8_t* data, std::size_t size );
+}  // namespace extlib::x64
@@ -0,0 +1,199 @@
+#include "address_index.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace extlib
+{
+    namespace
+    {
+        /// <summary>
+        /// Advances a cursor over sorted start addresses to the last entry starting at or before an address.
+        /// </summary>
+        /// <returns>The entry's index, or `address_location_t::none` if the address is outside its range.</returns>
+        std::uint32_t advance(
+            const std::vector< std::uintptr_t >& starts,
+            const std::vector< std::uintptr_t >& ends,
+            std::size_t& cursor,
+            std::uintptr_t address )
+        {
+            while ( cursor < starts.size() && starts[ cursor ] <= address )
+                ++cursor;
+
+            if ( cursor == 0 || address >= ends[ cursor - 1 ] )
+                return address_location_t::none;
+
+            return static_cast< std::uint32_t >( cursor - 1 );
+        }
+    }  // namespace
+
+    address_index address_index::build( std::vector< win::module_t > modules, bool with_regions )
+    {
+        address_index index;
+
+        std::sort( modules.begin(), modules.end(), []( const win::module_t& left, const win::module_t& right ) {
+            return left.start < right.start;
+        } );
+
+        for ( auto& module : modules )
+        {
+            const auto module_index = static_cast< std::uint32_t >( index.modules.size() );
+
+            index.module_names.push_back( module.get_name() );
+            index.module_starts.push_back( module.start );
+            index.module_ends.push_back( module.end );
+            index.module_first_section.push_back( static_cast< std::uint32_t >( index.sections.size() ) );
+
+            auto sections = module.get_sections();
+
+            std::sort( sections.begin(), sections.end(), []( const win::section_t& left, const win::section_t& right ) {
+                return left.start < right.start;
+            } );
+
+            for ( const auto& section : sections )
+            {
+                index.sections.push_back(
+                    { section.start, section.end, std::string( section.name.c_str() ), module_index } );
+
+                index.section_starts.push_back( section.start );
+                index.section_ends.push_back( section.end );
+            }
+
+            index.module_last_section.push_back( static_cast< std::uint32_t >( index.sections.size() ) );
+            index.modules.push_back( std::move( module ) );
+        }
+
+        // Every module reads the same address space, so any of them can list its regions.
+        if ( with_regions && !index.modules.empty() )
+        {
+            for ( const auto& region :
+                  index.modules.front().get_regions( 0, std::numeric_limits< std::uintptr_t >::max() ) )
+            {
+                if ( region.state == win::region_state_t::free_t )
+                    continue;
+
+                index.regions.push_back( region );
+                index.region_starts.push_back( region.start );
+                index.region_ends.push_back( region.end );
+            }
+        }
+
+        return index;
+    }
+
+    address_location_t address_index::lookup( std::uintptr_t address ) const
+    {
+        address_location_t location{ address };
+
+        location.module = find( module_starts, module_ends, 0, module_starts.size(), address );
+        location.region = find( region_starts, region_ends, 0, region_starts.size(), address );
+
+        resolve_section( location );
+
+        return location;
+    }
+
+    void address_index::lookup( const std::uintptr_t* addresses, std::size_t count, address_location_t* locations ) const
+    {
+        if ( !std::is_sorted( addresses, addresses + count ) )
+        {
+            for ( std::size_t i = 0; i < count; ++i )
+                locations[ i ] = lookup( addresses[ i ] );
+
+            return;
+        }
+
+        std::size_t module_cursor = 0, region_cursor = 0;
+
+        for ( std::size_t i = 0; i < count; ++i )
+        {
+            auto& location = locations[ i ];
+
+            location = { addresses[ i ] };
+            location.module = advance( module_starts, module_ends, module_cursor, location.address );
+            location.region = advance( region_starts, region_ends, region_cursor, location.address );
+
+            resolve_section( location );
+        }
+    }
+
+    std::vector< address_location_t > address_index::lookup( const std::vector< std::uintptr_t >& addresses ) const
+    {
+        std::vector< address_location_t > locations( addresses.size() );
+
+        lookup( addresses.data(), addresses.size(), locations.data() );
+
+        return locations;
+    }
+
+    std::string address_index::describe( const address_location_t& location ) const
+    {
+        std::stringstream stream;
+
+        if ( !location.in_module() )
+        {
+            stream << "0x" << std::hex << location.address;
+            return stream.str();
+        }
+
+        stream << module_names[ location.module ] << "+0x" << std::hex << location.rva;
+
+        if ( location.in_section() )
+            stream << " (" << sections[ location.section ].name << ")";
+
+        return stream.str();
+    }
+
+    const std::vector< win::module_t >& address_index::get_modules() const
+    {
+        return modules;
+    }
+
+    const std::vector< std::string >& address_index::get_module_names() const
+    {
+        return module_names;
+    }
+
+    const std::vector< address_index::section_entry_t >& address_index::get_sections() const
+    {
+        return sections;
+    }
+
+    const std::vector< win::region_t >& address_index::get_regions() const
+    {
+        return regions;
+    }
+
+    std::uint32_t address_index::find(
+        const std::vector< std::uintptr_t >& starts,
+        const std::vector< std::uintptr_t >& ends,
+        std::size_t first,
+        std::size_t last,
+        std::uintptr_t address )
+    {
+        const auto begin = starts.begin() + static_cast< std::ptrdiff_t >( first );
+        const auto it = std::upper_bound( begin, starts.begin() + static_cast< std::ptrdiff_t >( last ), address );
+
+        if ( it == begin )
+            return address_location_t::none;
+
+        const auto found = static_cast< std::size_t >( it - starts.begin() ) - 1;
+
+        return address < ends[ found ] ? static_cast< std::uint32_t >( found ) : address_location_t::none;
+    }
+
+    void address_index::resolve_section( address_location_t& location ) const
+    {
+        if ( !location.in_module() )
+            return;
+
+        location.rva = static_cast< std::uint32_t >( location.address - module_starts[ location.module ] );
+        location.section = find(
+            section_starts,
+            section_ends,
+            module_first_section[ location.module ],
+            module_last_section[ location.module ],
+            location.address );
+    }
+}  // namespace extlib
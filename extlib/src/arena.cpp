@@ -0,0 +1,131 @@
+#include "arena.hpp"
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <new>
+
+namespace extlib
+{
+    namespace
+    {
+        constexpr std::size_t align_up( std::size_t value, std::size_t alignment )
+        {
+            return ( value + alignment - 1 ) & ~( alignment - 1 );
+        }
+    }  // namespace
+
+    arena::arena( std::size_t block_size, bool large_pages )
+        : block_size( block_size ),
+          current( 0 ),
+          offset( 0 ),
+          consumed( 0 ),
+          large_pages( large_pages )
+    {
+    }
+
+    arena::~arena()
+    {
+        release();
+    }
+
+    void arena::reset()
+    {
+        current = 0;
+        offset = 0;
+        consumed = 0;
+    }
+
+    void arena::release()
+    {
+        for ( const auto& block : blocks )
+            VirtualFree( block.data, 0, MEM_RELEASE );
+
+        blocks.clear();
+        reset();
+    }
+
+    std::size_t arena::used() const
+    {
+        return consumed;
+    }
+
+    std::size_t arena::capacity() const
+    {
+        std::size_t total = 0;
+
+        for ( const auto& block : blocks )
+            total += block.size;
+
+        return total;
+    }
+
+    void* arena::do_allocate( std::size_t bytes, std::size_t alignment )
+    {
+        alignment = std::max( alignment, min_alignment );
+
+        // Walk forward through the blocks we already own before asking the system for more.
+        for ( ; current < blocks.size(); ++current, offset = 0 )
+        {
+            const auto& block = blocks[ current ];
+            const auto aligned = align_up( offset, alignment );
+
+            if ( aligned + bytes <= block.size )
+            {
+                offset = aligned + bytes;
+                consumed += bytes;
+
+                return block.data + aligned;
+            }
+        }
+
+        // Blocks are page aligned, so only alignments past a page need any slack.
+        const auto slack = alignment > 0x1000 ? alignment : 0;
+
+        blocks.push_back( allocate_block( std::max( block_size, bytes + slack ) ) );
+
+        current = blocks.size() - 1;
+
+        const auto aligned = align_up( reinterpret_cast< std::uintptr_t >( blocks.back().data ), alignment ) -
+                             reinterpret_cast< std::uintptr_t >( blocks.back().data );
+
+        offset = aligned + bytes;
+        consumed += bytes;
+
+        return blocks.back().data + aligned;
+    }
+
+    void arena::do_deallocate( void* /* pointer */, std::size_t /* bytes */, std::size_t /* alignment */ )
+    {
+        // Monotonic: memory is only reclaimed by `reset`.
+    }
+
+    bool arena::do_is_equal( const std::pmr::memory_resource& other ) const noexcept
+    {
+        return this == &other;
+    }
+
+    arena::block_t arena::allocate_block( std::size_t size ) const
+    {
+        if ( large_pages )
+        {
+            // Large pages need SeLockMemoryPrivilege, so quietly fall back to regular pages when they are refused.
+            if ( const auto minimum = GetLargePageMinimum() )
+            {
+                const auto rounded = align_up( size, minimum );
+
+                if ( const auto data = VirtualAlloc(
+                         nullptr, rounded, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE ) )
+                    return { static_cast< std::uint8_t* >( data ), rounded };
+            }
+        }
+
+        const auto rounded = align_up( size, 0x1000 );
+        const auto data = VirtualAlloc( nullptr, rounded, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE );
+
+        if ( !data )
+            throw std::bad_alloc();
+
+        return { static_cast< std::uint8_t* >( data ), rounded };
+    }
+}  // namespace extlib
@@ -0,0 +1,114 @@
+#include "async.hpp"
+
+#include <utility>
+
+#include "remote.hpp"
+
+namespace extlib::async
+{
+    executor::executor( std::size_t threads ) : pool( threads )
+    {
+    }
+
+    executor& executor::shared()
+    {
+        static executor instance;
+
+        return instance;
+    }
+
+    task< std::vector< std::uint8_t > > executor::read(
+        win::module_t module,
+        std::uintptr_t address,
+        std::size_t length,
+        cancellation_token cancellation )
+    {
+        co_await schedule();
+
+        cancellation.throw_if_cancelled();
+
+        co_return module.read( address, length );
+    }
+
+    task< std::vector< std::optional< std::vector< std::uint8_t > > > > executor::read_batch(
+        win::module_t module,
+        std::vector< read_request_t > requests,
+        cancellation_token cancellation )
+    {
+        co_await schedule();
+
+        std::vector< std::vector< std::uint8_t > > buffers( requests.size() );
+        std::vector< extlib::detail::remote_read_t > reads;
+
+        for ( std::size_t i = 0; i < requests.size(); ++i )
+        {
+            buffers[ i ].resize( requests[ i ].length );
+            reads.push_back( { requests[ i ].address, requests[ i ].length, buffers[ i ].data(), i } );
+        }
+
+        const auto runs = extlib::detail::merge_reads( reads );
+
+        std::vector< std::uint8_t > failed( requests.size() );
+
+        pool.parallel_for( runs.size(), [ & ]( std::size_t index ) {
+            cancellation.throw_if_cancelled();
+
+            std::vector< std::uint8_t > buffer;
+            extlib::detail::read_merged( module, reads, runs[ index ], buffer, failed );
+        } );
+
+        std::vector< std::optional< std::vector< std::uint8_t > > > results( requests.size() );
+
+        for ( std::size_t i = 0; i < requests.size(); ++i )
+        {
+            if ( !failed[ i ] )
+                results[ i ] = std::move( buffers[ i ] );
+        }
+
+        co_return results;
+    }
+
+    task< std::vector< std::uintptr_t > > executor::find_all(
+        scanner_options_t options,
+        pattern_t pattern,
+        cancellation_token cancellation )
+    {
+        co_await schedule();
+
+        options.cancellation = std::move( cancellation );
+
+        co_return scanners.scan( options, [ & ]( const scanner& scan ) { return scan.find_all( pattern ); } );
+    }
+
+    task< std::vector< std::vector< std::uintptr_t > > > executor::find_all_batch(
+        scanner_options_t options,
+        std::vector< pattern_t > patterns,
+        cancellation_token cancellation )
+    {
+        co_await schedule();
+
+        options.cancellation = std::move( cancellation );
+
+        std::vector< std::vector< std::uintptr_t > > results( patterns.size() );
+
+        // A scanner must not be shared between threads, so every scan takes one of its own from those kept.
+        pool.parallel_for( patterns.size(), [ & ]( std::size_t index ) {
+            results[ index ] =
+                scanners.scan( options, [ & ]( const scanner& scan ) { return scan.find_all( patterns[ index ] ); } );
+        } );
+
+        co_return results;
+    }
+
+    task< std::unique_ptr< object > > executor::find_object(
+        win::module_t module,
+        object_pattern_t pattern,
+        cancellation_token cancellation )
+    {
+        co_await schedule();
+
+        cancellation.throw_if_cancelled();
+
+        co_return object::find_object( module, pattern );
+    }
+}  // namespace extlib::async
@@ -0,0 +1,43 @@
+#include "cancellation.hpp"
+
+namespace extlib
+{
+    operation_cancelled::operation_cancelled() : std::runtime_error( "The operation was cancelled" )
+    {
+    }
+
+    cancellation_token::cancellation_token( std::shared_ptr< const std::atomic< bool > > state )
+        : state( std::move( state ) )
+    {
+    }
+
+    bool cancellation_token::is_cancelled() const
+    {
+        return state && state->load( std::memory_order_relaxed );
+    }
+
+    void cancellation_token::throw_if_cancelled() const
+    {
+        if ( is_cancelled() )
+            throw operation_cancelled();
+    }
+
+    cancellation_source::cancellation_source() : state( std::make_shared< std::atomic< bool > >( false ) )
+    {
+    }
+
+    cancellation_token cancellation_source::get_token() const
+    {
+        return cancellation_token( state );
+    }
+
+    void cancellation_source::cancel()
+    {
+        state->store( true, std::memory_order_relaxed );
+    }
+
+    bool cancellation_source::is_cancelled() const
+    {
+        return state->load( std::memory_order_relaxed );
+    }
+}  // namespace extlib
@@ -0,0 +1,531 @@
+#include "dump.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "file_format.hpp"
+
+namespace extlib
+{
+    namespace
+    {
+        constexpr std::size_t page_size = 0x1000;
+
+        /// <summary>
+        /// The longest run a single RLE packet can hold.
+        /// </summary>
+        constexpr std::size_t max_run = 128;
+
+        /// <summary>
+        /// Compresses a buffer with PackBits-style run-length encoding. A control byte below 128 is followed by that
+        /// many plus one literal bytes, and a control byte above 128 repeats the following byte 257 minus it times.
+        /// </summary>
+        std::vector< std::uint8_t > rle_encode( const std::uint8_t* data, std::size_t size )
+        {
+            std::vector< std::uint8_t > encoded;
+            encoded.reserve( size / 8 );
+
+            for ( std::size_t position = 0; position < size; )
+            {
+                auto run = std::size_t{ 1 };
+
+                while ( run < max_run && position + run < size && data[ position + run ] == data[ position ] )
+                    ++run;
+
+                if ( run > 1 )
+                {
+                    encoded.push_back( static_cast< std::uint8_t >( 257 - run ) );
+                    encoded.push_back( data[ position ] );
+
+                    position += run;
+                    continue;
+                }
+
+                // Collect literals until the next run of at least three bytes, which is worth a packet of its own.
+                const auto literal_start = position;
+
+                while ( position < size && position - literal_start < max_run )
+                {
+                    if ( position + 2 < size && data[ position ] == data[ position + 1 ] &&
+                         data[ position ] == data[ position + 2 ] )
+                        break;
+
+                    ++position;
+                }
+
+                encoded.push_back( static_cast< std::uint8_t >( position - literal_start - 1 ) );
+                encoded.insert( encoded.end(), data + literal_start, data + position );
+            }
+
+            return encoded;
+        }
+
+        /// <summary>
+        /// Decompresses a run-length encoded buffer.
+        /// </summary>
+        /// <returns>True, if the buffer decoded to exactly `output.size()` bytes.</returns>
+        bool rle_decode( const std::uint8_t* data, std::size_t size, std::vector< std::uint8_t >& output )
+        {
+            std::size_t written = 0;
+
+            for ( std::size_t position = 0; position < size; )
+            {
+                const auto control = data[ position++ ];
+
+                if ( control < 128 )
+                {
+                    const auto count = std::size_t{ control } + 1;
+
+                    if ( position + count > size || written + count > output.size() )
+                        return false;
+
+                    std::memcpy( output.data() + written, data + position, count );
+
+                    position += count;
+                    written += count;
+                }
+                else if ( control > 128 )
+                {
+                    const auto count = std::size_t{ 257 } - control;
+
+                    if ( position >= size || written + count > output.size() )
+                        return false;
+
+                    std::memset( output.data() + written, data[ position++ ], count );
+                    written += count;
+                }
+            }
+
+            return written == output.size();
+        }
+
+        /// <summary>
+        /// Writes a dump while keeping track of the current offset.
+        /// </summary>
+        class dump_stream final
+        {
+           public:
+            explicit dump_stream( const std::filesystem::path& path ) : stream( path, std::ios::binary | std::ios::trunc )
+            {
+                if ( !stream )
+                {
+                    std::stringstream msg;
+                    msg << "Failed to create dump '" << path.string() << "'";
+                    throw std::runtime_error( msg.str() );
+                }
+            }
+
+            std::uint64_t write( const void* data, std::size_t size )
+            {
+                const auto offset = position;
+
+                stream.write( static_cast< const char* >( data ), static_cast< std::streamsize >( size ) );
+                position += size;
+
+                return offset;
+            }
+
+            void align( std::size_t alignment )
+            {
+                static constexpr std::uint8_t zeros[ page_size ]{};
+
+                if ( const auto remainder = position % alignment )
+                    write( zeros, alignment - remainder );
+            }
+
+            void finish( const dump_format::header_t& header )
+            {
+                stream.seekp( 0 );
+                stream.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+                stream.flush();
+
+                if ( !stream )
+                    throw std::runtime_error( "Failed to write dump" );
+            }
+
+           private:
+            std::ofstream stream;
+            std::uint64_t position = 0;
+        };
+
+        /// <summary>
+        /// Checks whether a region's contents were captured.
+        /// </summary>
+        bool is_readable( const win::region_t& region )
+        {
+            return region.state == win::region_state_t::commit_t && !( region.protect & PAGE_GUARD ) &&
+                   region.protect != PAGE_NOACCESS;
+        }
+
+        [[noreturn]] void corrupt( const std::filesystem::path& path, const char* reason )
+        {
+            detail::throw_corrupt( path, "dump", reason );
+        }
+    }  // namespace
+
+    void dump_writer::write( const std::filesystem::path& path, const memory_source& source, const dump_options_t& options )
+    {
+        if ( !options.block_size || options.block_size % page_size || options.block_size > 0xFFFFFFFF )
+            throw std::invalid_argument( "The block size of a dump must be a non-zero multiple of the page size" );
+
+        const auto regions = source.get_regions( options.start, options.end );
+        const auto modules = source.get_modules();
+
+        std::vector< dump_format::region_entry_t > region_table;
+        std::vector< dump_format::block_entry_t > block_table;
+        std::vector< dump_format::module_entry_t > module_table;
+        std::string strings;
+
+        dump_stream stream{ path };
+
+        dump_format::header_t header{};
+        stream.write( &header, sizeof( header ) );
+
+        std::vector< std::uint8_t > buffer( options.block_size );
+
+        for ( const auto& region : regions )
+        {
+            dump_format::region_entry_t entry{
+                region.start,
+                region.size,
+                region.protect,
+                static_cast< std::uint32_t >( region.state ),
+                static_cast< std::uint32_t >( region.type ),
+                block_table.size(),
+                0 };
+
+            if ( is_readable( region ) )
+            {
+                stream.align( page_size );
+
+                for ( std::size_t offset = 0; offset < region.size; offset += options.block_size )
+                {
+                    const auto size = std::min( options.block_size, region.size - offset );
+
+                    if ( source.read( region.start + offset, buffer.data(), size ) != size )
+                    {
+                        block_table.push_back( { 0, 0, dump_codec_t::absent } );
+                        continue;
+                    }
+
+                    if ( options.codec == dump_codec_t::rle )
+                    {
+                        const auto encoded = rle_encode( buffer.data(), size );
+
+                        if ( encoded.size() < size )
+                        {
+                            const auto position = stream.write( encoded.data(), encoded.size() );
+                            block_table.push_back(
+                                { position, static_cast< std::uint32_t >( encoded.size() ), dump_codec_t::rle } );
+
+                            continue;
+                        }
+                    }
+
+                    const auto position = stream.write( buffer.data(), size );
+                    block_table.push_back( { position, static_cast< std::uint32_t >( size ), dump_codec_t::none } );
+                }
+
+                entry.block_count = block_table.size() - entry.first_block;
+            }
+
+            region_table.push_back( entry );
+        }
+
+        for ( const auto& module : modules )
+        {
+            dump_format::module_entry_t entry{
+                module.base, module.size, strings.size(), static_cast< std::uint32_t >( module.name.size() ), 0, 0 };
+
+            strings.append( module.name );
+
+            const auto header_size = std::min( module.size, page_size );
+
+            if ( source.read( module.base, buffer.data(), header_size ) == header_size )
+            {
+                stream.align( alignof( std::uint64_t ) );
+
+                entry.header_offset = stream.write( buffer.data(), header_size );
+                entry.header_size = static_cast< std::uint32_t >( header_size );
+            }
+
+            module_table.push_back( entry );
+        }
+
+        const auto write_table = [ &stream ]( const auto& table, std::uint64_t& offset ) {
+            using entry_t = typename std::decay_t< decltype( table ) >::value_type;
+
+            stream.align( alignof( std::uint64_t ) );
+            offset = stream.write( table.data(), table.size() * sizeof( entry_t ) );
+        };
+
+        header.magic = dump_format::magic;
+        header.version = dump_format::version;
+        header.block_size = static_cast< std::uint32_t >( options.block_size );
+
+        header.region_count = region_table.size();
+        header.block_count = block_table.size();
+        header.module_count = module_table.size();
+        header.string_size = strings.size();
+
+        write_table( region_table, header.region_table );
+        write_table( block_table, header.block_table );
+        write_table( module_table, header.module_table );
+        write_table( strings, header.string_table );
+
+        stream.finish( header );
+    }
+
+    dump_source::dump_source( const std::filesystem::path& path )
+        : file( std::make_unique< win::mapped_file >( path ) ),
+          cached_index( std::numeric_limits< std::size_t >::max() )
+    {
+        const auto data = file->data();
+        const auto size = file->size();
+
+        if ( size < sizeof( header ) )
+            corrupt( path, "the file is too small" );
+
+        std::memcpy( &header, data, sizeof( header ) );
+
+        if ( header.magic != dump_format::magic )
+            corrupt( path, "the magic does not match" );
+
+        if ( header.version != dump_format::version )
+            corrupt( path, "the version is not supported" );
+
+        if ( !header.block_size || header.block_size % page_size )
+            corrupt( path, "the block size is not a multiple of the page size" );
+
+        if ( !detail::table_fits( header.region_table, header.region_count, sizeof( *regions ), size ) ||
+             !detail::table_fits( header.block_table, header.block_count, sizeof( *blocks ), size ) ||
+             !detail::table_fits( header.module_table, header.module_count, sizeof( *modules ), size ) ||
+             header.string_table > size || header.string_size > size - header.string_table )
+            corrupt( path, "a table lies outside the file" );
+
+        regions = detail::table_at< dump_format::region_entry_t >( data, header.region_table );
+        blocks = detail::table_at< dump_format::block_entry_t >( data, header.block_table );
+        modules = detail::table_at< dump_format::module_entry_t >( data, header.module_table );
+        strings = detail::table_at< char >( data, header.string_table );
+
+        // Validate everything the reads below rely on up front, so they can trust the tables.
+        for ( std::size_t i = 0; i < header.region_count; ++i )
+        {
+            const auto& region = regions[ i ];
+
+            if ( i && region.start < regions[ i - 1 ].start + regions[ i - 1 ].size )
+                corrupt( path, "the regions are not sorted" );
+
+            if ( region.first_block > header.block_count || region.block_count > header.block_count - region.first_block ||
+                 region.block_count > ( region.size + header.block_size - 1 ) / header.block_size )
+                corrupt( path, "a region's blocks lie outside the block table" );
+        }
+
+        for ( std::size_t i = 0; i < header.block_count; ++i )
+        {
+            const auto& block = blocks[ i ];
+
+            if ( block.codec != dump_codec_t::absent &&
+                 ( block.offset > size || block.stored_size > size - block.offset ) )
+                corrupt( path, "a block lies outside the file" );
+        }
+
+        for ( std::size_t i = 0; i < header.module_count; ++i )
+        {
+            const auto& module = modules[ i ];
+
+            if ( module.name_offset > header.string_size || module.name_length > header.string_size - module.name_offset ||
+                 module.header_offset > size || module.header_size > size - module.header_offset )
+                corrupt( path, "a module lies outside the file" );
+        }
+    }
+
+    std::vector< win::region_t > dump_source::get_regions( std::uintptr_t start, std::uintptr_t end ) const
+    {
+        std::vector< win::region_t > result;
+
+        const auto last = regions + header.region_count;
+        auto it = std::partition_point( regions, last, [ start ]( const dump_format::region_entry_t& region ) {
+            return region.start + region.size <= start;
+        } );
+
+        for ( ; it != last && it->start <= end; ++it )
+        {
+            result.push_back( {
+                static_cast< std::uintptr_t >( it->start ),
+                static_cast< std::uintptr_t >( it->start + it->size ),
+                static_cast< std::size_t >( it->size ),
+                it->protect,
+                static_cast< win::region_state_t >( it->state ),
+                static_cast< win::region_type_t >( it->type ) } );
+        }
+
+        return result;
+    }
+
+    std::vector< module_info_t > dump_source::get_modules() const
+    {
+        std::vector< module_info_t > result;
+        result.reserve( header.module_count );
+
+        for ( std::size_t i = 0; i < header.module_count; ++i )
+        {
+            const auto& module = modules[ i ];
+
+            result.push_back( {
+                std::string( strings + module.name_offset, module.name_length ),
+                static_cast< std::uintptr_t >( module.base ),
+                static_cast< std::size_t >( module.size ) } );
+        }
+
+        return result;
+    }
+
+    std::size_t dump_source::read( std::uintptr_t address, void* buffer, std::size_t size ) const
+    {
+        const auto output = static_cast< std::uint8_t* >( buffer );
+        std::size_t done = 0;
+
+        while ( done < size )
+        {
+            const auto current = address + done;
+            const auto region = find_region( current );
+
+            if ( !region )
+                break;
+
+            const auto offset = current - region->start;
+            const auto index = offset / header.block_size;
+
+            if ( index >= region->block_count )
+                break;
+
+            const auto block_offset = offset % header.block_size;
+            const auto raw_size = std::min< std::uint64_t >( header.block_size, region->size - index * header.block_size );
+            const auto length = std::min< std::size_t >( raw_size - block_offset, size - done );
+
+            if ( !copy_block( region->first_block + index, raw_size, block_offset, output + done, length ) )
+                break;
+
+            done += length;
+        }
+
+        if ( !done )
+            return read_module_header( address, buffer, size );
+
+        return done;
+    }
+
+    const std::uint8_t* dump_source::view( std::uintptr_t address, std::size_t size ) const
+    {
+        const auto region = find_region( address );
+
+        if ( !size || !region || address + size > region->start + region->size )
+            return nullptr;
+
+        const auto offset = address - region->start;
+        const auto first = offset / header.block_size;
+        const auto last = ( offset + size - 1 ) / header.block_size;
+
+        if ( last >= region->block_count )
+            return nullptr;
+
+        // Only uncompressed blocks that follow each other in the file can be handed out directly.
+        const auto& first_block = blocks[ region->first_block + first ];
+
+        for ( auto index = first; index <= last; ++index )
+        {
+            const auto& block = blocks[ region->first_block + index ];
+            const auto raw_size = std::min< std::uint64_t >( header.block_size, region->size - index * header.block_size );
+
+            if ( block.codec != dump_codec_t::none || block.stored_size != raw_size ||
+                 block.offset != first_block.offset + ( index - first ) * header.block_size )
+                return nullptr;
+        }
+
+        return file->data() + first_block.offset + offset % header.block_size;
+    }
+
+    const dump_format::region_entry_t* dump_source::find_region( std::uintptr_t address ) const
+    {
+        const auto last = regions + header.region_count;
+        const auto it = std::upper_bound(
+            regions, last, address, []( std::uintptr_t value, const dump_format::region_entry_t& region ) {
+                return value < region.start;
+            } );
+
+        if ( it == regions )
+            return nullptr;
+
+        const auto region = it - 1;
+
+        return address - region->start < region->size ? region : nullptr;
+    }
+
+    bool dump_source::copy_block(
+        std::size_t index,
+        std::size_t raw_size,
+        std::size_t offset,
+        void* buffer,
+        std::size_t size ) const
+    {
+        const auto& block = blocks[ index ];
+        const auto stored = file->data() + block.offset;
+
+        switch ( block.codec )
+        {
+            case dump_codec_t::none:
+            {
+                if ( block.stored_size != raw_size )
+                    return false;
+
+                std::memcpy( buffer, stored + offset, size );
+                return true;
+            }
+            case dump_codec_t::rle:
+            {
+                std::lock_guard< std::mutex > lock( cache_mutex );
+
+                if ( cached_index != index )
+                {
+                    cached_block.resize( raw_size );
+
+                    if ( !rle_decode( stored, block.stored_size, cached_block ) )
+                    {
+                        cached_index = std::numeric_limits< std::size_t >::max();
+                        return false;
+                    }
+
+                    cached_index = index;
+                }
+
+                std::memcpy( buffer, cached_block.data() + offset, size );
+                return true;
+            }
+            default: return false;
+        }
+    }
+
+    std::size_t dump_source::read_module_header( std::uintptr_t address, void* buffer, std::size_t size ) const
+    {
+        for ( std::size_t i = 0; i < header.module_count; ++i )
+        {
+            const auto& module = modules[ i ];
+
+            if ( address < module.base || address - module.base >= module.header_size )
+                continue;
+
+            const auto offset = address - module.base;
+            const auto length = std::min< std::size_t >( size, module.header_size - offset );
+
+            std::memcpy( buffer, file->data() + module.header_offset + offset, length );
+
+            return length;
+        }
+
+        return 0;
+    }
+}  // namespace extlib
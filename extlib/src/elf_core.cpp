@@ -0,0 +1,172 @@
+#include "elf_core.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace extlib
+{
+    namespace
+    {
+        /// <summary>
+        /// Converts the permissions of a segment into the equivalent page protection.
+        /// </summary>
+        std::uint64_t to_protection( std::uint32_t flags )
+        {
+            const auto readable = ( flags & elf_format::read_flag ) != 0;
+            const auto writable = ( flags & elf_format::write_flag ) != 0;
+
+            if ( flags & elf_format::execute_flag )
+                return writable ? PAGE_EXECUTE_READWRITE : readable ? PAGE_EXECUTE_READ : PAGE_EXECUTE;
+
+            return writable ? PAGE_READWRITE : readable ? PAGE_READONLY : PAGE_NOACCESS;
+        }
+
+        /// <summary>
+        /// Rounds a note field size up to the 4 byte alignment notes use.
+        /// </summary>
+        constexpr std::size_t note_align( std::size_t size )
+        {
+            return ( size + 3 ) & ~std::size_t{ 3 };
+        }
+    }  // namespace
+
+    elf_core_source::elf_core_source( const std::filesystem::path& path ) : file_source( path )
+    {
+        using namespace elf_format;
+
+        const auto header = load< header_t >( 0 );
+
+        if ( header.magic != magic || header.elf_class != class64 || header.encoding != little_endian ||
+             header.type != core_type )
+        {
+            std::stringstream msg;
+            msg << "'" << path.string() << "' is not a 64-bit little-endian ELF core file";
+            throw std::runtime_error( msg.str() );
+        }
+
+        if ( header.program_header_size < sizeof( program_header_t ) )
+            throw std::runtime_error( "The program headers of the core file are too small" );
+
+        std::vector< program_header_t > segments;
+        segments.reserve( header.program_header_count );
+
+        for ( std::size_t i = 0; i < header.program_header_count; ++i )
+            segments.push_back(
+                load< program_header_t >( header.program_headers + i * header.program_header_size ) );
+
+        // Notes first, so the load segments can be typed after the modules that cover them.
+        for ( const auto& segment : segments )
+        {
+            if ( segment.type == note_segment )
+                read_notes( segment );
+        }
+
+        for ( const auto& segment : segments )
+        {
+            if ( segment.type != load_segment || !segment.memory_size )
+                continue;
+
+            const auto address = static_cast< std::uintptr_t >( segment.address );
+            const auto size = static_cast< std::size_t >( segment.memory_size );
+
+            auto type = win::region_type_t::private_t;
+
+            for ( const auto& module : modules )
+            {
+                if ( address >= module.base && address - module.base < module.size )
+                    type = win::region_type_t::image_t;
+            }
+
+            regions.push_back(
+                { address, address + size, size, to_protection( segment.flags ), win::region_state_t::commit_t, type } );
+
+            // Segments the kernel chose not to dump (e.g. unmodified file mappings) have no contents in the file.
+            const auto stored = std::min( segment.file_size, segment.memory_size );
+            add_range( address, static_cast< std::size_t >( stored ), segment.offset );
+        }
+
+        sort();
+    }
+
+    void elf_core_source::read_notes( const elf_format::program_header_t& segment )
+    {
+        const auto data = at( segment.offset, static_cast< std::size_t >( segment.file_size ) );
+
+        if ( !data )
+            throw std::runtime_error( "A note segment lies outside the file" );
+
+        const auto size = static_cast< std::size_t >( segment.file_size );
+
+        for ( std::size_t position = 0; position + sizeof( elf_format::note_header_t ) <= size; )
+        {
+            elf_format::note_header_t note;
+            std::memcpy( &note, data + position, sizeof( note ) );
+
+            const auto name = position + sizeof( note );
+            const auto descriptor = name + note_align( note.name_size );
+            const auto next = descriptor + note_align( note.descriptor_size );
+
+            if ( descriptor > size || next > size || next <= position )
+                break;
+
+            if ( note.type == elf_format::file_note )
+                read_file_note( data + descriptor, note.descriptor_size );
+
+            position = next;
+        }
+    }
+
+    void elf_core_source::read_file_note( const std::uint8_t* data, std::size_t size )
+    {
+        // The note holds a count and a page size, then (start, end, file offset) for every mapping, then the
+        // NUL-terminated path of every mapping in the same order.
+        if ( size < sizeof( std::uint64_t ) * 2 )
+            return;
+
+        std::uint64_t count;
+        std::memcpy( &count, data, sizeof( count ) );
+
+        const auto entries = sizeof( std::uint64_t ) * 2;
+
+        if ( count > ( size - entries ) / ( sizeof( std::uint64_t ) * 3 ) )
+            return;
+
+        auto name = reinterpret_cast< const char* >( data + entries + count * sizeof( std::uint64_t ) * 3 );
+        const auto names_end = reinterpret_cast< const char* >( data + size );
+
+        for ( std::uint64_t i = 0; i < count && name < names_end; ++i )
+        {
+            std::uint64_t mapping[ 3 ];
+            std::memcpy( mapping, data + entries + i * sizeof( mapping ), sizeof( mapping ) );
+
+            const auto length = std::find( name, names_end, '\0' ) - name;
+            std::string path( name, length );
+            name += length + 1;
+
+            if ( const auto separator = path.find_last_of( '/' ); separator != std::string::npos )
+                path.erase( 0, separator + 1 );
+
+            const auto start = static_cast< std::uintptr_t >( mapping[ 0 ] );
+            const auto end = static_cast< std::uintptr_t >( mapping[ 1 ] );
+
+            // A file is usually mapped several times (one mapping per segment), so grow its module to cover them all.
+            const auto module = std::find_if( modules.begin(), modules.end(), [ &path ]( const module_info_t& info ) {
+                return info.name == path;
+            } );
+
+            if ( module == modules.end() )
+            {
+                modules.push_back( { path, start, end - start } );
+                continue;
+            }
+
+            const auto module_end = std::max( module->base + module->size, end );
+            module->base = std::min( module->base, start );
+            module->size = module_end - module->base;
+        }
+    }
+}  // namespace extlib
@@ -0,0 +1,28 @@
+#include "file_format.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace extlib::detail
+{
+    void throw_corrupt( const std::string& origin, const char* format, const char* reason )
+    {
+        std::stringstream msg;
+        msg << origin << " is not a valid " << format << ": " << reason;
+        throw std::runtime_error( msg.str() );
+    }
+
+    void throw_corrupt( const std::filesystem::path& path, const char* format, const char* reason )
+    {
+        throw_corrupt( "'" + path.string() + "'", format, reason );
+    }
+
+    void write_at( std::ostream& stream, std::uint64_t offset, const void* data, std::size_t size )
+    {
+        static constexpr char zeros[ 8 ]{};
+
+        const auto position = static_cast< std::uint64_t >( stream.tellp() );
+        stream.write( zeros, static_cast< std::streamsize >( offset - position ) );
+        stream.write( static_cast< const char* >( data ), static_cast< std::streamsize >( size ) );
+    }
+}  // namespace extlib::detail
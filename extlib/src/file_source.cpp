@@ -0,0 +1,109 @@
+#include "file_source.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace extlib
+{
+    file_source::file_source( const std::filesystem::path& path )
+        : file( std::make_unique< win::mapped_file >( path ) )
+    {
+    }
+
+    std::vector< win::region_t > file_source::get_regions( std::uintptr_t start, std::uintptr_t end ) const
+    {
+        const auto first = std::partition_point( regions.begin(), regions.end(), [ start ]( const win::region_t& region ) {
+            return region.end <= start;
+        } );
+
+        const auto last = std::partition_point( first, regions.end(), [ end ]( const win::region_t& region ) {
+            return region.start <= end;
+        } );
+
+        return { first, last };
+    }
+
+    std::vector< module_info_t > file_source::get_modules() const
+    {
+        return modules;
+    }
+
+    std::size_t file_source::read( std::uintptr_t address, void* buffer, std::size_t size ) const
+    {
+        const auto output = static_cast< std::uint8_t* >( buffer );
+        std::size_t done = 0;
+
+        // Ranges are often captured back to back, so keep going into the next one.
+        while ( done < size )
+        {
+            const auto range = find_range( address + done );
+
+            if ( !range )
+                break;
+
+            const auto offset = address + done - range->address;
+            const auto length = std::min( range->size - offset, size - done );
+
+            std::memcpy( output + done, file->data() + range->offset + offset, length );
+            done += length;
+        }
+
+        return done;
+    }
+
+    const std::uint8_t* file_source::view( std::uintptr_t address, std::size_t size ) const
+    {
+        const auto range = find_range( address );
+
+        if ( !size || !range || address - range->address + size > range->size )
+            return nullptr;
+
+        return file->data() + range->offset + ( address - range->address );
+    }
+
+    void file_source::add_range( std::uintptr_t address, std::size_t size, std::uint64_t offset )
+    {
+        if ( !size )
+            return;
+
+        if ( !at( offset, size ) )
+            throw std::runtime_error( "A captured memory range lies outside the file" );
+
+        ranges.push_back( { address, size, offset } );
+    }
+
+    void file_source::sort()
+    {
+        std::sort( regions.begin(), regions.end(), []( const win::region_t& lhs, const win::region_t& rhs ) {
+            return lhs.start < rhs.start;
+        } );
+
+        std::sort( ranges.begin(), ranges.end(), []( const range_t& lhs, const range_t& rhs ) {
+            return lhs.address < rhs.address;
+        } );
+    }
+
+    const std::uint8_t* file_source::at( std::uint64_t offset, std::size_t size ) const
+    {
+        if ( offset > file->size() || size > file->size() - offset )
+            return nullptr;
+
+        return file->data() + offset;
+    }
+
+    const file_source::range_t* file_source::find_range( std::uintptr_t address ) const
+    {
+        const auto it = std::upper_bound(
+            ranges.begin(), ranges.end(), address, []( std::uintptr_t value, const range_t& range ) {
+                return value < range.address;
+            } );
+
+        if ( it == ranges.begin() )
+            return nullptr;
+
+        const auto& range = *( it - 1 );
+
+        return address - range.address < range.size ? &range : nullptr;
+    }
+}  // namespace extlib
@@ -0,0 +1,111 @@
+#include "hash.hpp"
+
+#include <cstring>
+
+namespace extlib
+{
+    namespace
+    {
+        constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ull;
+        constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr std::uint64_t prime3 = 0x165667B19E3779F9ull;
+        constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+        constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ull;
+
+        inline std::uint64_t rotl( std::uint64_t value, int bits )
+        {
+            return ( value << bits ) | ( value >> ( 64 - bits ) );
+        }
+
+        inline std::uint64_t read64( const std::uint8_t* data )
+        {
+            std::uint64_t value;
+            std::memcpy( &value, data, sizeof( value ) );
+
+            return value;
+        }
+
+        inline std::uint32_t read32( const std::uint8_t* data )
+        {
+            std::uint32_t value;
+            std::memcpy( &value, data, sizeof( value ) );
+
+            return value;
+        }
+
+        inline std::uint64_t round( std::uint64_t accumulator, std::uint64_t input )
+        {
+            accumulator += input * prime2;
+            accumulator = rotl( accumulator, 31 );
+
+            return accumulator * prime1;
+        }
+
+        inline std::uint64_t merge_round( std::uint64_t accumulator, std::uint64_t value )
+        {
+            accumulator ^= round( 0, value );
+
+            return accumulator * prime1 + prime4;
+        }
+    }  // namespace
+
+    std::uint64_t xxh64( const void* data, std::size_t size, std::uint64_t seed )
+    {
+        auto input = static_cast< const std::uint8_t* >( data );
+        const auto end = input + size;
+
+        std::uint64_t hash;
+
+        if ( size >= 32 )
+        {
+            // Four independent lanes keep the multiplier pipelines busy.
+            std::uint64_t v1 = seed + prime1 + prime2;
+            std::uint64_t v2 = seed + prime2;
+            std::uint64_t v3 = seed;
+            std::uint64_t v4 = seed - prime1;
+
+            const auto limit = end - 32;
+
+            do
+            {
+                v1 = round( v1, read64( input ) );
+                v2 = round( v2, read64( input + 8 ) );
+                v3 = round( v3, read64( input + 16 ) );
+                v4 = round( v4, read64( input + 24 ) );
+
+                input += 32;
+            } while ( input <= limit );
+
+            hash = rotl( v1, 1 ) + rotl( v2, 7 ) + rotl( v3, 12 ) + rotl( v4, 18 );
+
+            hash = merge_round( hash, v1 );
+            hash = merge_round( hash, v2 );
+            hash = merge_round( hash, v3 );
+            hash = merge_round( hash, v4 );
+        }
+        else
+            hash = seed + prime5;
+
+        hash += static_cast< std::uint64_t >( size );
+
+        for ( ; input + 8 <= end; input += 8 )
+            hash = rotl( hash ^ round( 0, read64( input ) ), 27 ) * prime1 + prime4;
+
+        if ( input + 4 <= end )
+        {
+            hash = rotl( hash ^ ( static_cast< std::uint64_t >( read32( input ) ) * prime1 ), 23 ) * prime2 + prime3;
+            input += 4;
+        }
+
+        for ( ; input < end; ++input )
+            hash = rotl( hash ^ ( *input * prime5 ), 11 ) * prime1;
+
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+}  // namespace extlib
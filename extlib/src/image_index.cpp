@@ -0,0 +1,470 @@
+#include "image_index.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "file_format.hpp"
+
+namespace extlib
+{
+    namespace
+    {
+        /// <summary>
+        /// Sorts the suffixes of `text`, whose symbols are all at most `upper`, by induced sorting (SA-IS) in linear
+        /// time. The LMS substrings are sorted by induction, named, and the names sorted recursively when they are not
+        /// already unique.
+        /// </summary>
+        template< typename symbol_t >
+        std::vector< std::int32_t > sort_suffixes( const symbol_t* text, std::int32_t n, std::int32_t upper )
+        {
+            if ( n == 0 )
+                return {};
+
+            if ( n == 1 )
+                return { 0 };
+
+            if ( n == 2 )
+                return text[ 0 ] < text[ 1 ] ? std::vector< std::int32_t >{ 0, 1 } : std::vector< std::int32_t >{ 1, 0 };
+
+            std::vector< std::int32_t > sa( n );
+
+            // A suffix is S-type if it is smaller than the one following it, and L-type otherwise.
+            std::vector< bool > is_s( n );
+
+            for ( auto i = n - 2; i >= 0; --i )
+                is_s[ i ] = text[ i ] == text[ i + 1 ] ? is_s[ i + 1 ] : text[ i ] < text[ i + 1 ];
+
+            // Where the S and L-type suffixes of each symbol start in the array.
+            std::vector< std::int32_t > start_l( upper + 1 ), start_s( upper + 1 );
+
+            for ( std::int32_t i = 0; i < n; ++i )
+            {
+                if ( !is_s[ i ] )
+                    ++start_s[ text[ i ] ];
+                else
+                    ++start_l[ text[ i ] + 1 ];
+            }
+
+            for ( std::int32_t i = 0; i <= upper; ++i )
+            {
+                start_s[ i ] += start_l[ i ];
+
+                if ( i < upper )
+                    start_l[ i + 1 ] += start_s[ i ];
+            }
+
+            const auto induce = [ & ]( const std::vector< std::int32_t >& lms ) {
+                std::fill( sa.begin(), sa.end(), -1 );
+
+                std::vector< std::int32_t > next( upper + 1 );
+
+                std::copy( start_s.begin(), start_s.end(), next.begin() );
+
+                for ( const auto position : lms )
+                {
+                    if ( position != n )
+                        sa[ next[ text[ position ] ]++ ] = position;
+                }
+
+                std::copy( start_l.begin(), start_l.end(), next.begin() );
+                sa[ next[ text[ n - 1 ] ]++ ] = n - 1;
+
+                for ( std::int32_t i = 0; i < n; ++i )
+                {
+                    const auto position = sa[ i ];
+
+                    if ( position >= 1 && !is_s[ position - 1 ] )
+                        sa[ next[ text[ position - 1 ] ]++ ] = position - 1;
+                }
+
+                std::copy( start_l.begin(), start_l.end(), next.begin() );
+
+                for ( auto i = n - 1; i >= 0; --i )
+                {
+                    const auto position = sa[ i ];
+
+                    if ( position >= 1 && is_s[ position - 1 ] )
+                        sa[ --next[ text[ position - 1 ] + 1 ] ] = position - 1;
+                }
+            };
+
+            // The leftmost S-type suffixes (those following an L-type one), and their order by position.
+            std::vector< std::int32_t > lms_index( n + 1, -1 ), lms;
+
+            for ( std::int32_t i = 1; i < n; ++i )
+            {
+                if ( !is_s[ i - 1 ] && is_s[ i ] )
+                {
+                    lms_index[ i ] = static_cast< std::int32_t >( lms.size() );
+                    lms.push_back( i );
+                }
+            }
+
+            induce( lms );
+
+            const auto m = static_cast< std::int32_t >( lms.size() );
+
+            if ( !m )
+                return sa;
+
+            std::vector< std::int32_t > sorted_lms;
+            sorted_lms.reserve( m );
+
+            for ( const auto position : sa )
+            {
+                if ( lms_index[ position ] != -1 )
+                    sorted_lms.push_back( position );
+            }
+
+            // Name every LMS substring by its rank, with equal substrings sharing a name.
+            std::vector< std::int32_t > names( m );
+            std::int32_t name = 0;
+
+            names[ lms_index[ sorted_lms[ 0 ] ] ] = 0;
+
+            for ( std::int32_t i = 1; i < m; ++i )
+            {
+                auto left = sorted_lms[ i - 1 ];
+                auto right = sorted_lms[ i ];
+
+                const auto left_end = lms_index[ left ] + 1 < m ? lms[ lms_index[ left ] + 1 ] : n;
+                const auto right_end = lms_index[ right ] + 1 < m ? lms[ lms_index[ right ] + 1 ] : n;
+
+                auto same = left_end - left == right_end - right;
+
+                if ( same )
+                {
+                    while ( left < left_end && text[ left ] == text[ right ] )
+                    {
+                        ++left;
+                        ++right;
+                    }
+
+                    if ( left == n || text[ left ] != text[ right ] )
+                        same = false;
+                }
+
+                if ( !same )
+                    ++name;
+
+                names[ lms_index[ sorted_lms[ i ] ] ] = name;
+            }
+
+            // Distinct names mean the LMS substrings already order their suffixes, as they were sorted above.
+            if ( name + 1 < m )
+            {
+                const auto sorted_names = sort_suffixes( names.data(), m, name );
+
+                for ( std::int32_t i = 0; i < m; ++i )
+                    sorted_lms[ i ] = lms[ sorted_names[ i ] ];
+            }
+
+            induce( sorted_lms );
+
+            return sa;
+        }
+
+        [[noreturn]] void corrupt( const std::filesystem::path& path, const char* reason )
+        {
+            detail::throw_corrupt( path, "image index", reason );
+        }
+    }  // namespace
+
+    image_index image_index::build( const win::module_t& module )
+    {
+        return build( module.start, module.read_image() );
+    }
+
+    image_index image_index::build( std::uintptr_t base, std::vector< std::uint8_t > bytes )
+    {
+        if ( bytes.size() >= static_cast< std::size_t >( std::numeric_limits< std::int32_t >::max() ) )
+            throw std::length_error( "Images of 2 GiB or more cannot be indexed" );
+
+        image_index index;
+
+        index.base = base;
+        index.length = bytes.size();
+        index.owned_text = std::move( bytes );
+
+        const auto sorted =
+            sort_suffixes( index.owned_text.data(), static_cast< std::int32_t >( index.length ), 0xFF );
+
+        index.owned_suffixes.assign( sorted.begin(), sorted.end() );
+
+        // Count the suffixes under each 2-byte prefix, then turn the counts into starting positions.
+        index.owned_buckets.assign( image_index_format::bucket_count, 0 );
+
+        for ( std::size_t i = 0; i < index.length; ++i )
+        {
+            const auto prefix = index.owned_text[ i ] << 8 | ( i + 1 < index.length ? index.owned_text[ i + 1 ] : 0 );
+            ++index.owned_buckets[ prefix + 1 ];
+        }
+
+        for ( std::size_t i = 1; i < index.owned_buckets.size(); ++i )
+            index.owned_buckets[ i ] += index.owned_buckets[ i - 1 ];
+
+        index.adopt();
+
+        return index;
+    }
+
+    image_index image_index::load( const std::filesystem::path& path )
+    {
+        using namespace image_index_format;
+
+        image_index index;
+        index.file = std::make_unique< win::mapped_file >( path );
+
+        const auto data = index.file->data();
+        const auto size = index.file->size();
+
+        if ( size < sizeof( header_t ) )
+            corrupt( path, "the file is too small" );
+
+        header_t header;
+        std::memcpy( &header, data, sizeof( header ) );
+
+        if ( header.magic != magic )
+            corrupt( path, "the magic does not match" );
+
+        if ( header.version != version )
+            corrupt( path, "the version is not supported" );
+
+        if ( header.size >= static_cast< std::uint64_t >( std::numeric_limits< std::int32_t >::max() ) ||
+             !detail::table_fits( header.text_offset, header.size, 1, size ) ||
+             !detail::table_fits( header.suffix_offset, header.size, sizeof( std::uint32_t ), size ) ||
+             !detail::table_fits( header.bucket_offset, bucket_count, sizeof( std::uint32_t ), size ) )
+            corrupt( path, "a table lies outside the file" );
+
+        index.base = static_cast< std::uintptr_t >( header.base );
+        index.length = static_cast< std::size_t >( header.size );
+
+        index.text = data + header.text_offset;
+        index.suffixes = detail::table_at< std::uint32_t >( data, header.suffix_offset );
+        index.buckets = detail::table_at< std::uint32_t >( data, header.bucket_offset );
+
+        // Queries index the text through both tables, so they must not point past it.
+        if ( index.buckets[ bucket_count - 1 ] != index.length ||
+             !std::is_sorted( index.buckets, index.buckets + bucket_count ) ||
+             std::any_of( index.suffixes, index.suffixes + index.length, [ &index ]( std::uint32_t suffix ) {
+                 return suffix >= index.length;
+             } ) )
+            corrupt( path, "the suffix array does not match the text" );
+
+        return index;
+    }
+
+    void image_index::save( const std::filesystem::path& path ) const
+    {
+        using namespace image_index_format;
+
+        header_t header{};
+
+        header.magic = magic;
+        header.version = version;
+        header.base = base;
+        header.size = length;
+        header.text_offset = detail::align8( sizeof( header ) );
+        header.suffix_offset = detail::align8( header.text_offset + length );
+        header.bucket_offset = detail::align8( header.suffix_offset + length * sizeof( std::uint32_t ) );
+
+        std::ofstream stream( path, std::ios::binary | std::ios::trunc );
+
+        if ( !stream )
+        {
+            std::stringstream msg;
+            msg << "Failed to create image index '" << path.string() << "'";
+            throw std::runtime_error( msg.str() );
+        }
+
+        detail::write_at( stream, 0, &header, sizeof( header ) );
+        detail::write_at( stream, header.text_offset, text, length );
+        detail::write_at( stream, header.suffix_offset, suffixes, length * sizeof( std::uint32_t ) );
+        detail::write_at( stream, header.bucket_offset, buckets, bucket_count * sizeof( std::uint32_t ) );
+
+        stream.flush();
+
+        if ( !stream )
+            throw std::runtime_error( "Failed to write image index" );
+    }
+
+    std::size_t image_index::count( const pattern_t& pattern ) const
+    {
+        const auto& bytes = pattern.bytes;
+
+        if ( bytes.empty() || bytes.size() > length )
+            return 0;
+
+        // Without wildcards, the size of the matching range is the count.
+        if ( std::none_of( bytes.begin(), bytes.end(), []( const auto& byte ) { return byte.second; } ) )
+        {
+            std::vector< std::uint8_t > exact( bytes.size() );
+
+            for ( std::size_t i = 0; i < bytes.size(); ++i )
+                exact[ i ] = bytes[ i ].first;
+
+            const auto [ first, last ] = locate( exact.data(), exact.size() );
+
+            return last - first;
+        }
+
+        return match( pattern ).size();
+    }
+
+    std::vector< std::uintptr_t > image_index::find_all( const pattern_t& pattern ) const
+    {
+        auto offsets = match( pattern );
+
+        std::sort( offsets.begin(), offsets.end() );
+
+        std::vector< std::uintptr_t > addresses;
+        addresses.reserve( offsets.size() );
+
+        for ( const auto offset : offsets )
+            addresses.push_back( base + offset );
+
+        return addresses;
+    }
+
+    std::uintptr_t image_index::get_base() const
+    {
+        return base;
+    }
+
+    std::size_t image_index::size() const
+    {
+        return length;
+    }
+
+    void image_index::adopt()
+    {
+        text = owned_text.data();
+        suffixes = owned_suffixes.data();
+        buckets = owned_buckets.data();
+    }
+
+    std::pair< std::size_t, std::size_t > image_index::locate( const std::uint8_t* bytes, std::size_t size ) const
+    {
+        std::size_t first = 0, last = length;
+
+        // The bucket table narrows the search to the suffixes sharing the pattern's first two bytes (or first byte).
+        if ( size >= 2 )
+        {
+            const auto prefix = bytes[ 0 ] << 8 | bytes[ 1 ];
+
+            first = buckets[ prefix ];
+            last = buckets[ prefix + 1 ];
+        }
+        else if ( size == 1 )
+        {
+            first = buckets[ bytes[ 0 ] << 8 ];
+            last = buckets[ ( bytes[ 0 ] + 1 ) << 8 ];
+        }
+
+        // Compares a suffix with the pattern, with a suffix shorter than the pattern sorting before it.
+        const auto compare = [ this, bytes, size ]( std::uint32_t suffix ) {
+            const auto available = std::min< std::size_t >( size, length - suffix );
+            const auto result = std::memcmp( text + suffix, bytes, available );
+
+            if ( result || available == size )
+                return result;
+
+            return -1;
+        };
+
+        const auto begin = suffixes + first;
+        const auto end = suffixes + last;
+
+        const auto lower = std::partition_point( begin, end, [ & ]( std::uint32_t suffix ) {
+            return compare( suffix ) < 0;
+        } );
+
+        const auto upper = std::partition_point( lower, end, [ & ]( std::uint32_t suffix ) {
+            return compare( suffix ) == 0;
+        } );
+
+        return { static_cast< std::size_t >( lower - suffixes ), static_cast< std::size_t >( upper - suffixes ) };
+    }
+
+    std::vector< std::uint32_t > image_index::match( const pattern_t& pattern ) const
+    {
+        const auto& bytes = pattern.bytes;
+
+        std::vector< std::uint32_t > offsets;
+
+        if ( bytes.empty() || bytes.size() > length )
+            return offsets;
+
+        // Find the longest run of concrete bytes; every match contains it at the same offset.
+        std::size_t run_start = 0, run_length = 0;
+
+        for ( std::size_t i = 0; i < bytes.size(); )
+        {
+            if ( bytes[ i ].second )
+            {
+                ++i;
+                continue;
+            }
+
+            auto j = i;
+
+            while ( j < bytes.size() && !bytes[ j ].second )
+                ++j;
+
+            if ( j - i > run_length )
+            {
+                run_start = i;
+                run_length = j - i;
+            }
+
+            i = j;
+        }
+
+        const auto last_start = length - bytes.size();
+
+        if ( !run_length )
+        {
+            for ( std::size_t i = 0; i <= last_start; ++i )
+                offsets.push_back( static_cast< std::uint32_t >( i ) );
+
+            return offsets;
+        }
+
+        std::vector< std::uint8_t > run( run_length );
+
+        for ( std::size_t i = 0; i < run_length; ++i )
+            run[ i ] = bytes[ run_start + i ].first;
+
+        const auto [ first, last ] = locate( run.data(), run.size() );
+
+        for ( auto i = first; i < last; ++i )
+        {
+            const auto suffix = suffixes[ i ];
+
+            if ( suffix < run_start || suffix - run_start > last_start )
+                continue;
+
+            const auto start = suffix - run_start;
+
+            bool located = true;
+
+            for ( std::size_t j = 0; j < bytes.size(); ++j )
+            {
+                if ( !bytes[ j ].second && text[ start + j ] != bytes[ j ].first )
+                {
+                    located = false;
+                    break;
+                }
+            }
+
+            if ( located )
+                offsets.push_back( static_cast< std::uint32_t >( start ) );
+        }
+
+        return offsets;
+    }
+}  // namespace extlib
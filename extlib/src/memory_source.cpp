@@ -0,0 +1,166 @@
+#include "memory_source.hpp"
+
+#include <Psapi.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace extlib
+{
+    const std::uint8_t* memory_source::view( std::uintptr_t /* address */, std::size_t /* size */ ) const
+    {
+        return nullptr;
+    }
+
+    void memory_source::read_exact( std::uintptr_t address, void* buffer, std::size_t size ) const
+    {
+        if ( read( address, buffer, size ) != size )
+        {
+            std::stringstream msg;
+            msg << "Failed to read " << size << " bytes at 0x" << std::hex << address;
+
+            throw std::runtime_error( msg.str() );
+        }
+    }
+
+    process_source::process_source( HANDLE handle ) : handle( handle )
+    {
+    }
+
+    std::vector< win::region_t > process_source::get_regions( std::uintptr_t start, std::uintptr_t end ) const
+    {
+        std::vector< win::region_t > regions;
+
+        MEMORY_BASIC_INFORMATION info;
+
+        for ( auto address = start;
+              address <= end && VirtualQueryEx( handle, reinterpret_cast< LPCVOID >( address ), &info, sizeof( info ) ); )
+        {
+            if ( !info.RegionSize )
+                break;
+
+            const auto base_address = reinterpret_cast< std::uintptr_t >( info.BaseAddress );
+            const auto region_end = base_address + info.RegionSize;
+
+            regions.push_back( {
+                base_address,
+                region_end,
+                info.RegionSize,
+                info.Protect,
+                static_cast< win::region_state_t >( info.State ),
+                static_cast< win::region_type_t >( info.Type ) } );
+
+            address = region_end;
+        }
+
+        return regions;
+    }
+
+    std::vector< module_info_t > process_source::get_modules() const
+    {
+        std::vector< module_info_t > modules;
+        std::vector< HMODULE > handles( 256 );
+
+        // The module count is only known after asking, so grow the buffer until everything fits.
+        for ( ;; )
+        {
+            DWORD needed;
+
+            const auto capacity = static_cast< DWORD >( handles.size() * sizeof( HMODULE ) );
+
+            if ( !EnumProcessModulesEx( handle, handles.data(), capacity, &needed, LIST_MODULES_ALL ) )
+                return modules;
+
+            if ( needed <= handles.size() * sizeof( HMODULE ) )
+            {
+                handles.resize( needed / sizeof( HMODULE ) );
+                break;
+            }
+
+            handles.resize( needed / sizeof( HMODULE ) );
+        }
+
+        for ( const auto module : handles )
+        {
+            MODULEINFO info;
+            char name[ MAX_PATH ];
+
+            if ( !GetModuleInformation( handle, module, &info, sizeof( info ) ) ||
+                 !GetModuleBaseNameA( handle, module, name, MAX_PATH ) )
+                continue;
+
+            modules.push_back( { name, reinterpret_cast< std::uintptr_t >( info.lpBaseOfDll ), info.SizeOfImage } );
+        }
+
+        return modules;
+    }
+
+    std::size_t process_source::read( std::uintptr_t address, void* buffer, std::size_t size ) const
+    {
+        SIZE_T bytes_read = 0;
+
+        // A read running into an unreadable page fails with ERROR_PARTIAL_COPY, but still reports what it read.
+        if ( !ReadProcessMemory( handle, reinterpret_cast< LPCVOID >( address ), buffer, size, &bytes_read ) &&
+             GetLastError() != ERROR_PARTIAL_COPY )
+            return 0;
+
+        return bytes_read;
+    }
+
+    buffer_source::buffer_source( std::vector< std::uint8_t > bytes, std::uintptr_t base, std::string name )
+        : bytes( std::move( bytes ) ),
+          base( base ),
+          name( std::move( name ) )
+    {
+    }
+
+    std::vector< win::region_t > buffer_source::get_regions( std::uintptr_t start, std::uintptr_t end ) const
+    {
+        if ( bytes.empty() || end < base || start >= base + bytes.size() )
+            return {};
+
+        return { {
+            base,
+            base + bytes.size(),
+            bytes.size(),
+            PAGE_EXECUTE_READWRITE,
+            win::region_state_t::commit_t,
+            win::region_type_t::image_t } };
+    }
+
+    std::vector< module_info_t > buffer_source::get_modules() const
+    {
+        return { { name, base, bytes.size() } };
+    }
+
+    std::size_t buffer_source::read( std::uintptr_t address, void* buffer, std::size_t size ) const
+    {
+        if ( address < base || address - base >= bytes.size() )
+            return 0;
+
+        const auto length = std::min( size, bytes.size() - ( address - base ) );
+        std::memcpy( buffer, bytes.data() + ( address - base ), length );
+
+        return length;
+    }
+
+    const std::uint8_t* buffer_source::view( std::uintptr_t address, std::size_t size ) const
+    {
+        if ( !size || address < base || address - base >= bytes.size() || bytes.size() - ( address - base ) < size )
+            return nullptr;
+
+        return bytes.data() + ( address - base );
+    }
+
+    std::uintptr_t buffer_source::get_base() const
+    {
+        return base;
+    }
+
+    std::size_t buffer_source::get_size() const
+    {
+        return bytes.size();
+    }
+}  // namespace extlib
@@ -0,0 +1,211 @@
+#include "minidump.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace extlib
+{
+    namespace
+    {
+        /// <summary>
+        /// Converts a UTF-16 string into UTF-8.
+        /// </summary>
+        std::string to_utf8( const std::uint8_t* data, std::size_t length )
+        {
+            std::string result;
+            result.reserve( length / 2 );
+
+            const auto unit = [ data ]( std::size_t index ) -> std::uint32_t {
+                return data[ index * 2 ] | data[ index * 2 + 1 ] << 8;
+            };
+
+            const auto count = length / 2;
+
+            for ( std::size_t i = 0; i < count; ++i )
+            {
+                auto code_point = unit( i );
+
+                if ( code_point >= 0xD800 && code_point < 0xDC00 && i + 1 < count )
+                {
+                    const auto low = unit( i + 1 );
+
+                    if ( low >= 0xDC00 && low < 0xE000 )
+                    {
+                        code_point = 0x10000 + ( ( code_point - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+                        ++i;
+                    }
+                }
+
+                if ( code_point < 0x80 )
+                    result.push_back( static_cast< char >( code_point ) );
+                else if ( code_point < 0x800 )
+                {
+                    result.push_back( static_cast< char >( 0xC0 | code_point >> 6 ) );
+                    result.push_back( static_cast< char >( 0x80 | ( code_point & 0x3F ) ) );
+                }
+                else if ( code_point < 0x10000 )
+                {
+                    result.push_back( static_cast< char >( 0xE0 | code_point >> 12 ) );
+                    result.push_back( static_cast< char >( 0x80 | ( code_point >> 6 & 0x3F ) ) );
+                    result.push_back( static_cast< char >( 0x80 | ( code_point & 0x3F ) ) );
+                }
+                else
+                {
+                    result.push_back( static_cast< char >( 0xF0 | code_point >> 18 ) );
+                    result.push_back( static_cast< char >( 0x80 | ( code_point >> 12 & 0x3F ) ) );
+                    result.push_back( static_cast< char >( 0x80 | ( code_point >> 6 & 0x3F ) ) );
+                    result.push_back( static_cast< char >( 0x80 | ( code_point & 0x3F ) ) );
+                }
+            }
+
+            return result;
+        }
+    }  // namespace
+
+    minidump_source::minidump_source( const std::filesystem::path& path ) : file_source( path )
+    {
+        using namespace minidump_format;
+
+        const auto header = load< header_t >( 0 );
+
+        if ( header.signature != signature )
+        {
+            std::stringstream msg;
+            msg << "'" << path.string() << "' is not a minidump";
+            throw std::runtime_error( msg.str() );
+        }
+
+        location_t module_list{}, memory_list{}, memory64_list{}, memory_info_list{};
+
+        for ( std::size_t i = 0; i < header.stream_count; ++i )
+        {
+            const auto directory = load< directory_t >( header.stream_directory + i * sizeof( directory_t ) );
+
+            switch ( directory.type )
+            {
+                case module_list_stream: module_list = directory.location; break;
+                case memory_list_stream: memory_list = directory.location; break;
+                case memory64_list_stream: memory64_list = directory.location; break;
+                case memory_info_list_stream: memory_info_list = directory.location; break;
+                default: break;
+            }
+        }
+
+        if ( module_list.size )
+            read_modules( module_list );
+
+        if ( memory_list.size )
+            read_memory( memory_list );
+
+        if ( memory64_list.size )
+            read_memory64( memory64_list );
+
+        if ( memory_info_list.size )
+            read_memory_info( memory_info_list );
+        else
+        {
+            // Without a memory info list all that is known is what was captured, so every range becomes a readable
+            // region, typed after whether a module covers it.
+            for ( const auto& range : ranges )
+            {
+                auto type = win::region_type_t::private_t;
+
+                for ( const auto& module : modules )
+                {
+                    if ( range.address >= module.base && range.address - module.base < module.size )
+                        type = win::region_type_t::image_t;
+                }
+
+                regions.push_back( {
+                    range.address,
+                    range.address + range.size,
+                    range.size,
+                    PAGE_READONLY,
+                    win::region_state_t::commit_t,
+                    type } );
+            }
+        }
+
+        sort();
+    }
+
+    void minidump_source::read_modules( const minidump_format::location_t& location )
+    {
+        const auto count = load< std::uint32_t >( location.offset );
+
+        for ( std::size_t i = 0; i < count; ++i )
+        {
+            const auto module = load< minidump_format::module_t >(
+                location.offset + sizeof( std::uint32_t ) + i * sizeof( minidump_format::module_t ) );
+
+            const auto name_length = load< std::uint32_t >( module.name_offset );
+            const auto name_data = at( module.name_offset + sizeof( std::uint32_t ), name_length );
+
+            if ( !name_data )
+                throw std::runtime_error( "A module name lies outside the file" );
+
+            // Minidumps store full paths, whereas modules are named by their base name everywhere else.
+            auto name = to_utf8( name_data, name_length );
+
+            if ( const auto separator = name.find_last_of( "\\/" ); separator != std::string::npos )
+                name.erase( 0, separator + 1 );
+
+            modules.push_back( { name, static_cast< std::uintptr_t >( module.base ), module.size } );
+        }
+    }
+
+    void minidump_source::read_memory( const minidump_format::location_t& location )
+    {
+        const auto count = load< std::uint32_t >( location.offset );
+
+        for ( std::size_t i = 0; i < count; ++i )
+        {
+            const auto descriptor = load< minidump_format::memory_descriptor_t >(
+                location.offset + sizeof( std::uint32_t ) + i * sizeof( minidump_format::memory_descriptor_t ) );
+
+            add_range( static_cast< std::uintptr_t >( descriptor.start ), descriptor.memory.size, descriptor.memory.offset );
+        }
+    }
+
+    void minidump_source::read_memory64( const minidump_format::location_t& location )
+    {
+        const auto count = load< std::uint64_t >( location.offset );
+        auto offset = load< std::uint64_t >( location.offset + sizeof( std::uint64_t ) );
+
+        // The ranges of a full dump are stored back to back, starting at a single base offset.
+        for ( std::uint64_t i = 0; i < count; ++i )
+        {
+            const auto descriptor = load< minidump_format::memory_descriptor64_t >(
+                location.offset + sizeof( std::uint64_t ) * 2 + i * sizeof( minidump_format::memory_descriptor64_t ) );
+
+            add_range(
+                static_cast< std::uintptr_t >( descriptor.start ), static_cast< std::size_t >( descriptor.size ), offset );
+
+            offset += descriptor.size;
+        }
+    }
+
+    void minidump_source::read_memory_info( const minidump_format::location_t& location )
+    {
+        const auto header_size = load< std::uint32_t >( location.offset );
+        const auto entry_size = load< std::uint32_t >( location.offset + sizeof( std::uint32_t ) );
+        const auto count = load< std::uint64_t >( location.offset + sizeof( std::uint32_t ) * 2 );
+
+        if ( entry_size < sizeof( minidump_format::memory_info_t ) )
+            throw std::runtime_error( "The memory info entries of the minidump are too small" );
+
+        for ( std::uint64_t i = 0; i < count; ++i )
+        {
+            const auto info = load< minidump_format::memory_info_t >( location.offset + header_size + i * entry_size );
+
+            regions.push_back( {
+                static_cast< std::uintptr_t >( info.base ),
+                static_cast< std::uintptr_t >( info.base + info.size ),
+                static_cast< std::size_t >( info.size ),
+                info.protect,
+                static_cast< win::region_state_t >( info.state ),
+                static_cast< win::region_type_t >( info.type ) } );
+        }
+    }
+}  // namespace extlib
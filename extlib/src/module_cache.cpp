@@ -0,0 +1,257 @@
+#include "module_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include "hash.hpp"
+#include "win/ptapi.hpp"
+
+namespace extlib
+{
+    module_fingerprint_t module_fingerprint_t::compute( const win::module_t& module, bool hash_contents )
+    {
+        const auto& nt = module.get_nt_headers();
+
+        module_fingerprint_t fingerprint{};
+
+        // The checksum and image size sit at the same offsets in 32 and 64-bit optional headers.
+        fingerprint.timestamp = nt.FileHeader.TimeDateStamp;
+        fingerprint.checksum = nt.OptionalHeader.CheckSum;
+        fingerprint.image_size = nt.OptionalHeader.SizeOfImage;
+
+        if ( !hash_contents )
+            return fingerprint;
+
+        const auto& relocations = module.get_relocations();
+
+        std::uint64_t hash = 0;
+
+        for ( const auto& section : module.get_sections() )
+        {
+            const auto name = std::string_view( section.name.c_str() );
+
+            if ( name != ".text" && name != ".rdata" )
+                continue;
+
+            auto bytes = module.read( section.start, section.size );
+
+            // A relocated value is its RVA plus wherever the module happens to be loaded, so subtracting the base
+            // leaves the same value in every copy of the image.
+            const auto rva = static_cast< std::uint32_t >( section.start - module.start );
+
+            auto it = std::lower_bound(
+                relocations.begin(), relocations.end(), rva, []( const win::relocation_t& relocation, std::uint32_t value ) {
+                    return relocation.rva < value;
+                } );
+
+            for ( ; it != relocations.end() && it->rva - rva + it->size <= bytes.size(); ++it )
+            {
+                const auto data = bytes.data() + ( it->rva - rva );
+
+                if ( it->size == sizeof( std::uint64_t ) )
+                {
+                    std::uint64_t value;
+                    std::memcpy( &value, data, sizeof( value ) );
+
+                    value -= module.start;
+                    std::memcpy( data, &value, sizeof( value ) );
+                }
+                else
+                {
+                    std::uint32_t value;
+                    std::memcpy( &value, data, sizeof( value ) );
+
+                    value -= static_cast< std::uint32_t >( module.start );
+                    std::memcpy( data, &value, sizeof( value ) );
+                }
+            }
+
+            hash = xxh64( bytes.data(), bytes.size(), hash );
+        }
+
+        fingerprint.content_hash = hash;
+
+        return fingerprint;
+    }
+
+    bool module_fingerprint_t::operator==( const module_fingerprint_t& other ) const
+    {
+        return timestamp == other.timestamp && checksum == other.checksum && image_size == other.image_size &&
+               content_hash == other.content_hash;
+    }
+
+    bool module_fingerprint_t::operator!=( const module_fingerprint_t& other ) const
+    {
+        return !( *this == other );
+    }
+
+    module_fingerprint_t fingerprint_memo::get( const win::module_t& module, bool hash_contents )
+    {
+        // Modules of different processes (or sources) can share a base, so they are told apart by what they belong to.
+        // A process is known by its id and creation time, as the value of a handle is reused once it is closed.
+        std::uint64_t process_id = 0, process_created = 0;
+
+        if ( !module.source )
+        {
+            process_id = GetProcessId( module.handle );
+            process_created = win::ptapi::get_process_creation_time( module.handle );
+        }
+
+        const auto size = static_cast< std::size_t >( module.end - module.start );
+
+        const auto is_module = [ & ]( const known_module_t& known ) {
+            return !known.source.owner_before( module.source ) && !module.source.owner_before( known.source ) &&
+                   known.process_id == process_id && known.process_created == process_created &&
+                   known.base == module.start && known.size == size;
+        };
+
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+
+            const auto known = std::find_if( known_modules.begin(), known_modules.end(), is_module );
+
+            if ( known != known_modules.end() )
+                return known->fingerprint;
+        }
+
+        // Fingerprinting reads the module, so it happens outside of the lock.
+        const auto fingerprint = module_fingerprint_t::compute( module, hash_contents );
+
+        // A process that cannot be queried has nothing stable to be known by.
+        if ( !module.source && !process_created )
+            return fingerprint;
+
+        std::lock_guard< std::mutex > lock( mutex );
+
+        // Entries only pile up as new modules are seen, so that is when the stale ones are dropped.
+        prune();
+
+        known_modules.push_back( { module.source, process_id, process_created, module.start, size, fingerprint } );
+
+        return fingerprint;
+    }
+
+    void fingerprint_memo::clear()
+    {
+        std::lock_guard< std::mutex > lock( mutex );
+
+        known_modules.clear();
+    }
+
+    void fingerprint_memo::prune()
+    {
+        // Each process is checked once, however many of its modules are known.
+        std::vector< std::pair< std::uint64_t, std::uint64_t > > running, exited;
+
+        const auto is_stale = [ & ]( const known_module_t& known ) {
+            if ( !known.process_created )
+                return known.source.expired();
+
+            const std::pair< std::uint64_t, std::uint64_t > process{ known.process_id, known.process_created };
+
+            if ( std::find( running.begin(), running.end(), process ) != running.end() )
+                return false;
+
+            if ( std::find( exited.begin(), exited.end(), process ) != exited.end() )
+                return true;
+
+            const auto is_running = win::ptapi::is_process_running( process.first, process.second );
+            ( is_running ? running : exited ).push_back( process );
+
+            return !is_running;
+        };
+
+        known_modules.erase(
+            std::remove_if( known_modules.begin(), known_modules.end(), is_stale ), known_modules.end() );
+    }
+
+    std::vector< std::uintptr_t > module_cache::get_or_compute(
+        const win::module_t& module,
+        std::string_view key,
+        const std::function< std::vector< std::uintptr_t >( const win::module_t& ) >& compute )
+    {
+        const auto fingerprint = get_fingerprint( module );
+
+        std::shared_future< std::vector< std::uint64_t > > future;
+        std::promise< std::vector< std::uint64_t > > promise;
+
+        bool owner = false;
+
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+
+            auto& entries = results[ fingerprint ];
+            const auto it = entries.find( std::string( key ) );
+
+            if ( it != entries.end() )
+                future = it->second;
+            else
+            {
+                future = promise.get_future().share();
+                entries.emplace( std::string( key ), future );
+                owner = true;
+            }
+        }
+
+        if ( owner )
+        {
+            try
+            {
+                std::vector< std::uint64_t > offsets;
+
+                for ( const auto address : compute( module ) )
+                {
+                    if ( !module.contains( address ) )
+                    {
+                        std::stringstream msg;
+                        msg << "Cached result 0x" << std::hex << address << " lies outside of its module";
+                        throw std::invalid_argument( msg.str() );
+                    }
+
+                    offsets.push_back( address - module.start );
+                }
+
+                promise.set_value( std::move( offsets ) );
+            }
+            catch ( ... )
+            {
+                // Waiters see the failure, and the next call computes the result again.
+                promise.set_exception( std::current_exception() );
+
+                std::lock_guard< std::mutex > lock( mutex );
+                results[ fingerprint ].erase( std::string( key ) );
+            }
+        }
+
+        const auto& offsets = future.get();
+
+        std::vector< std::uintptr_t > addresses;
+        addresses.reserve( offsets.size() );
+
+        for ( const auto offset : offsets )
+            addresses.push_back( module.start + static_cast< std::uintptr_t >( offset ) );
+
+        return addresses;
+    }
+
+    module_fingerprint_t module_cache::get_fingerprint( const win::module_t& module )
+    {
+        return fingerprints.get( module );
+    }
+
+    void module_cache::clear()
+    {
+        std::lock_guard< std::mutex > lock( mutex );
+
+        fingerprints.clear();
+        results.clear();
+    }
+
+    std::size_t module_cache::fingerprint_hash_t::operator()( const module_fingerprint_t& fingerprint ) const
+    {
+        return static_cast< std::size_t >(
+            fingerprint.content_hash ^ ( std::uint64_t{ fingerprint.timestamp } << 32 | fingerprint.checksum ) );
+    }
+}  // namespace extlib
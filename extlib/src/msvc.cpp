@@ -0,0 +1,451 @@
+#include "msvc.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "remote.hpp"
+
+namespace extlib::msvc
+{
+    namespace
+    {
+        /// <summary>
+        /// The start of `std::list`, `std::map` and `std::set`: the sentinel node and the number of elements.
+        /// </summary>
+        struct container_header_t
+        {
+            std::uint64_t head, size;
+        };
+
+        /// <summary>
+        /// The layout of `std::vector`: the first element, the end of the elements and the end of the storage.
+        /// </summary>
+        struct vector_header_t
+        {
+            std::uint64_t first, last, end;
+        };
+
+        /// <summary>
+        /// The layout of `std::unordered_map` and `std::unordered_set`: the hash traits, the list holding every element
+        /// with the elements of a bucket next to each other, and the bucket table holding the first and last node of
+        /// every bucket.
+        /// </summary>
+        struct hash_header_t
+        {
+            std::uint64_t traits;
+            container_header_t list;
+            std::uint64_t buckets_first, buckets_last, buckets_end;
+            std::uint64_t mask, max_index;
+        };
+
+        static_assert( sizeof( hash_header_t ) == 0x40 );
+
+        /// <summary>
+        /// The links of a list node, which are followed by its value.
+        /// </summary>
+        struct list_node_t
+        {
+            std::uint64_t next, previous;
+        };
+
+        /// <summary>
+        /// The links of a tree node, which are followed by its value. The sentinel node has `is_nil` set, and its parent
+        /// is the root; the children of leaves point back to it.
+        /// </summary>
+        struct tree_node_t
+        {
+            std::uint64_t left, parent, right;
+            std::uint8_t color, is_nil;
+        };
+
+        constexpr std::size_t tree_links_size = 0x1A;
+
+        constexpr std::size_t align_up( std::size_t value, std::size_t alignment )
+        {
+            return ( value + alignment - 1 ) / alignment * alignment;
+        }
+
+        [[noreturn]] void fail( const char* container, std::uintptr_t address, const char* reason )
+        {
+            std::stringstream msg;
+            msg << "Failed to read the " << container << " at 0x" << std::hex << address << ": " << reason;
+
+            throw std::runtime_error( msg.str() );
+        }
+
+        /// <summary>
+        /// Reads a batch of equally sized nodes, throwing if any of them cannot be read.
+        /// </summary>
+        /// <param name="nodes">The addresses of the nodes.</param>
+        /// <param name="node_size">The number of bytes to read from every node.</param>
+        /// <param name="destination">Receives the nodes one after another.</param>
+        void read_nodes(
+            const win::module_t& module,
+            const std::vector< std::uintptr_t >& nodes,
+            std::size_t node_size,
+            std::uint8_t* destination,
+            const char* container,
+            std::uintptr_t address )
+        {
+            std::vector< extlib::detail::remote_read_t > reads;
+            std::vector< bool > failed( nodes.size() );
+
+            reads.reserve( nodes.size() );
+
+            for ( std::size_t i = 0; i < nodes.size(); ++i )
+                reads.push_back( { nodes[ i ], node_size, destination + i * node_size, i } );
+
+            extlib::detail::read_scattered( module, reads, failed );
+
+            if ( std::find( failed.begin(), failed.end(), true ) != failed.end() )
+                fail( container, address, "a node could not be read" );
+        }
+
+        /// <summary>
+        /// Reads many strings whose characters are `unit_t`s.
+        /// </summary>
+        template< typename unit_t >
+        std::vector< std::optional< std::basic_string< unit_t > > > read_basic_strings(
+            const win::module_t& module,
+            const std::vector< std::uintptr_t >& addresses,
+            const container_limits_t& limits )
+        {
+            // Strings switch to a heap buffer once they no longer fit into the inline one with their terminator.
+            constexpr auto inline_capacity = sizeof( string_t::buffer ) / sizeof( unit_t ) - 1;
+
+            std::vector< string_t > headers( addresses.size() );
+            std::vector< std::optional< std::basic_string< unit_t > > > strings( addresses.size() );
+            std::vector< extlib::detail::remote_read_t > reads;
+            std::vector< bool > failed( addresses.size() );
+
+            reads.reserve( addresses.size() );
+
+            for ( std::size_t i = 0; i < addresses.size(); ++i )
+            {
+                const auto destination = reinterpret_cast< std::uint8_t* >( &headers[ i ] );
+                reads.push_back( { addresses[ i ], sizeof( string_t ), destination, i } );
+            }
+
+            extlib::detail::read_scattered( module, reads, failed );
+            reads.clear();
+
+            for ( std::size_t i = 0; i < addresses.size(); ++i )
+            {
+                const auto& header = headers[ i ];
+
+                if ( failed[ i ] || header.size > header.capacity || header.size > limits.max_string_length )
+                    continue;
+
+                auto& string = strings[ i ].emplace( static_cast< std::size_t >( header.size ), unit_t{} );
+
+                if ( header.capacity <= inline_capacity )
+                {
+                    std::memcpy( string.data(), header.buffer, string.size() * sizeof( unit_t ) );
+                    continue;
+                }
+
+                std::uint64_t pointer;
+                std::memcpy( &pointer, header.buffer, sizeof( pointer ) );
+
+                if ( !string.empty() )
+                {
+                    reads.push_back( {
+                        static_cast< std::uintptr_t >( pointer ),
+                        string.size() * sizeof( unit_t ),
+                        reinterpret_cast< std::uint8_t* >( string.data() ),
+                        i } );
+                }
+            }
+
+            std::fill( failed.begin(), failed.end(), false );
+            extlib::detail::read_scattered( module, reads, failed );
+
+            for ( std::size_t i = 0; i < addresses.size(); ++i )
+            {
+                if ( failed[ i ] )
+                    strings[ i ].reset();
+            }
+
+            return strings;
+        }
+    }  // namespace
+
+    std::vector< std::uint8_t > detail::read_vector(
+        const win::module_t& module,
+        std::uintptr_t address,
+        std::size_t element_size,
+        const container_limits_t& limits )
+    {
+        const auto header = module.read< vector_header_t >( address );
+        const auto first = header.first, last = header.last;
+
+        if ( last < first || ( last - first ) % element_size )
+            fail( "vector", address, "its bounds are invalid" );
+
+        if ( ( last - first ) / element_size > limits.max_elements )
+            fail( "vector", address, "it has too many elements" );
+
+        if ( first == last )
+            return {};
+
+        return module.read( static_cast< std::uintptr_t >( first ), static_cast< std::size_t >( last - first ) );
+    }
+
+    std::vector< std::uint8_t > detail::read_list(
+        const win::module_t& module,
+        std::uintptr_t address,
+        std::size_t value_size,
+        std::size_t value_alignment,
+        const container_limits_t& limits )
+    {
+        const auto header = module.read< container_header_t >( address );
+
+        if ( header.size > limits.max_elements )
+            fail( "list", address, "it has too many elements" );
+
+        const auto value_offset = align_up( sizeof( list_node_t ), value_alignment );
+
+        std::vector< std::uint8_t > values;
+        values.reserve( static_cast< std::size_t >( header.size ) * value_size );
+
+        // A cycle that does not pass through the sentinel shows up as more nodes than the list claims to have.
+        for ( auto node = module.read< list_node_t >( static_cast< std::uintptr_t >( header.head ) ).next;
+              node != header.head; )
+        {
+            if ( values.size() / value_size == header.size )
+                fail( "list", address, "it has more nodes than elements" );
+
+            const auto bytes = module.read( static_cast< std::uintptr_t >( node ), value_offset + value_size );
+
+            values.insert( values.end(), bytes.begin() + value_offset, bytes.end() );
+            std::memcpy( &node, bytes.data(), sizeof( node ) );
+        }
+
+        return values;
+    }
+
+    std::vector< std::uint8_t > detail::read_tree(
+        const win::module_t& module,
+        std::uintptr_t address,
+        std::size_t value_size,
+        std::size_t value_alignment,
+        const container_limits_t& limits )
+    {
+        const auto header = module.read< container_header_t >( address );
+
+        if ( header.size > limits.max_elements )
+            fail( "tree", address, "it has too many elements" );
+
+        const auto head = static_cast< std::uintptr_t >( header.head );
+        const auto root = static_cast< std::uintptr_t >( module.read< tree_node_t >( head ).parent );
+
+        if ( !header.size || root == head )
+            return {};
+
+        const auto value_offset = align_up( tree_links_size, value_alignment );
+        const auto node_size = value_offset + value_size;
+
+        // Every node read so far, in the order it was found; a node's children are read with the next level.
+        std::vector< std::uintptr_t > addresses{ root };
+        std::unordered_map< std::uintptr_t, std::size_t > indices{ { root, 0 } };
+        std::vector< std::uint8_t > nodes;
+
+        for ( std::size_t level = 0; level < addresses.size(); )
+        {
+            const auto level_end = addresses.size();
+            const std::vector< std::uintptr_t > batch( addresses.begin() + level, addresses.end() );
+
+            nodes.resize( level_end * node_size );
+            read_nodes( module, batch, node_size, nodes.data() + level * node_size, "tree", address );
+
+            for ( auto i = level; i < level_end; ++i )
+            {
+                tree_node_t node;
+                std::memcpy( &node, nodes.data() + i * node_size, sizeof( node ) );
+
+                if ( node.is_nil )
+                    fail( "tree", address, "a node is marked as the sentinel" );
+
+                for ( const auto child : { node.left, node.right } )
+                {
+                    if ( child == head )
+                        continue;
+
+                    if ( !indices.emplace( static_cast< std::uintptr_t >( child ), addresses.size() ).second )
+                        fail( "tree", address, "a node is reachable twice" );
+
+                    if ( addresses.size() == header.size )
+                        fail( "tree", address, "it has more nodes than elements" );
+
+                    addresses.push_back( static_cast< std::uintptr_t >( child ) );
+                }
+            }
+
+            level = level_end;
+        }
+
+        // Every node is in memory now, so the in-order walk needs no more reads.
+        std::vector< std::uint8_t > values;
+        values.reserve( addresses.size() * value_size );
+
+        std::vector< std::size_t > stack;
+        auto current = root;
+
+        while ( current != head || !stack.empty() )
+        {
+            while ( current != head )
+            {
+                const auto index = indices.at( current );
+
+                stack.push_back( index );
+                std::memcpy( &current, nodes.data() + index * node_size + offsetof( tree_node_t, left ), sizeof( current ) );
+            }
+
+            const auto index = stack.back();
+            stack.pop_back();
+
+            const auto node = nodes.data() + index * node_size;
+
+            values.insert( values.end(), node + value_offset, node + node_size );
+            std::memcpy( &current, node + offsetof( tree_node_t, right ), sizeof( current ) );
+        }
+
+        return values;
+    }
+
+    std::vector< std::uint8_t > detail::read_hash(
+        const win::module_t& module,
+        std::uintptr_t address,
+        std::size_t value_size,
+        std::size_t value_alignment,
+        const container_limits_t& limits )
+    {
+        const auto header = module.read< hash_header_t >( address );
+        const auto size = header.list.size;
+
+        if ( size > limits.max_elements )
+            fail( "hash table", address, "it has too many elements" );
+
+        if ( !size )
+            return {};
+
+        const auto head = header.list.head;
+        const auto table_size = header.buckets_last - header.buckets_first;
+
+        // Tables are kept at least as large as the elements need, but reserving can make them far larger.
+        if ( header.buckets_last < header.buckets_first || table_size % ( 2 * sizeof( std::uint64_t ) ) ||
+             table_size / ( 2 * sizeof( std::uint64_t ) ) > std::max< std::size_t >( limits.max_elements, 8 ) * 8 )
+            fail( "hash table", address, "its bucket table is invalid" );
+
+        const auto table = module.read( static_cast< std::uintptr_t >( header.buckets_first ), table_size );
+        const auto first = module.read< list_node_t >( static_cast< std::uintptr_t >( head ) ).next;
+
+        const auto value_offset = align_up( sizeof( list_node_t ), value_alignment );
+        const auto node_size = value_offset + value_size;
+
+        // The nodes still to read of every bucket, as the next node and the bucket's last one.
+        std::vector< std::pair< std::uint64_t, std::uint64_t > > runs;
+
+        for ( std::size_t offset = 0; offset < table.size(); offset += 2 * sizeof( std::uint64_t ) )
+        {
+            std::uint64_t bucket[ 2 ];
+            std::memcpy( bucket, table.data() + offset, sizeof( bucket ) );
+
+            if ( bucket[ 0 ] != head )
+                runs.emplace_back( bucket[ 0 ], bucket[ 1 ] );
+        }
+
+        std::unordered_map< std::uint64_t, std::size_t > indices;
+        std::vector< std::uint8_t > nodes;
+
+        while ( !runs.empty() )
+        {
+            std::vector< std::uintptr_t > batch;
+            batch.reserve( runs.size() );
+
+            for ( const auto& run : runs )
+            {
+                if ( !indices.emplace( run.first, indices.size() ).second )
+                    fail( "hash table", address, "a node is reachable twice" );
+
+                batch.push_back( static_cast< std::uintptr_t >( run.first ) );
+            }
+
+            if ( indices.size() > size )
+                fail( "hash table", address, "it has more nodes than elements" );
+
+            const auto level = nodes.size() / node_size;
+
+            nodes.resize( indices.size() * node_size );
+            read_nodes( module, batch, node_size, nodes.data() + level * node_size, "hash table", address );
+
+            std::vector< std::pair< std::uint64_t, std::uint64_t > > next_runs;
+
+            for ( std::size_t i = 0; i < runs.size(); ++i )
+            {
+                if ( runs[ i ].first == runs[ i ].second )
+                    continue;
+
+                list_node_t node;
+                std::memcpy( &node, nodes.data() + ( level + i ) * node_size, sizeof( node ) );
+
+                if ( node.next == head )
+                    fail( "hash table", address, "a bucket ends past the end of the list" );
+
+                next_runs.emplace_back( node.next, runs[ i ].second );
+            }
+
+            runs = std::move( next_runs );
+        }
+
+        // The buckets are runs of the list, so following the list through the nodes read gives the iteration order.
+        std::vector< std::uint8_t > values;
+        values.reserve( indices.size() * value_size );
+
+        for ( auto node = first; node != head; )
+        {
+            const auto found = indices.find( node );
+
+            if ( found == indices.end() || values.size() / value_size == indices.size() )
+                fail( "hash table", address, "its list does not match its buckets" );
+
+            const auto bytes = nodes.data() + found->second * node_size;
+
+            values.insert( values.end(), bytes + value_offset, bytes + node_size );
+            std::memcpy( &node, bytes, sizeof( node ) );
+        }
+
+        return values;
+    }
+
+    std::string read_string( const win::module_t& module, std::uintptr_t address, const container_limits_t& limits )
+    {
+        auto strings = read_strings( module, { address }, limits );
+
+        if ( !strings.front() )
+            fail( "string", address, "it could not be read or is too long" );
+
+        return std::move( *strings.front() );
+    }
+
+    std::wstring read_wstring( const win::module_t& module, std::uintptr_t address, const container_limits_t& limits )
+    {
+        const auto strings = read_basic_strings< char16_t >( module, { address }, limits );
+
+        if ( !strings.front() )
+            fail( "string", address, "it could not be read or is too long" );
+
+        return std::wstring( strings.front()->begin(), strings.front()->end() );
+    }
+
+    std::vector< std::optional< std::string > > read_strings(
+        const win::module_t& module,
+        const std::vector< std::uintptr_t >& addresses,
+        const container_limits_t& limits )
+    {
+        return read_basic_strings< char >( module, addresses, limits );
+    }
+}  // namespace extlib::msvc
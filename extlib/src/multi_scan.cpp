@@ -0,0 +1,143 @@
+#include "multi_scan.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "thread_pool.hpp"
+#include "win/memapi.hpp"
+
+namespace extlib
+{
+    namespace
+    {
+        /// <summary>
+        /// A piece of one process's memory, scanned as a single task.
+        /// </summary>
+        struct chunk_t
+        {
+            std::size_t process;
+
+            /// <summary>
+            /// The range whose matches this chunk reports.
+            /// </summary>
+            std::uintptr_t start, end;
+
+            /// <summary>
+            /// The end of the region, which bounds how far a match starting in the chunk can reach.
+            /// </summary>
+            std::uintptr_t region_end;
+        };
+
+        bool is_scannable( const win::region_t& region )
+        {
+            return region.state == win::region_state_t::commit_t &&
+                   ( region.type == win::region_type_t::private_t || region.type == win::region_type_t::image_t ) &&
+                   !( region.protect & PAGE_GUARD || region.protect == PAGE_NOACCESS );
+        }
+    }  // namespace
+
+    std::unordered_map< std::uint64_t, std::vector< std::vector< std::uintptr_t > > > multi_scanner::scan(
+        const std::vector< std::unique_ptr< process > >& processes,
+        const pattern_set& patterns,
+        const multi_scan_options_t& options )
+    {
+        auto& pool = thread_pool::shared();
+
+        const auto chunk_size = std::max< std::size_t >( options.chunk_size, 0x1000 );
+        const auto overlap = patterns.max_length() ? patterns.max_length() - 1 : 0;
+
+        // Querying regions is a round trip into every process too, so the processes are mapped out in parallel.
+        std::vector< std::vector< chunk_t > > chunks_by_process( processes.size() );
+
+        pool.parallel_for( processes.size(), [ & ]( std::size_t index ) {
+            const auto& target = *processes[ index ];
+
+            if ( target.is_dead )
+                return;
+
+            const auto& module = target.main_module;
+
+            const auto [ start, end ] = options.scope == multi_scan_scope_t::main_module
+                                            ? std::pair{ module.start, module.end }
+                                            : std::pair{ std::uintptr_t{ 0 }, std::numeric_limits< std::uintptr_t >::max() };
+
+            for ( const auto& region : module.get_regions( start, end ) )
+            {
+                if ( !is_scannable( region ) )
+                    continue;
+
+                const auto region_start = std::max( region.start, start );
+                const auto region_end = std::min( region.end, end );
+
+                for ( auto address = region_start; address < region_end; address += chunk_size )
+                    chunks_by_process[ index ].push_back(
+                        { index, address, std::min( address + chunk_size, region_end ), region_end } );
+            }
+        } );
+
+        std::vector< chunk_t > chunks;
+
+        for ( auto& process_chunks : chunks_by_process )
+            chunks.insert( chunks.end(), process_chunks.begin(), process_chunks.end() );
+
+        std::vector< std::vector< pattern_set::match_t > > found( chunks.size() );
+
+        // The chunks of every process share the queue, so small processes do not leave workers idle behind large ones.
+        pool.parallel_for( chunks.size(), [ & ]( std::size_t index ) {
+            const auto& chunk = chunks[ index ];
+
+            // Every chunk also reads the bytes a match starting at its end can reach into the next one.
+            const auto length = std::min( chunk.end - chunk.start + overlap, chunk.region_end - chunk.start );
+
+            thread_local std::vector< std::uint8_t > buffer;
+            buffer.resize( length );
+
+            try
+            {
+                const auto read = win::memapi::read_process_memory(
+                    *processes[ chunk.process ]->handle, chunk.start, buffer.data(), length );
+
+                patterns.find_matches( buffer.data(), read, found[ index ] );
+            }
+            catch ( const std::exception& )
+            {
+                // The region was freed or protected since it was queried.
+                return;
+            }
+
+            // Matches starting in the overlap belong to the next chunk.
+            const auto owned = chunk.end - chunk.start;
+
+            auto& matches = found[ index ];
+
+            matches.erase( std::remove_if( matches.begin(), matches.end(), [ owned ]( const pattern_set::match_t& match ) {
+                               return match.offset >= owned;
+                           } ),
+                           matches.end() );
+        } );
+
+        std::unordered_map< std::uint64_t, std::vector< std::vector< std::uintptr_t > > > results;
+        std::vector< std::vector< std::vector< std::uintptr_t > >* > results_by_process( processes.size() );
+
+        for ( std::size_t i = 0; i < processes.size(); ++i )
+        {
+            if ( processes[ i ]->is_dead )
+                continue;
+
+            const auto id = GetProcessId( processes[ i ]->handle->handle );
+            results_by_process[ i ] = &results.emplace( id, patterns.get_patterns().size() ).first->second;
+        }
+
+        // Chunks are in address order within each process, so the matches come out sorted.
+        for ( std::size_t i = 0; i < chunks.size(); ++i )
+        {
+            const auto& chunk = chunks[ i ];
+            auto& matches = *results_by_process[ chunk.process ];
+
+            for ( const auto& match : found[ i ] )
+                matches[ match.pattern ].push_back( chunk.start + match.offset );
+        }
+
+        return results;
+    }
+}  // namespace extlib
@@ -101,8 +101,11 @@ namespace extlib
 
             std::cout << "found object_locator: 0x" << std::hex << object_locator_ptr << '\n';
 
-            const auto& object_locator_xrefs =
-                scanner{ { 0, main_module.end, main_module.handle } }.find_all( object_locator_ptr );
+            scanner_options_t xref_options{ main_module };
+            xref_options.start = 0;
+            xref_options.size = xref_options.end;
+
+            const auto& object_locator_xrefs = scanner{ xref_options }.find_all( object_locator_ptr );
 
             std::cout << "found " << object_locator_xrefs.size() << " xrefs to object locator\n" << std::endl;
         }
@@ -0,0 +1,245 @@
+#include "patch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+#include "win/memapi.hpp"
+#include "win/win_exception.hpp"
+
+namespace extlib
+{
+    namespace
+    {
+        constexpr std::uintptr_t page_size = 0x1000;
+
+        /// <summary>
+        /// A range of pages within the target process.
+        /// </summary>
+        struct page_span_t
+        {
+            std::uintptr_t start, end;
+        };
+
+        /// <summary>
+        /// A protection change that has to be undone once the writes are done.
+        /// </summary>
+        struct protection_t
+        {
+            std::uintptr_t address;
+            std::size_t size;
+            std::uint64_t protect;
+        };
+    }  // namespace
+
+    patch_set::patch_set( win::handle_t handle ) : handle( handle ), applied( false )
+    {
+    }
+
+    void patch_set::write( std::uintptr_t address, const void* data, std::size_t length )
+    {
+        if ( !length )
+            return;
+
+        const auto begin = static_cast< const std::uint8_t* >( data );
+
+        writes.push_back( { address, { begin, begin + length } } );
+    }
+
+    void patch_set::write( std::uintptr_t address, const std::vector< std::uint8_t >& bytes )
+    {
+        write( address, bytes.data(), bytes.size() );
+    }
+
+    void patch_set::apply()
+    {
+        if ( applied )
+            throw std::logic_error( "The patch set is already applied" );
+
+        runs = compile();
+
+        commit( false );
+        applied = true;
+    }
+
+    void patch_set::rollback()
+    {
+        if ( !applied )
+            return;
+
+        commit( true );
+        applied = false;
+    }
+
+    void patch_set::clear()
+    {
+        writes.clear();
+        runs.clear();
+
+        applied = false;
+    }
+
+    bool patch_set::is_applied() const
+    {
+        return applied;
+    }
+
+    std::size_t patch_set::run_count() const
+    {
+        return compile().size();
+    }
+
+    std::vector< patch_set::run_t > patch_set::compile() const
+    {
+        std::vector< run_t > compiled;
+
+        std::vector< std::size_t > order( writes.size() );
+        std::iota( order.begin(), order.end(), 0 );
+
+        std::sort( order.begin(), order.end(), [ this ]( std::size_t lhs, std::size_t rhs ) {
+            return writes[ lhs ].address < writes[ rhs ].address;
+        } );
+
+        // Merge writes that touch or overlap into a single extent.
+        for ( const auto index : order )
+        {
+            const auto& write = writes[ index ];
+            const auto end = write.address + write.bytes.size();
+
+            if ( !compiled.empty() && write.address <= compiled.back().address + compiled.back().bytes.size() )
+            {
+                auto& run = compiled.back();
+                run.bytes.resize( std::max( run.bytes.size(), end - run.address ) );
+            }
+            else
+                compiled.push_back( { write.address, std::vector< std::uint8_t >( write.bytes.size() ), {} } );
+        }
+
+        // Lay the writes down in the order they were queued, so later writes win where they overlap.
+        for ( const auto& write : writes )
+        {
+            const auto run = std::prev( std::upper_bound(
+                compiled.begin(), compiled.end(), write.address, []( std::uintptr_t address, const run_t& run ) {
+                    return address < run.address;
+                } ) );
+
+            std::memcpy( run->bytes.data() + ( write.address - run->address ), write.bytes.data(), write.bytes.size() );
+        }
+
+        return compiled;
+    }
+
+    void patch_set::commit( bool restore )
+    {
+        // Gather the pages under every run into contiguous spans, so each span is unprotected only once.
+        std::vector< page_span_t > spans;
+
+        for ( const auto& run : runs )
+        {
+            const auto start = run.address & ~( page_size - 1 );
+            const auto end = ( run.address + run.bytes.size() + page_size - 1 ) & ~( page_size - 1 );
+
+            if ( !spans.empty() && start <= spans.back().end )
+                spans.back().end = std::max( spans.back().end, end );
+            else
+                spans.push_back( { start, end } );
+        }
+
+        std::vector< protection_t > changed;
+        std::vector< page_span_t > executable;
+
+        const auto restore_protection = [ & ]() {
+            for ( auto it = changed.rbegin(); it != changed.rend(); ++it )
+                win::memapi::virtual_protect_ex( handle, it->address, it->size, it->protect );
+        };
+
+        std::size_t written = 0;
+
+        try
+        {
+            for ( const auto& span : spans )
+            {
+                // A span can cover several regions with different protections, so change them one region at a time.
+                for ( auto address = span.start; address < span.end; )
+                {
+                    const auto info = win::memapi::virtual_query_ex( handle, address );
+
+                    if ( !info )
+                        throw win::win_exception::from_last_error( "VirtualQueryEx" );
+
+                    const auto region_end =
+                        std::min( reinterpret_cast< std::uintptr_t >( info->BaseAddress ) + info->RegionSize, span.end );
+
+                    // Strip the modifiers (guard, no-cache, write-combine) and keep the base protection.
+                    const auto protect = info->Protect & 0xFF;
+
+                    const auto is_executable =
+                        ( protect & ( PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE |
+                                      PAGE_EXECUTE_WRITECOPY ) ) != 0;
+                    const auto is_writable =
+                        ( protect & ( PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE |
+                                      PAGE_EXECUTE_WRITECOPY ) ) != 0;
+
+                    if ( !is_writable )
+                    {
+                        const auto old_protect = win::memapi::virtual_protect_ex(
+                            handle, address, region_end - address, is_executable ? PAGE_EXECUTE_READWRITE : PAGE_READWRITE );
+
+                        changed.push_back( { address, region_end - address, old_protect } );
+                    }
+
+                    if ( is_executable )
+                    {
+                        if ( !executable.empty() && executable.back().end == address )
+                            executable.back().end = region_end;
+                        else
+                            executable.push_back( { address, region_end } );
+                    }
+
+                    address = region_end;
+                }
+            }
+
+            for ( auto& run : runs )
+            {
+                if ( !restore )
+                {
+                    run.original.resize( run.bytes.size() );
+                    win::memapi::read_process_memory( handle, run.address, run.original.data(), run.original.size() );
+                }
+
+                const auto& bytes = restore ? run.original : run.bytes;
+                win::memapi::write_process_memory( handle, run.address, bytes.data(), bytes.size() );
+
+                ++written;
+            }
+        }
+        catch ( ... )
+        {
+            // Put back whatever part of the set made it into the process before bailing out.
+            if ( !restore )
+            {
+                for ( std::size_t i = 0; i < written; ++i )
+                {
+                    const auto& run = runs[ i ];
+
+                    WriteProcessMemory(
+                        handle.handle,
+                        reinterpret_cast< LPVOID >( run.address ),
+                        run.original.data(),
+                        run.original.size(),
+                        nullptr );
+                }
+            }
+
+            restore_protection();
+            throw;
+        }
+
+        restore_protection();
+
+        for ( const auto& span : executable )
+            win::memapi::flush_instruction_cache( handle, span.start, span.end - span.start );
+    }
+}  // namespace extlib
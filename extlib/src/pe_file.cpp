@@ -0,0 +1,104 @@
+#include "pe_file.hpp"
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace extlib
+{
+    namespace
+    {
+        /// <summary>
+        /// Converts the characteristics of a section into the equivalent page protection.
+        /// </summary>
+        std::uint64_t to_protection( std::uint32_t characteristics )
+        {
+            const auto writable = ( characteristics & IMAGE_SCN_MEM_WRITE ) != 0;
+
+            if ( characteristics & IMAGE_SCN_MEM_EXECUTE )
+                return writable ? PAGE_EXECUTE_READWRITE : PAGE_EXECUTE_READ;
+
+            return writable ? PAGE_READWRITE : PAGE_READONLY;
+        }
+    }  // namespace
+
+    pe_file_source::pe_file_source( const std::filesystem::path& path, std::optional< std::uintptr_t > base )
+        : file_source( path )
+    {
+        const auto dos = load< IMAGE_DOS_HEADER >( 0 );
+
+        if ( dos.e_magic != IMAGE_DOS_SIGNATURE || dos.e_lfanew < 0 ||
+             load< std::uint32_t >( dos.e_lfanew ) != IMAGE_NT_SIGNATURE )
+        {
+            std::stringstream msg;
+            msg << "'" << path.string() << "' is not a portable executable";
+            throw std::runtime_error( msg.str() );
+        }
+
+        const auto file_header_offset = static_cast< std::uint64_t >( dos.e_lfanew ) + sizeof( std::uint32_t );
+        const auto file_header = load< IMAGE_FILE_HEADER >( file_header_offset );
+
+        const auto optional_offset = file_header_offset + sizeof( IMAGE_FILE_HEADER );
+        const auto magic = load< std::uint16_t >( optional_offset );
+
+        // ImageBase, SizeOfImage and SizeOfHeaders sit at different offsets in 32 and 64-bit optional headers.
+        const auto is_64bit = magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC;
+        const auto image_base =
+            is_64bit ? load< std::uint64_t >( optional_offset + 24 ) : load< std::uint32_t >( optional_offset + 28 );
+
+        this->base = base ? *base : static_cast< std::uintptr_t >( image_base );
+        size = load< std::uint32_t >( optional_offset + 56 );
+
+        const auto headers_size = load< std::uint32_t >( optional_offset + 60 );
+
+        regions.push_back( {
+            this->base,
+            this->base + headers_size,
+            headers_size,
+            PAGE_READONLY,
+            win::region_state_t::commit_t,
+            win::region_type_t::image_t } );
+
+        add_range( this->base, std::min< std::size_t >( headers_size, file->size() ), 0 );
+
+        const auto section_offset = optional_offset + file_header.SizeOfOptionalHeader;
+
+        for ( std::size_t i = 0; i < file_header.NumberOfSections; ++i )
+        {
+            const auto section = load< IMAGE_SECTION_HEADER >( section_offset + i * sizeof( IMAGE_SECTION_HEADER ) );
+
+            const auto address = this->base + section.VirtualAddress;
+            const auto virtual_size = section.Misc.VirtualSize ? section.Misc.VirtualSize : section.SizeOfRawData;
+
+            if ( !virtual_size )
+                continue;
+
+            regions.push_back( {
+                address,
+                address + virtual_size,
+                virtual_size,
+                to_protection( section.Characteristics ),
+                win::region_state_t::commit_t,
+                win::region_type_t::image_t } );
+
+            // Only the initialized part of a section is in the file; the rest would be zero-filled by the loader.
+            add_range( address, std::min( section.SizeOfRawData, virtual_size ), section.PointerToRawData );
+        }
+
+        modules.push_back( { path.filename().string(), this->base, size } );
+
+        sort();
+    }
+
+    std::uintptr_t pe_file_source::get_base() const
+    {
+        return base;
+    }
+
+    std::size_t pe_file_source::get_size() const
+    {
+        return size;
+    }
+}  // namespace extlib
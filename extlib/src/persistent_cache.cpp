@@ -0,0 +1,452 @@
+#include "persistent_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "file_format.hpp"
+#include "remote.hpp"
+
+namespace extlib
+{
+    namespace
+    {
+        [[noreturn]] void corrupt( const std::filesystem::path& path, const char* reason )
+        {
+            detail::throw_corrupt( path, "persistent cache", reason );
+        }
+
+        bool matches( const persistent_cache_format::module_t& module, const module_fingerprint_t& fingerprint )
+        {
+            return module.timestamp == fingerprint.timestamp && module.checksum == fingerprint.checksum &&
+                   module.image_size == fingerprint.image_size && module.content_hash == fingerprint.content_hash;
+        }
+
+        /// <summary>
+        /// The size of a fingerprint's fields, which prefix the keys of results held in memory.
+        /// </summary>
+        constexpr std::size_t fingerprint_size = 3 * sizeof( std::uint32_t ) + sizeof( std::uint64_t );
+
+        /// <summary>
+        /// Gets the key of a result held in memory, which is unique across modules.
+        /// </summary>
+        std::string memory_key( const module_fingerprint_t& fingerprint, std::string_view key )
+        {
+            // The fields are copied one by one, as the padding between them holds nothing meaningful.
+            char bytes[ fingerprint_size ];
+
+            std::memcpy( bytes, &fingerprint.timestamp, 4 );
+            std::memcpy( bytes + 4, &fingerprint.checksum, 4 );
+            std::memcpy( bytes + 8, &fingerprint.image_size, 4 );
+            std::memcpy( bytes + 12, &fingerprint.content_hash, 8 );
+
+            std::string result( bytes, sizeof( bytes ) );
+            result.append( key );
+
+            return result;
+        }
+
+        /// <summary>
+        /// Gets the key a pattern's matches are cached under, e.g. `pattern:48 8B ?? 05`.
+        /// </summary>
+        std::string pattern_key( const pattern_t& pattern )
+        {
+            static constexpr char digits[] = "0123456789ABCDEF";
+
+            std::string key = "pattern:";
+
+            for ( const auto& [ byte, wildcard ] : pattern.bytes )
+            {
+                if ( key.size() > 8 )
+                    key += ' ';
+
+                if ( wildcard )
+                    key += "??";
+                else
+                {
+                    key += digits[ byte >> 4 ];
+                    key += digits[ byte & 0xF ];
+                }
+            }
+
+            return key;
+        }
+
+        std::vector< std::uintptr_t >
+        rebase( const win::module_t& module, const persistent_cache_format::hit_t* hits, std::size_t count )
+        {
+            std::vector< std::uintptr_t > addresses;
+            addresses.reserve( count );
+
+            for ( std::size_t i = 0; i < count; ++i )
+                addresses.push_back( module.start + hits[ i ].rva );
+
+            return addresses;
+        }
+    }  // namespace
+
+    persistent_cache::persistent_cache( bool hash_contents ) : state( std::make_unique< state_t >() )
+    {
+        state->hash_contents = hash_contents;
+    }
+
+    persistent_cache persistent_cache::load( const std::filesystem::path& path, bool hash_contents )
+    {
+        using namespace persistent_cache_format;
+
+        persistent_cache cache( hash_contents );
+        auto& state = *cache.state;
+
+        state.file = std::make_unique< win::mapped_file >( path );
+
+        const auto data = state.file->data();
+        const auto size = state.file->size();
+
+        if ( size < sizeof( header_t ) )
+            corrupt( path, "the file is too small" );
+
+        header_t header;
+        std::memcpy( &header, data, sizeof( header ) );
+
+        if ( header.magic != magic )
+            corrupt( path, "the magic does not match" );
+
+        if ( header.version != version )
+            corrupt( path, "the version is not supported" );
+
+        if ( !detail::table_fits( header.module_offset, header.module_count, sizeof( module_t ), size ) ||
+             !detail::table_fits( header.result_offset, header.result_count, sizeof( result_t ), size ) ||
+             !detail::table_fits( header.hit_offset, header.hit_count, sizeof( hit_t ), size ) ||
+             !detail::table_fits( header.string_offset, header.string_size, 1, size ) )
+            corrupt( path, "a table lies outside the file" );
+
+        state.modules = detail::table_at< module_t >( data, header.module_offset );
+        state.results = detail::table_at< result_t >( data, header.result_offset );
+        state.hits = detail::table_at< hit_t >( data, header.hit_offset );
+        state.strings = detail::table_at< char >( data, header.string_offset );
+        state.module_count = static_cast< std::size_t >( header.module_count );
+
+        // Lookups follow the ranges in the tables, so they must not point past them.
+        for ( std::size_t i = 0; i < state.module_count; ++i )
+        {
+            const auto& module = state.modules[ i ];
+
+            if ( module.first_result > header.result_count ||
+                 module.result_count > header.result_count - module.first_result )
+                corrupt( path, "a module's results lie outside the result table" );
+        }
+
+        for ( std::size_t i = 0; i < header.result_count; ++i )
+        {
+            const auto& result = state.results[ i ];
+
+            if ( result.first_hit > header.hit_count || result.hit_count > header.hit_count - result.first_hit ||
+                 result.key_offset > header.string_size || result.key_size > header.string_size - result.key_offset )
+                corrupt( path, "a result lies outside the hit or string table" );
+        }
+
+        for ( std::size_t i = 0; i < header.hit_count; ++i )
+        {
+            if ( state.hits[ i ].check_length > check_size )
+                corrupt( path, "a hit keeps more bytes than a hit can" );
+        }
+
+        return cache;
+    }
+
+    persistent_cache persistent_cache::open( const std::filesystem::path& path, bool hash_contents )
+    {
+        std::error_code error;
+
+        if ( !std::filesystem::is_regular_file( path, error ) )
+            return persistent_cache( hash_contents );
+
+        try
+        {
+            return load( path, hash_contents );
+        }
+        catch ( const std::exception& )
+        {
+            return persistent_cache( hash_contents );
+        }
+    }
+
+    std::vector< std::uintptr_t > persistent_cache::get_or_compute(
+        const win::module_t& module,
+        std::string_view key,
+        const std::function< std::vector< std::uintptr_t >( const win::module_t& ) >& compute )
+    {
+        const auto fingerprint = state->fingerprints.get( module, state->hash_contents );
+        const auto stored_key = memory_key( fingerprint, key );
+
+        std::vector< persistent_cache_format::hit_t > held;
+        auto found = false, checked = false;
+
+        // The loaded tables point into the file, which `save` unmaps, so their hits are copied out under the lock.
+        {
+            std::lock_guard< std::mutex > lock( state->mutex );
+
+            const auto it = state->computed.find( stored_key );
+
+            if ( it != state->computed.end() )
+            {
+                held = it->second.hits;
+                found = true;
+                checked = it->second.checked;
+            }
+            else if ( const auto [ hits, count ] = find_loaded( fingerprint, key ); hits )
+            {
+                held.assign( hits, hits + count );
+                found = true;
+            }
+        }
+
+        // Results computed in this run are known to be right; anything else is checked against the module first.
+        if ( found && ( checked || check( module, held.data(), held.size() ) ) )
+        {
+            auto addresses = rebase( module, held.data(), held.size() );
+
+            std::lock_guard< std::mutex > lock( state->mutex );
+
+            ++state->stats.hits;
+            state->computed[ stored_key ] = { fingerprint, std::string( key ), std::move( held ), true };
+
+            return addresses;
+        }
+
+        const auto addresses = compute( module );
+
+        for ( const auto address : addresses )
+        {
+            if ( !module.contains( address ) )
+            {
+                std::stringstream msg;
+                msg << "Computed result 0x" << std::hex << address << " for '" << key << "' lies outside of its module";
+                throw std::invalid_argument( msg.str() );
+            }
+        }
+
+        auto captured = capture( module, addresses );
+
+        std::lock_guard< std::mutex > lock( state->mutex );
+
+        ++( found ? state->stats.stale : state->stats.misses );
+        state->computed[ stored_key ] = { fingerprint, std::string( key ), std::move( captured ), true };
+
+        return addresses;
+    }
+
+    std::vector< std::uintptr_t > persistent_cache::find_all( const win::module_t& module, const pattern_t& pattern )
+    {
+        return get_or_compute( module, pattern_key( pattern ), [ &pattern ]( const win::module_t& target ) {
+            return target.find_all( pattern );
+        } );
+    }
+
+    void persistent_cache::save( const std::filesystem::path& path )
+    {
+        using namespace persistent_cache_format;
+
+        std::lock_guard< std::mutex > lock( state->mutex );
+
+        // The loaded results move into memory, so the file can be unmapped and overwritten. They are still checked
+        // before they are used, as they were when they lived in the file.
+        for ( std::size_t i = 0; i < state->module_count; ++i )
+        {
+            const auto& module = state->modules[ i ];
+            const module_fingerprint_t fingerprint{
+                module.timestamp, module.checksum, module.image_size, module.content_hash };
+
+            for ( auto j = module.first_result; j < module.first_result + module.result_count; ++j )
+            {
+                const auto& result = state->results[ j ];
+                const auto key = std::string_view( state->strings + result.key_offset, result.key_size );
+                const auto hits = state->hits + result.first_hit;
+
+                state->computed.emplace(
+                    memory_key( fingerprint, key ),
+                    computed_t{ fingerprint, std::string( key ), { hits, hits + result.hit_count }, false } );
+            }
+        }
+
+        state->modules = nullptr;
+        state->results = nullptr;
+        state->hits = nullptr;
+        state->strings = nullptr;
+        state->module_count = 0;
+        state->file.reset();
+
+        // Results are grouped by module and sorted by key, which is the order lookups search them in.
+        std::map< std::string, std::vector< const computed_t* > > by_module;
+
+        for ( const auto& [ stored_key, computed ] : state->computed )
+            by_module[ stored_key.substr( 0, fingerprint_size ) ].push_back( &computed );
+
+        std::vector< module_t > modules;
+        std::vector< result_t > results;
+        std::vector< hit_t > hits;
+        std::string strings;
+
+        for ( auto& [ fingerprint_bytes, computed ] : by_module )
+        {
+            std::sort( computed.begin(), computed.end(), []( const computed_t* left, const computed_t* right ) {
+                return left->key < right->key;
+            } );
+
+            const auto& fingerprint = computed.front()->fingerprint;
+
+            modules.push_back( {
+                fingerprint.timestamp,
+                fingerprint.checksum,
+                fingerprint.image_size,
+                0,
+                fingerprint.content_hash,
+                results.size(),
+                computed.size() } );
+
+            for ( const auto result : computed )
+            {
+                results.push_back( { strings.size(), result->key.size(), hits.size(), result->hits.size() } );
+
+                strings += result->key;
+                hits.insert( hits.end(), result->hits.begin(), result->hits.end() );
+            }
+        }
+
+        header_t header{};
+
+        header.magic = magic;
+        header.version = version;
+        header.module_count = modules.size();
+        header.result_count = results.size();
+        header.hit_count = hits.size();
+        header.string_size = strings.size();
+        header.module_offset = detail::align8( sizeof( header ) );
+        header.result_offset = detail::align8( header.module_offset + modules.size() * sizeof( module_t ) );
+        header.hit_offset = detail::align8( header.result_offset + results.size() * sizeof( result_t ) );
+        header.string_offset = detail::align8( header.hit_offset + hits.size() * sizeof( hit_t ) );
+
+        std::ofstream stream( path, std::ios::binary | std::ios::trunc );
+
+        if ( !stream )
+        {
+            std::stringstream msg;
+            msg << "Failed to create persistent cache '" << path.string() << "'";
+            throw std::runtime_error( msg.str() );
+        }
+
+        detail::write_at( stream, 0, &header, sizeof( header ) );
+        detail::write_at( stream, header.module_offset, modules.data(), modules.size() * sizeof( module_t ) );
+        detail::write_at( stream, header.result_offset, results.data(), results.size() * sizeof( result_t ) );
+        detail::write_at( stream, header.hit_offset, hits.data(), hits.size() * sizeof( hit_t ) );
+        detail::write_at( stream, header.string_offset, strings.data(), strings.size() );
+
+        stream.flush();
+
+        if ( !stream )
+            throw std::runtime_error( "Failed to write persistent cache" );
+    }
+
+    persistent_cache_stats_t persistent_cache::get_stats() const
+    {
+        std::lock_guard< std::mutex > lock( state->mutex );
+
+        return state->stats;
+    }
+
+    std::pair< const persistent_cache_format::hit_t*, std::size_t >
+    persistent_cache::find_loaded( const module_fingerprint_t& fingerprint, std::string_view key ) const
+    {
+        for ( std::size_t i = 0; i < state->module_count; ++i )
+        {
+            const auto& module = state->modules[ i ];
+
+            if ( !matches( module, fingerprint ) )
+                continue;
+
+            const auto first = state->results + module.first_result;
+            const auto last = first + module.result_count;
+
+            const auto key_of = [ this ]( const persistent_cache_format::result_t& result ) {
+                return std::string_view( state->strings + result.key_offset, static_cast< std::size_t >( result.key_size ) );
+            };
+
+            const auto it = std::lower_bound(
+                first, last, key, [ &key_of ]( const persistent_cache_format::result_t& result, std::string_view value ) {
+                    return key_of( result ) < value;
+                } );
+
+            if ( it == last || key_of( *it ) != key )
+                return {};
+
+            return { state->hits + it->first_hit, static_cast< std::size_t >( it->hit_count ) };
+        }
+
+        return {};
+    }
+
+    bool
+    persistent_cache::check( const win::module_t& module, const persistent_cache_format::hit_t* hits, std::size_t count )
+    {
+        std::vector< std::uint8_t > bytes( count * persistent_cache_format::check_size );
+        std::vector< detail::remote_read_t > reads;
+        std::vector< bool > failed( count );
+
+        for ( std::size_t i = 0; i < count; ++i )
+        {
+            if ( hits[ i ].check_length )
+            {
+                reads.push_back( {
+                    module.start + hits[ i ].rva,
+                    hits[ i ].check_length,
+                    bytes.data() + i * persistent_cache_format::check_size,
+                    i } );
+            }
+        }
+
+        detail::read_scattered( module, reads, failed );
+
+        for ( std::size_t i = 0; i < count; ++i )
+        {
+            const auto found = bytes.data() + i * persistent_cache_format::check_size;
+
+            if ( failed[ i ] || std::memcmp( found, hits[ i ].check, hits[ i ].check_length ) )
+                return false;
+        }
+
+        return true;
+    }
+
+    std::vector< persistent_cache_format::hit_t >
+    persistent_cache::capture( const win::module_t& module, const std::vector< std::uintptr_t >& addresses )
+    {
+        std::vector< persistent_cache_format::hit_t > hits( addresses.size() );
+        std::vector< detail::remote_read_t > reads;
+        std::vector< bool > failed( addresses.size() );
+
+        for ( std::size_t i = 0; i < addresses.size(); ++i )
+        {
+            auto& hit = hits[ i ];
+
+            hit.rva = static_cast< std::uint32_t >( addresses[ i ] - module.start );
+            hit.check_length = static_cast< std::uint32_t >(
+                std::min< std::size_t >( persistent_cache_format::check_size, module.end - addresses[ i ] ) );
+
+            reads.push_back( { addresses[ i ], hit.check_length, hit.check, i } );
+        }
+
+        detail::read_scattered( module, reads, failed );
+
+        // A hit whose bytes cannot be read is kept without any, and is trusted on the fingerprint alone.
+        for ( std::size_t i = 0; i < addresses.size(); ++i )
+        {
+            if ( failed[ i ] )
+                hits[ i ].check_length = 0;
+        }
+
+        return hits;
+    }
+}  // namespace extlib
@@ -0,0 +1,165 @@
+#include "pointer_chain.hpp"
+
+#include <map>
+
+namespace extlib
+{
+    pointer_chain_set::pointer_chain_set( const std::vector< pointer_chain_t >& chains, pointer_chain_options_t options )
+        : options( options )
+    {
+        // The nodes already created on every level, by their parent and their offset (or by their base).
+        std::vector< std::map< std::pair< std::uint32_t, std::uintptr_t >, std::uint32_t > > created;
+
+        leaves.reserve( chains.size() );
+
+        for ( const auto& chain : chains )
+        {
+            std::uint32_t parent = 0;
+
+            for ( std::size_t depth = 0; depth <= chain.offsets.size(); ++depth )
+            {
+                if ( levels.size() == depth )
+                {
+                    levels.emplace_back();
+                    created.emplace_back();
+                }
+
+                const auto value =
+                    depth ? static_cast< std::uintptr_t >( chain.offsets[ depth - 1 ] ) : chain.base;
+                const auto key = std::make_pair( depth ? parent : 0u, value );
+
+                auto& level = levels[ depth ];
+                const auto [ it, inserted ] = created[ depth ].emplace( key, static_cast< std::uint32_t >( level.size() ) );
+
+                if ( inserted )
+                    level.push_back( { key.first, false, value, 0, 0, 0, 0 } );
+
+                if ( depth )
+                    levels[ depth - 1 ][ parent ].has_children = true;
+
+                parent = it->second;
+            }
+
+            leaves.emplace_back( static_cast< std::uint32_t >( chain.offsets.size() ), parent );
+        }
+    }
+
+    std::vector< std::optional< std::uintptr_t > > pointer_chain_set::resolve( const win::module_t& module )
+    {
+        std::vector< std::optional< std::uintptr_t > > addresses;
+
+        resolve( module, addresses );
+
+        return addresses;
+    }
+
+    void pointer_chain_set::resolve( const win::module_t& module, std::vector< std::optional< std::uintptr_t > >& addresses )
+    {
+        ++generation;
+        last_read_count = 0;
+
+        for ( std::size_t depth = 0; depth < levels.size(); ++depth )
+        {
+            auto& level = levels[ depth ];
+
+            reads.clear();
+            failed.assign( level.size(), false );
+
+            for ( std::size_t i = 0; i < level.size(); ++i )
+            {
+                auto& node = level[ i ];
+
+                if ( depth )
+                {
+                    const auto& parent = levels[ depth - 1 ][ node.parent ];
+                    node.address = parent.address && parent.pointer ? parent.pointer + node.value : 0;
+                }
+                else
+                    node.address = node.value;
+
+                if ( !node.has_children )
+                    continue;
+
+                if ( !node.address )
+                {
+                    node.pointer = 0;
+                    node.read_address = 0;
+                    continue;
+                }
+
+                // Pointers on stable levels are reused until they are due, unless the node moved in the meantime.
+                const auto cached = depth < options.cached_levels && node.pointer && node.read_address == node.address &&
+                                    generation - node.read_generation < options.revalidate_interval;
+
+                if ( cached )
+                    continue;
+
+                node.read_address = node.address;
+                node.read_generation = generation;
+
+                reads.push_back(
+                    { node.address, sizeof( node.pointer ), reinterpret_cast< std::uint8_t* >( &node.pointer ), i } );
+            }
+
+            if ( reads.empty() )
+                continue;
+
+            detail::read_scattered( module, reads, failed, scratch );
+
+            for ( const auto& read : reads )
+            {
+                if ( failed[ read.object ] )
+                    level[ read.object ].pointer = 0;
+            }
+
+            last_read_count += reads.size();
+        }
+
+        addresses.resize( leaves.size() );
+
+        for ( std::size_t i = 0; i < leaves.size(); ++i )
+        {
+            const auto& leaf = levels[ leaves[ i ].first ][ leaves[ i ].second ];
+
+            if ( leaf.address )
+                addresses[ i ] = leaf.address;
+            else
+                addresses[ i ].reset();
+        }
+    }
+
+    void pointer_chain_set::invalidate()
+    {
+        for ( auto& level : levels )
+        {
+            for ( auto& node : level )
+            {
+                node.pointer = 0;
+                node.read_address = 0;
+            }
+        }
+    }
+
+    std::size_t pointer_chain_set::size() const
+    {
+        return leaves.size();
+    }
+
+    std::size_t pointer_chain_set::get_pointer_count() const
+    {
+        std::size_t count = 0;
+
+        for ( const auto& level : levels )
+        {
+            for ( const auto& node : level )
+                count += node.has_children;
+        }
+
+        return count;
+    }
+
+    std::size_t pointer_chain_set::get_last_read_count() const
+    {
+        return last_read_count;
+    }
+}  // namespace extlib
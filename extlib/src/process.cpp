@@ -1,36 +1,58 @@
 #include "process.hpp"
 
+#include <TlHelp32.h>
+
+#include <algorithm>
+#include <cctype>
 #include <filesystem>
 #include <iostream>
 #include <sstream>
 
 namespace extlib
 {
-    std::vector< std::unique_ptr< process > > process::get_all_by_name( const std::string_view name )
+    namespace
+    {
+        /// <summary>
+        /// Lowercases a module name, as module names are case-insensitive.
+        /// </summary>
+        std::string to_lower( std::string_view name )
+        {
+            std::string result( name );
+
+            std::transform( result.begin(), result.end(), result.begin(), []( unsigned char c ) {
+                return static_cast< char >( std::tolower( c ) );
+            } );
+
+            return result;
+        }
+    }  // namespace
+
+    std::vector< std::unique_ptr< process > >
+    process::get_all_by_name( const std::string_view name, std::uint64_t desired_access )
     {
         std::vector< std::unique_ptr< process > > processes;
 
-        for ( const auto id : get_ids_from_name( name ) )
+        const auto snapshot = process_snapshot::capture();
+
+        for ( const auto id : snapshot.find( name ) )
         {
-            auto handle = win::ptapi::open_process( PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, false, id );
+            std::unique_ptr< win::handle_t > handle;
 
-            const auto old_size = processes.size();
+            // The process may have exited since the snapshot was taken, or may not be ours to open.
+            if ( !win::ptapi::try_open_process( handle, desired_access, false, id ) )
+                continue;
 
-            for ( const auto& mod : win::psapi::enum_process_modules( handle, win::module_filter_flag::list_all ) )
-            {
-                const auto& base_name = win::psapi::get_module_base_name( handle, mod );
+            // The executable is always the first module listed, so there is no need to look at the others.
+            auto modules = list_modules( handle );
 
-                if ( base_name == name.data() )
-                {
-                    processes.emplace_back( new process{ std::move( handle ), mod, name.data() } );
-                    goto after_close;
-                }
+            if ( modules.empty() )
+            {
+                win::ptapi::close_handle( std::move( handle ) );
+                continue;
             }
 
-            win::ptapi::close_handle( std::move( handle ) );
-
-        // Adding labels is terrible practice, but it was the best I could do for optimization.
-        after_close:
+            processes.emplace_back(
+                new process{ std::move( handle ), std::move( modules.front().second ), snapshot.get( id )->name } );
         }
 
         return processes;
@@ -38,43 +60,100 @@ namespace extlib
 
     std::vector< std::uint64_t > process::get_ids_from_name( const std::string_view name )
     {
-        std::vector< std::uint64_t > ids;
+        return process_snapshot::capture().find( name );
+    }
 
-        for ( const auto id : win::psapi::enum_processes() )
-        {
-            std::unique_ptr< win::handle_t > handle;
+    bool process::is_64bit() const
+    {
+        return main_module.get_kind() == win::pe_kind_t::pe64;
+    }
 
-            if ( !win::ptapi::try_open_process( handle, PROCESS_QUERY_INFORMATION, false, id ) )
-                continue;
+    win::module_t process::operator[]( const std::string_view name ) const
+    {
+        const auto key = to_lower( name );
 
-            if ( handle->path().filename().string() == name.data() )
-                ids.push_back( id );
+        std::lock_guard< std::mutex > lock( module_mutex );
 
-            win::ptapi::close_handle( std::move( handle ) );
+        auto it = modules_by_name.find( key );
+
+        // A miss may just mean the module was loaded after the cache was built, so rebuild it once before giving up.
+        if ( it == modules_by_name.end() )
+        {
+            modules_by_name.clear();
+
+            for ( auto& [ base_name, module ] : list_modules( handle ) )
+                modules_by_name.emplace( to_lower( base_name ), std::move( module ) );
+
+            it = modules_by_name.find( key );
         }
 
-        return ids;
+        if ( it != modules_by_name.end() )
+            return it->second;
+
+        std::stringstream msg;
+        msg << "Failed to find module with name " << name.data();
+
+        throw std::runtime_error( msg.str() );
     }
 
-    bool process::is_64bit() const
+    void process::refresh_modules()
     {
-        return main_module.kind == win::pe_kind_t::pe64;
+        std::lock_guard< std::mutex > lock( module_mutex );
+
+        modules_by_name.clear();
     }
 
-    win::module_t process::get_module_by_name( std::unique_ptr< win::handle_t >& handle, const std::string_view name )
+    std::vector< std::pair< std::string, win::module_t > >
+    process::list_modules( const std::unique_ptr< win::handle_t >& handle )
     {
-        for ( const auto& mod : win::psapi::enum_process_modules( handle, win::module_filter_flag::list_all ) )
+        std::vector< std::pair< std::string, win::module_t > > modules;
+
+        const auto id = GetProcessId( handle->handle );
+
+        // Toolhelp reports every module's bounds and name at once. It fails with ERROR_BAD_LENGTH while the target
+        // is loading or unloading modules, which is worth a few retries.
+        auto snapshot = INVALID_HANDLE_VALUE;
+
+        for ( auto attempt = 0; attempt < 4 && snapshot == INVALID_HANDLE_VALUE; ++attempt )
         {
-            const auto& base_name = win::psapi::get_module_base_name( handle, mod );
+            snapshot = CreateToolhelp32Snapshot( TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, id );
 
-            if ( base_name == name.data() )
-                return mod;
+            if ( snapshot == INVALID_HANDLE_VALUE && GetLastError() != ERROR_BAD_LENGTH )
+                break;
         }
 
-        std::stringstream msg;
-        msg << "Failed to find module with name " << name.data();
+        if ( snapshot != INVALID_HANDLE_VALUE )
+        {
+            MODULEENTRY32 entry{};
+            entry.dwSize = sizeof( entry );
 
-        throw std::runtime_error( msg.str() );
+            for ( auto found = Module32First( snapshot, &entry ); found; found = Module32Next( snapshot, &entry ) )
+            {
+                modules.emplace_back(
+                    entry.szModule,
+                    win::module_t{
+                        handle->handle, reinterpret_cast< std::uintptr_t >( entry.modBaseAddr ), entry.modBaseSize } );
+            }
+
+            CloseHandle( snapshot );
+
+            if ( !modules.empty() )
+                return modules;
+        }
+
+        // Fall back to the process status API, which needs a call per module.
+        for ( auto& module : win::psapi::enum_process_modules( handle, win::module_filter_flag::list_all ) )
+        {
+            auto base_name = win::psapi::get_module_base_name( handle, module );
+            modules.emplace_back( std::move( base_name ), std::move( module ) );
+        }
+
+        return modules;
+    }
+
+    patch_set process::create_patch_set() const
+    {
+        return patch_set{ *handle };
     }
 
     void process::close()
@@ -87,6 +166,11 @@ namespace extlib
 
     std::vector< win::module_t > process::get_modules() const
     {
-        return win::psapi::enum_process_modules( handle, win::module_filter_flag::list_all );
+        std::vector< win::module_t > modules;
+
+        for ( auto& [ base_name, module ] : list_modules( handle ) )
+            modules.push_back( std::move( module ) );
+
+        return modules;
     }
 }  // namespace extlib
\ No newline at end of file
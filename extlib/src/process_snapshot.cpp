@@ -0,0 +1,129 @@
+#include "process_snapshot.hpp"
+
+// clang-format off
+#include "win/ptapi.hpp"
+// clang-format on
+
+#include <TlHelp32.h>
+
+#include <algorithm>
+#include <cctype>
+
+#include "win/win_exception.hpp"
+
+namespace extlib
+{
+    namespace
+    {
+        /// <summary>
+        /// Lowercases a name, as process names are case-insensitive.
+        /// </summary>
+        std::string to_lower( std::string_view name )
+        {
+            std::string result( name );
+
+            std::transform( result.begin(), result.end(), result.begin(), []( unsigned char c ) {
+                return static_cast< char >( std::tolower( c ) );
+            } );
+
+            return result;
+        }
+    }  // namespace
+
+    process_snapshot process_snapshot::capture()
+    {
+        const auto snapshot = CreateToolhelp32Snapshot( TH32CS_SNAPPROCESS, 0 );
+
+        if ( snapshot == INVALID_HANDLE_VALUE )
+            throw win::win_exception::from_last_error( "CreateToolhelp32Snapshot" );
+
+        process_snapshot result;
+
+        PROCESSENTRY32 entry{};
+        entry.dwSize = sizeof( entry );
+
+        for ( auto found = Process32First( snapshot, &entry ); found; found = Process32Next( snapshot, &entry ) )
+        {
+            // The idle process has no image, and is of no use to anyone.
+            if ( !entry.th32ProcessID )
+                continue;
+
+            const auto index = result.processes.size();
+
+            result.processes.push_back( { entry.th32ProcessID, entry.th32ParentProcessID, entry.szExeFile } );
+            result.by_name[ to_lower( entry.szExeFile ) ].push_back( index );
+            result.by_id.emplace( entry.th32ProcessID, index );
+        }
+
+        CloseHandle( snapshot );
+
+        return result;
+    }
+
+    process_snapshot::process_snapshot( process_snapshot&& other ) noexcept
+        : processes( std::move( other.processes ) ),
+          by_name( std::move( other.by_name ) ),
+          by_id( std::move( other.by_id ) ),
+          paths( std::move( other.paths ) )
+    {
+    }
+
+    process_snapshot& process_snapshot::operator=( process_snapshot&& other ) noexcept
+    {
+        processes = std::move( other.processes );
+        by_name = std::move( other.by_name );
+        by_id = std::move( other.by_id );
+        paths = std::move( other.paths );
+
+        return *this;
+    }
+
+    const std::vector< process_entry_t >& process_snapshot::get_processes() const
+    {
+        return processes;
+    }
+
+    std::vector< std::uint64_t > process_snapshot::find( std::string_view name ) const
+    {
+        std::vector< std::uint64_t > ids;
+
+        const auto it = by_name.find( to_lower( name ) );
+
+        if ( it == by_name.end() )
+            return ids;
+
+        for ( const auto index : it->second )
+            ids.push_back( processes[ index ].id );
+
+        return ids;
+    }
+
+    const process_entry_t* process_snapshot::get( std::uint64_t id ) const
+    {
+        const auto it = by_id.find( id );
+
+        return it != by_id.end() ? &processes[ it->second ] : nullptr;
+    }
+
+    std::filesystem::path process_snapshot::get_path( std::uint64_t id ) const
+    {
+        std::lock_guard< std::mutex > lock( path_mutex );
+
+        if ( const auto it = paths.find( id ); it != paths.end() )
+            return it->second;
+
+        std::filesystem::path path;
+        std::unique_ptr< win::handle_t > handle;
+
+        // Limited information is enough for the image name, and is granted for far more processes.
+        if ( win::ptapi::try_open_process( handle, PROCESS_QUERY_LIMITED_INFORMATION, false, id ) )
+        {
+            path = win::ptapi::query_full_process_image_name( *handle );
+            win::ptapi::close_handle( std::move( handle ) );
+        }
+
+        paths.emplace( id, path );
+
+        return path;
+    }
+}  // namespace extlib
@@ -0,0 +1,134 @@
+#include "remote.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace extlib::detail
+{
+    namespace
+    {
+        /// <summary>
+        /// Reads a span into a buffer.
+        /// </summary>
+        /// <returns>True, if the whole span was read.</returns>
+        bool read_into( const win::module_t& module, std::uintptr_t address, void* buffer, std::size_t length )
+        {
+            if ( module.source )
+                return module.source->read( address, buffer, length ) == length;
+
+            try
+            {
+                return win::memapi::read_process_memory( module.handle, address, buffer, length ) == length;
+            }
+            catch ( const std::exception& )
+            {
+                return false;
+            }
+        }
+    }  // namespace
+
+    std::vector< merged_read_t > merge_reads( std::vector< remote_read_t >& reads )
+    {
+        std::vector< merged_read_t > runs;
+
+        merge_reads( reads, runs );
+
+        return runs;
+    }
+
+    void merge_reads( std::vector< remote_read_t >& reads, std::vector< merged_read_t >& runs )
+    {
+        std::sort( reads.begin(), reads.end(), []( const remote_read_t& left, const remote_read_t& right ) {
+            return left.address < right.address;
+        } );
+
+        runs.clear();
+
+        for ( std::size_t i = 0; i < reads.size(); ++i )
+        {
+            const auto& read = reads[ i ];
+            const auto end = read.address + read.length;
+
+            if ( !runs.empty() )
+            {
+                auto& last = runs.back();
+
+                if ( read.address <= last.end + remote_merge_gap &&
+                     std::max( end, last.end ) - last.start <= remote_max_merged_read )
+                {
+                    last.end = std::max( end, last.end );
+                    last.last = i + 1;
+                    continue;
+                }
+            }
+
+            runs.push_back( { read.address, end, i, i + 1 } );
+        }
+    }
+
+    void read_merged(
+        const win::module_t& module,
+        const std::vector< remote_read_t >& reads,
+        const merged_read_t& merged,
+        std::vector< std::uint8_t >& buffer,
+        std::vector< std::uint8_t >& failed )
+    {
+        if ( merged.last - merged.first == 1 )
+        {
+            const auto& read = reads[ merged.first ];
+
+            if ( !read_into( module, read.address, read.destination, read.length ) )
+                failed[ read.object ] = 1;
+
+            return;
+        }
+
+        buffer.resize( merged.end - merged.start );
+
+        if ( read_into( module, merged.start, buffer.data(), buffer.size() ) )
+        {
+            for ( auto i = merged.first; i < merged.last; ++i )
+            {
+                const auto& read = reads[ i ];
+                std::memcpy( read.destination, buffer.data() + ( read.address - merged.start ), read.length );
+            }
+
+            return;
+        }
+
+        // Part of the run is unreadable, which may well be a gap between its reads.
+        for ( auto i = merged.first; i < merged.last; ++i )
+        {
+            const auto& read = reads[ i ];
+
+            if ( !read_into( module, read.address, read.destination, read.length ) )
+                failed[ read.object ] = 1;
+        }
+    }
+
+    void read_scattered( const win::module_t& module, std::vector< remote_read_t >& reads, std::vector< bool >& failed )
+    {
+        scattered_scratch_t scratch;
+
+        read_scattered( module, reads, failed, scratch );
+    }
+
+    void read_scattered(
+        const win::module_t& module,
+        std::vector< remote_read_t >& reads,
+        std::vector< bool >& failed,
+        scattered_scratch_t& scratch )
+    {
+        merge_reads( reads, scratch.runs );
+        scratch.failed.assign( failed.size(), 0 );
+
+        for ( const auto& merged : scratch.runs )
+            read_merged( module, reads, merged, scratch.buffer, scratch.failed );
+
+        for ( std::size_t i = 0; i < failed.size(); ++i )
+        {
+            if ( scratch.failed[ i ] )
+                failed[ i ] = true;
+        }
+    }
+}  // namespace extlib::detail
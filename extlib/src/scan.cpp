@@ -1,18 +1,52 @@
 #include "scan.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <string>
 
+#include "hash.hpp"
 #include "win/memapi.hpp"
+#include "x64.hpp"
 
 namespace extlib
 {
-    scanner::scanner( const scanner_options_t& options ) : options( options )
+    namespace
+    {
+        /// <summary>
+        /// The granularity the scan cache tracks changes at.
+        /// </summary>
+        constexpr std::size_t page_size = 0x1000;
+
+        /// <summary>
+        /// Converts a single hexadecimal digit into its value.
+        /// </summary>
+        std::uint8_t from_hex_digit( char digit )
+        {
+            if ( digit >= '0' && digit <= '9' )
+                return static_cast< std::uint8_t >( digit - '0' );
+
+            if ( digit >= 'a' && digit <= 'f' )
+                return static_cast< std::uint8_t >( digit - 'a' + 10 );
+
+            if ( digit >= 'A' && digit <= 'F' )
+                return static_cast< std::uint8_t >( digit - 'A' + 10 );
+
+            std::stringstream msg;
+            msg << "Invalid hexadecimal digit '" << digit << "' in byte pattern";
+            throw std::invalid_argument( msg.str() );
+        }
+    }  // namespace
+
+    scanner::scanner( const scanner_options_t& options )
+        : options( options ),
+          scratch( options.read_size * 2, options.large_pages )
     {
     }
 
-    scanner::scanner() : options{}
+    scanner::scanner() : options{}, scratch( options.read_size * 2, options.large_pages )
     {
     }
 
@@ -20,33 +54,284 @@ namespace extlib
     {
         std::vector< std::uintptr_t > addresses;
 
-        auto start_address = options.start;
+        scan( pattern, addresses );
+
+        return addresses;
+    }
+
+    std::pmr::vector< std::uintptr_t >
+    scanner::find_all( const pattern_t& pattern, std::pmr::memory_resource* resource ) const
+    {
+        std::pmr::vector< std::uintptr_t > addresses{ resource };
+
+        scan( pattern, addresses );
+
+        return addresses;
+    }
+
+    std::vector< std::uintptr_t > scanner::find_all( const pattern_t& pattern, scan_cache& cache ) const
+    {
+        std::vector< std::uintptr_t > addresses;
+
+        if ( pattern.bytes.empty() )
+            return addresses;
+
+        if ( cache.pattern != pattern.bytes )
+        {
+            cache.clear();
+            cache.pattern = pattern.bytes;
+        }
+
+        const auto generation = ++cache.generation;
+
+        cache.reused = 0;
+        cache.matched = 0;
+
+        scratch.reset();
+
+        // Chunks are whole pages, and each one is read together with the bytes a match starting on its last page can
+        // reach into the next one.
+        const auto chunk_size = std::max( options.read_size & ~( page_size - 1 ), page_size );
+        const auto overlap = pattern.bytes.size() - 1;
+
+        const auto buffer =
+            static_cast< std::uint8_t* >( scratch.allocate( chunk_size + overlap, arena::min_alignment ) );
+
+        for_each_region( [ & ]( std::uintptr_t base_address, std::uintptr_t end_address ) {
+            for ( auto address = base_address; address < end_address; address += chunk_size )
+            {
+                const auto length = std::min( chunk_size, end_address - address );
+                const auto wanted = std::min( length + overlap, end_address - address );
+
+                auto read_length = wanted;
+                const auto data = fetch( address, buffer, read_length );
+
+                for ( std::size_t offset = 0; offset < length && offset < read_length; offset += page_size )
+                {
+                    // A page's matches depend on the page itself and on the `overlap` bytes following it.
+                    const auto window = data + offset;
+                    const auto window_length = std::min( page_size + overlap, read_length - offset );
+
+                    const auto hash = xxh64( window, window_length );
+                    auto& page = cache.pages[ address + offset ];
+
+                    if ( page.generation && page.hash == hash )
+                        ++cache.reused;
+                    else
+                    {
+                        page.hash = hash;
+                        page.hits.clear();
+
+                        for ( const auto index : pattern.find_matches( window, window_length, &scratch ) )
+                            page.hits.push_back( static_cast< std::uint16_t >( index ) );
+
+                        ++cache.matched;
+                    }
+
+                    page.generation = generation;
+
+                    for ( const auto hit : page.hits )
+                        addresses.push_back( address + offset + hit );
+                }
+
+                if ( read_length < wanted )
+                    break;
+            }
+        } );
+
+        // Drop the pages that are no longer part of any readable region.
+        for ( auto it = cache.pages.begin(); it != cache.pages.end(); )
+        {
+            if ( it->second.generation != generation )
+                it = cache.pages.erase( it );
+            else
+                ++it;
+        }
+
+        return addresses;
+    }
+
+    template< typename callback_t >
+    void scanner::for_each_region( callback_t&& callback ) const
+    {
+        if ( options.ranges.empty() )
+        {
+            for_each_region( options.start, options.end, callback );
+            return;
+        }
+
+        for ( const auto& [ start, end ] : options.ranges )
+            for_each_region( start, end, callback );
+    }
+
+    template< typename callback_t >
+    void scanner::for_each_region( std::uintptr_t start, std::uintptr_t end, callback_t& callback ) const
+    {
+        // Regions usually extend past the range being scanned, so only their overlap with it is handed on.
+        const auto visit = [ & ]( std::uintptr_t base_address, std::uintptr_t end_address ) {
+            const auto from = std::max( base_address, start );
+            const auto to = std::min( end_address, end );
+
+            if ( from < to )
+                callback( from, to );
+        };
+
+        if ( options.source )
+        {
+            for ( const auto& region : options.source->get_regions( start, end ) )
+            {
+                if ( region.state == win::region_state_t::commit_t &&
+                     ( region.type == win::region_type_t::private_t || region.type == win::region_type_t::image_t ) &&
+                     !( region.protect & PAGE_GUARD || region.protect == PAGE_NOACCESS ) )
+                    visit( region.start, region.end );
+            }
+
+            return;
+        }
+
+        auto start_address = start;
 
         while ( const auto info = win::memapi::virtual_query_ex( options.handle, start_address ) )
         {
-            if ( start_address > options.end || !info->RegionSize )
+            if ( start_address >= end || !info->RegionSize )
                 break;
 
             const auto base_address = reinterpret_cast< std::uintptr_t >( info->BaseAddress );
+            const auto end_address = base_address + info->RegionSize;
 
             if ( info->State == MEM_COMMIT && ( info->Type == MEM_PRIVATE || info->Type == MEM_IMAGE ) &&
                  !( info->Protect & PAGE_GUARD || info->Protect == PAGE_NOACCESS ) )
+                visit( base_address, end_address );
+
+            start_address = end_address;
+        }
+    }
+
+    template< typename container_t >
+    void scanner::scan( const pattern_t& pattern, container_t& addresses ) const
+    {
+        if ( pattern.bytes.empty() )
+            return;
+
+        scratch.reset();
+
+        // Regions are read in chunks that overlap by the pattern length, so a match straddling two chunks is still seen
+        // exactly once. Instruction-aligned scans overlap by at least an instruction, so the instruction under every
+        // match can be decoded from the chunk the match is reported in.
+        auto overlap = pattern.bytes.size() - 1;
+
+        if ( options.instruction_aligned )
+            overlap = std::max( overlap, x64::max_instruction_length );
+
+        const auto chunk_size = std::max( options.read_size, overlap + 1 );
+
+        const auto buffer = static_cast< std::uint8_t* >( scratch.allocate( chunk_size, arena::min_alignment ) );
+
+        for_each_region( [ & ]( std::uintptr_t base_address, std::uintptr_t end_address ) {
+            // Where the next instruction starts, decoding linearly from the start of the region.
+            auto boundary = base_address;
+
+            for ( auto address = base_address; address < end_address; )
             {
-                const auto page = win::memapi::read_process_memory( options.handle, base_address, info->RegionSize );
+                const auto wanted = std::min( chunk_size, end_address - address );
+
+                auto length = wanted;
+                const auto data = fetch( address, buffer, length );
+
+                const auto last = address + length == end_address || length < wanted;
+
+                // Matches starting in the overlap are left to the next chunk.
+                const auto limit = last ? address + length : address + length - overlap;
+
+                for ( const auto index : pattern.find_matches( data, length, &scratch ) )
+                {
+                    const auto match = address + index;
+
+                    if ( match >= limit )
+                        continue;
 
-                for ( const auto& index : pattern.find_matches( page ) )
-                    addresses.push_back( index + base_address + 1 );
+                    if ( options.instruction_aligned )
+                    {
+                        while ( boundary < match )
+                            boundary += instruction_length( data + ( boundary - address ), address + length - boundary );
+
+                        if ( boundary != match )
+                            continue;
+                    }
+
+                    addresses.push_back( match );
+                }
+
+                if ( last )
+                    break;
+
+                if ( options.instruction_aligned )
+                {
+                    while ( boundary < limit )
+                        boundary += instruction_length( data + ( boundary - address ), address + length - boundary );
+                }
+
+                address += length - overlap;
             }
+        } );
+    }
+
+    std::unique_ptr< scanner > scanner_pool::take( const scanner_options_t& options )
+    {
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+
+            if ( !idle.empty() )
+            {
+                auto kept = std::move( idle.back() );
+                idle.pop_back();
+
+                // The arena keeps the page kind it was created with, and grows as larger reads need.
+                kept->options = options;
 
-            start_address = base_address + info->RegionSize;
+                return kept;
+            }
         }
 
-        return addresses;
+        return std::make_unique< scanner >( options );
+    }
+
+    void scanner_pool::give_back( std::unique_ptr< scanner > kept )
+    {
+        std::lock_guard< std::mutex > lock( mutex );
+
+        idle.push_back( std::move( kept ) );
+    }
+
+    std::size_t scanner::instruction_length( const std::uint8_t* data, std::size_t size )
+    {
+        // Bytes that do not decode are stepped over one at a time until decoding falls back into step.
+        const auto instruction = x64::decode( data, size );
+
+        return instruction ? instruction->length : 1;
+    }
+
+    const std::uint8_t* scanner::fetch( std::uintptr_t address, std::uint8_t* buffer, std::size_t& length ) const
+    {
+        options.cancellation.throw_if_cancelled();
+
+        if ( !options.source )
+        {
+            win::memapi::read_process_memory( options.handle, address, buffer, length );
+            return buffer;
+        }
+
+        if ( const auto view = options.source->view( address, length ) )
+            return view;
+
+        length = options.source->read( address, buffer, length );
+        return buffer;
     }
 
     pattern_t pattern_t::from_byte_pattern( const std::string_view pattern )
     {
-        std::vector< std::pair< std::uint8_t, bool > > bytes;
+        pattern_t result;
+        result.bytes.reserve( pattern.size() / 2 + 1 );
 
         for ( auto it = pattern.begin(); it != pattern.end(); ++it )
         {
@@ -60,30 +345,32 @@ namespace extlib
                 if ( it_next < pattern.end() && *( it_next ) == '?' )
                 {
                     // A '??' signifies a wildcard byte. These bytes can be of any value.
-                    bytes.push_back( { 0x00, true } );
+                    result.bytes.emplace_back( 0x00, true );
                     ++it;
                 }
                 else
                     // A '?' is a shortcut for empty bytes (0x00).
-                    bytes.push_back( { 0x00, false } );
+                    result.bytes.emplace_back( 0x00, false );
             }
             else
             {
                 if ( it_next == pattern.end() )
                     break;
 
-                const auto byte_str = std::string{ it - 1, ( ++it ) + 1 };
-                const auto byte = static_cast< std::uint8_t >( std::stoul( byte_str, nullptr, 16 ) );
+                const auto byte = static_cast< std::uint8_t >( from_hex_digit( *it ) << 4 | from_hex_digit( *it_next ) );
 
-                bytes.emplace_back( byte, false );
+                result.bytes.emplace_back( byte, false );
+                ++it;
             }
         }
 
-        return { bytes };
+        return result;
     }
 
     pattern_t::pattern_t( const std::string& string )
     {
+        bytes.reserve( string.length() );
+
         for ( std::size_t i = 0; i < string.length(); ++i )
         {
             const auto byte = static_cast< std::uint8_t >( string.at( i ) );
@@ -92,20 +379,68 @@ namespace extlib
         }
     }
 
-    std::vector< std::size_t > pattern_t::find_matches( std::vector< std::uint8_t > page ) const
+    std::vector< std::size_t > pattern_t::find_matches( const std::vector< std::uint8_t >& page ) const
+    {
+        std::vector< std::size_t > match_locations;
+
+        match( page.data(), page.size(), match_locations );
+
+        return match_locations;
+    }
+
+    std::pmr::vector< std::size_t >
+    pattern_t::find_matches( const std::uint8_t* data, std::size_t size, std::pmr::memory_resource* resource ) const
+    {
+        std::pmr::vector< std::size_t > match_locations{ resource };
+
+        match( data, size, match_locations );
+
+        return match_locations;
+    }
+
+    template< typename container_t >
+    void pattern_t::match( const std::uint8_t* data, std::size_t size, container_t& match_locations ) const
     {
-        std::vector< std::uintptr_t > match_locations;
+        const auto length = bytes.size();
+
+        if ( !length || size < length )
+            return;
+
+        // Anchor on the first concrete byte, so `memchr` can skip straight to the candidates.
+        std::size_t anchor = 0;
+
+        while ( anchor < length && bytes[ anchor ].second )
+            ++anchor;
+
+        const auto last = size - length;
+
+        if ( anchor == length )
+        {
+            for ( std::size_t start = 0; start <= last; ++start )
+                match_locations.push_back( start );
+
+            return;
+        }
 
-        for ( std::size_t i = 0; i + bytes.size() < page.size(); )
+        const auto anchor_byte = bytes[ anchor ].first;
+        const auto end = data + last + anchor + 1;
+
+        for ( auto it = data + anchor; it < end; ++it )
         {
+            it = static_cast< const std::uint8_t* >( std::memchr( it, anchor_byte, end - it ) );
+
+            if ( !it )
+                break;
+
+            const auto start = static_cast< std::size_t >( it - data ) - anchor;
+
             bool located = true;
-            std::size_t start = i;
 
-            for ( const auto& [ byte, wildcard ] : bytes )
+            for ( auto i = anchor + 1; i < length; ++i )
             {
-                ++i;
+                const auto& [ byte, wildcard ] = bytes[ i ];
 
-                if ( !wildcard && page[ i ] != byte )
+                if ( !wildcard && data[ start + i ] != byte )
                 {
                     located = false;
                     break;
@@ -115,8 +450,159 @@ namespace extlib
             if ( located )
                 match_locations.push_back( start );
         }
+    }
 
-        return match_locations;
+    detail::anchor_table_t detail::build_anchor_table( const std::vector< const pattern_t* >& patterns )
+    {
+        // Bytes that fill most code and data make poor anchors, so a pattern is anchored on its first other concrete
+        // byte when it has one.
+        const auto is_common = []( std::uint8_t byte ) {
+            return byte == 0x00 || byte == 0xFF || byte == 0xCC || byte == 0x48 || byte == 0x8B || byte == 0x89;
+        };
+
+        anchor_table_t table;
+        std::vector< std::pair< std::uint8_t, pattern_anchor_t > > anchored;
+
+        for ( std::size_t i = 0; i < patterns.size(); ++i )
+        {
+            const auto& bytes = patterns[ i ]->bytes;
+
+            std::optional< std::size_t > anchor;
+
+            for ( std::size_t j = 0; j < bytes.size(); ++j )
+            {
+                if ( bytes[ j ].second )
+                    continue;
+
+                if ( !anchor )
+                    anchor = j;
+
+                if ( !is_common( bytes[ j ].first ) )
+                {
+                    anchor = j;
+                    break;
+                }
+            }
+
+            if ( !bytes.empty() && !anchor )
+                table.unanchored.push_back( static_cast< std::uint32_t >( i ) );
+            else if ( anchor )
+            {
+                const pattern_anchor_t entry{ static_cast< std::uint32_t >( i ), static_cast< std::uint32_t >( *anchor ) };
+                anchored.emplace_back( bytes[ *anchor ].first, entry );
+            }
+        }
+
+        std::stable_sort( anchored.begin(), anchored.end(), []( const auto& lhs, const auto& rhs ) {
+            return lhs.first < rhs.first;
+        } );
+
+        table.anchors.reserve( anchored.size() );
+
+        for ( const auto& [ byte, anchor ] : anchored )
+        {
+            ++table.first[ byte + 1 ];
+            table.anchors.push_back( anchor );
+        }
+
+        for ( std::size_t i = 1; i < 257; ++i )
+            table.first[ i ] += table.first[ i - 1 ];
+
+        return table;
+    }
+
+    pattern_set::pattern_set( std::vector< pattern_t > patterns ) : patterns( std::move( patterns ) )
+    {
+        std::vector< const pattern_t* > members;
+
+        for ( const auto& pattern : this->patterns )
+        {
+            longest = std::max( longest, pattern.bytes.size() );
+            members.push_back( &pattern );
+        }
+
+        auto table = detail::build_anchor_table( members );
+
+        anchors = std::move( table.anchors );
+        unanchored = std::move( table.unanchored );
+        std::copy( std::begin( table.first ), std::end( table.first ), std::begin( first ) );
+    }
+
+    const std::vector< pattern_t >& pattern_set::get_patterns() const
+    {
+        return patterns;
+    }
+
+    std::size_t pattern_set::max_length() const
+    {
+        return longest;
+    }
+
+    void pattern_set::find_matches( const std::uint8_t* data, std::size_t size, std::vector< match_t >& matches ) const
+    {
+        const auto begin = matches.size();
+
+        for ( std::size_t i = 0; i < size; ++i )
+        {
+            const auto byte = data[ i ];
+
+            for ( auto j = first[ byte ]; j < first[ byte + 1 ]; ++j )
+            {
+                const auto [ index, offset ] = anchors[ j ];
+                const auto& bytes = patterns[ index ].bytes;
+
+                if ( i < offset || i - offset + bytes.size() > size )
+                    continue;
+
+                const auto start = i - offset;
+
+                bool located = true;
+
+                for ( std::size_t k = 0; k < bytes.size(); ++k )
+                {
+                    if ( !bytes[ k ].second && data[ start + k ] != bytes[ k ].first )
+                    {
+                        located = false;
+                        break;
+                    }
+                }
+
+                if ( located )
+                    matches.push_back( { index, start } );
+            }
+        }
+
+        for ( const auto index : unanchored )
+        {
+            const auto length = patterns[ index ].bytes.size();
+
+            for ( std::size_t start = 0; start + length <= size; ++start )
+                matches.push_back( { index, start } );
+        }
+
+        // Matches are found by their anchor, which is not always their first byte.
+        std::stable_sort( matches.begin() + begin, matches.end(), []( const match_t& lhs, const match_t& rhs ) {
+            return lhs.offset < rhs.offset;
+        } );
+    }
+
+    void scan_cache::clear()
+    {
+        pages.clear();
+        pattern.clear();
+
+        reused = 0;
+        matched = 0;
+    }
+
+    std::size_t scan_cache::pages_reused() const
+    {
+        return reused;
+    }
+
+    std::size_t scan_cache::pages_matched() const
+    {
+        return matched;
     }
 
     scanner_options_t::scanner_options_t( std::uintptr_t start, std::uintptr_t end, win::handle_t handle )
@@ -135,7 +621,8 @@ namespace extlib
         : start( section.start ),
           end( section.end ),
           handle( section.current_module.handle ),
-          size( end - start )
+          size( end - start ),
+          source( section.current_module.source.get() )
     {
     }
 
@@ -143,7 +630,17 @@ namespace extlib
         : start( current.start ),
           end( current.end ),
           handle( current.handle ),
-          size( end - start )
+          size( end - start ),
+          source( current.source.get() )
+    {
+    }
+
+    scanner_options_t::scanner_options_t( const memory_source& source, std::uintptr_t start, std::uintptr_t end )
+        : start( start ),
+          end( end ),
+          handle( nullptr ),
+          size( end - start ),
+          source( &source )
     {
     }
 
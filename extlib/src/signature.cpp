@@ -0,0 +1,274 @@
+#include "signature.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "thread_pool.hpp"
+#include "x64.hpp"
+
+namespace extlib
+{
+    namespace
+    {
+        /// <summary>
+        /// The length of the grams the image is indexed by.
+        /// </summary>
+        constexpr std::size_t gram_length = 3;
+    }  // namespace
+
+    signature_generator::signature_generator( const win::module_t& module )
+        : base( module.start ),
+          image( module.read_image() )
+    {
+        relocated.resize( image.size() );
+
+        for ( const auto& relocation : module.get_relocations() )
+        {
+            for ( auto i = relocation.rva; i < relocation.rva + relocation.size && i < image.size(); ++i )
+                relocated[ i ] = true;
+        }
+
+        // Size the index so buckets hold a few positions each on average, without letting it outgrow the image.
+        bucket_bits = 10;
+
+        while ( bucket_bits < 22 && ( std::size_t{ 1 } << bucket_bits ) < image.size() / 4 )
+            ++bucket_bits;
+
+        offsets.assign( ( std::size_t{ 1 } << bucket_bits ) + 1, 0 );
+
+        if ( image.size() < gram_length )
+            return;
+
+        const auto grams = image.size() - gram_length + 1;
+
+        for ( std::size_t i = 0; i < grams; ++i )
+            ++offsets[ bucket( image.data() + i ) + 1 ];
+
+        for ( std::size_t i = 1; i < offsets.size(); ++i )
+            offsets[ i ] += offsets[ i - 1 ];
+
+        positions.resize( grams );
+
+        auto next = offsets;
+
+        for ( std::size_t i = 0; i < grams; ++i )
+            positions[ next[ bucket( image.data() + i ) ]++ ] = static_cast< std::uint32_t >( i );
+    }
+
+    std::optional< std::string >
+    signature_generator::generate( std::uintptr_t address, const signature_options_t& options ) const
+    {
+        if ( address < base || address - base >= image.size() )
+            return std::nullopt;
+
+        const auto offset = address - base;
+        const auto length = std::min( options.max_length, image.size() - offset );
+
+        auto wildcards = options.wildcard_volatile ? find_volatile( offset, length ) : std::vector< bool >( length );
+
+        // Anchor on the first gram without wildcards, and collect every other place in the image it occurs.
+        std::size_t anchor = 0;
+
+        while ( anchor + gram_length <= length &&
+                std::any_of( wildcards.begin() + anchor, wildcards.begin() + anchor + gram_length, []( bool wild ) {
+                    return wild;
+                } ) )
+            ++anchor;
+
+        if ( anchor + gram_length > length )
+            return std::nullopt;
+
+        const auto gram = image.data() + offset + anchor;
+        const auto [ first, last ] = candidates( gram );
+
+        std::vector< std::size_t > matches;
+
+        for ( auto it = first; it != last; ++it )
+        {
+            if ( *it >= anchor && std::memcmp( image.data() + *it, gram, gram_length ) == 0 )
+                matches.push_back( *it - anchor );
+        }
+
+        // The concrete bytes before the anchor are part of the signature too, so matches must agree with them.
+        for ( std::size_t i = 0; i < anchor && matches.size() > 1; ++i )
+        {
+            if ( wildcards[ i ] )
+                continue;
+
+            const auto byte = image[ offset + i ];
+
+            matches.erase( std::remove_if( matches.begin(), matches.end(), [ & ]( std::size_t match ) {
+                               return match + i >= image.size() || image[ match + i ] != byte;
+                           } ),
+                           matches.end() );
+        }
+
+        // Grow the signature one byte at a time, keeping only the matches that agree with it so far. The address
+        // itself always matches, so a single match left means the signature is unique.
+        auto size = anchor + gram_length;
+
+        while ( matches.size() > 1 && size < length )
+        {
+            if ( !wildcards[ size ] )
+            {
+                const auto byte = image[ offset + size ];
+
+                matches.erase( std::remove_if( matches.begin(), matches.end(), [ & ]( std::size_t match ) {
+                                   return match + size >= image.size() || image[ match + size ] != byte;
+                               } ),
+                               matches.end() );
+            }
+
+            ++size;
+        }
+
+        if ( matches.size() > 1 )
+            return std::nullopt;
+
+        static constexpr char digits[] = "0123456789ABCDEF";
+
+        std::string signature;
+        signature.reserve( size * 3 );
+
+        for ( std::size_t i = 0; i < size; ++i )
+        {
+            if ( i )
+                signature.push_back( ' ' );
+
+            if ( wildcards[ i ] )
+                signature.append( "??" );
+            else
+            {
+                signature.push_back( digits[ image[ offset + i ] >> 4 ] );
+                signature.push_back( digits[ image[ offset + i ] & 0xF ] );
+            }
+        }
+
+        return signature;
+    }
+
+    std::vector< std::optional< std::string > > signature_generator::generate(
+        const std::vector< std::uintptr_t >& addresses,
+        const signature_options_t& options ) const
+    {
+        std::vector< std::optional< std::string > > signatures( addresses.size() );
+
+        thread_pool::shared().parallel_for( addresses.size(), [ & ]( std::size_t index ) {
+            signatures[ index ] = generate( addresses[ index ], options );
+        } );
+
+        return signatures;
+    }
+
+    std::size_t signature_generator::count( const pattern_t& pattern, std::size_t limit ) const
+    {
+        const auto& bytes = pattern.bytes;
+
+        if ( bytes.empty() || bytes.size() > image.size() )
+            return 0;
+
+        std::size_t anchor = 0;
+
+        while ( anchor + gram_length <= bytes.size() &&
+                std::any_of( bytes.begin() + anchor, bytes.begin() + anchor + gram_length, []( const auto& byte ) {
+                    return byte.second;
+                } ) )
+            ++anchor;
+
+        // Patterns too short or too sparse to hold a gram fall back to a plain scan of the image.
+        if ( anchor + gram_length > bytes.size() )
+        {
+            const auto matches = pattern.find_matches( image.data(), image.size(), std::pmr::get_default_resource() );
+            return std::min( matches.size(), limit );
+        }
+
+        std::uint8_t gram[ gram_length ];
+
+        for ( std::size_t i = 0; i < gram_length; ++i )
+            gram[ i ] = bytes[ anchor + i ].first;
+
+        const auto [ first, last ] = candidates( gram );
+
+        std::size_t found = 0;
+
+        for ( auto it = first; it != last && found < limit; ++it )
+        {
+            if ( *it < anchor || *it - anchor + bytes.size() > image.size() )
+                continue;
+
+            const auto data = image.data() + ( *it - anchor );
+
+            bool located = true;
+
+            for ( std::size_t i = 0; i < bytes.size(); ++i )
+            {
+                if ( !bytes[ i ].second && data[ i ] != bytes[ i ].first )
+                {
+                    located = false;
+                    break;
+                }
+            }
+
+            if ( located )
+                ++found;
+        }
+
+        return found;
+    }
+
+    std::vector< bool > signature_generator::find_volatile( std::size_t offset, std::size_t length ) const
+    {
+        std::vector< bool > wildcards( length );
+
+        const auto data = image.data() + offset;
+
+        const auto mark = [ & ]( std::size_t start, std::size_t size ) {
+            for ( auto i = start; i < start + size && i < length; ++i )
+                wildcards[ i ] = true;
+        };
+
+        for ( std::size_t i = 0; i < length; ++i )
+        {
+            if ( relocated[ offset + i ] )
+                wildcards[ i ] = true;
+        }
+
+        // The address is taken to be the start of an instruction, and the instructions from there on are decoded to
+        // find their RIP-relative displacements and rel32 branch targets.
+        for ( std::size_t i = 0; i < length; )
+        {
+            const auto instruction = x64::decode( data + i, image.size() - offset - i );
+
+            if ( !instruction )
+            {
+                ++i;
+                continue;
+            }
+
+            if ( instruction->rip_relative )
+                mark( i + instruction->displacement_offset, instruction->displacement_size );
+
+            if ( instruction->relative_branch && instruction->immediate_size == sizeof( std::int32_t ) )
+                mark( i + instruction->immediate_offset, instruction->immediate_size );
+
+            i += instruction->length;
+        }
+
+        return wildcards;
+    }
+
+    std::pair< const std::uint32_t*, const std::uint32_t* >
+    signature_generator::candidates( const std::uint8_t* data ) const
+    {
+        const auto index = bucket( data );
+
+        return { positions.data() + offsets[ index ], positions.data() + offsets[ index + 1 ] };
+    }
+
+    std::size_t signature_generator::bucket( const std::uint8_t* data ) const
+    {
+        const auto gram = static_cast< std::uint32_t >( data[ 0 ] | data[ 1 ] << 8 | data[ 2 ] << 16 );
+
+        return ( gram * 0x9E3779B1u ) >> ( 32 - bucket_bits );
+    }
+}  // namespace extlib
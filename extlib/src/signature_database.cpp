@@ -0,0 +1,725 @@
+#include "signature_database.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "file_format.hpp"
+#include "scan.hpp"
+
+namespace extlib
+{
+    namespace
+    {
+        using namespace signature_database_format;
+
+        /// <summary>
+        /// A signature as written in the text of a database.
+        /// </summary>
+        struct entry_t
+        {
+            std::string name, module, section;
+            pattern_t pattern;
+            std::vector< operation_t > operations{};
+
+            std::uint32_t group = 0;
+        };
+
+        [[noreturn]] void fail( std::size_t line, const std::string& reason )
+        {
+            std::stringstream msg;
+            msg << "Failed to compile signature database: line " << line << ": " << reason;
+            throw std::runtime_error( msg.str() );
+        }
+
+        [[noreturn]] void corrupt( const std::string& origin, const char* reason )
+        {
+            detail::throw_corrupt( origin, "signature database", reason );
+        }
+
+        std::string_view trim( std::string_view text )
+        {
+            while ( !text.empty() && std::isspace( static_cast< unsigned char >( text.front() ) ) )
+                text.remove_prefix( 1 );
+
+            while ( !text.empty() && std::isspace( static_cast< unsigned char >( text.back() ) ) )
+                text.remove_suffix( 1 );
+
+            return text;
+        }
+
+        std::vector< std::string_view > split( std::string_view text )
+        {
+            std::vector< std::string_view > tokens;
+
+            while ( !( text = trim( text ) ).empty() )
+            {
+                std::size_t length = 0;
+
+                while ( length < text.size() && !std::isspace( static_cast< unsigned char >( text[ length ] ) ) )
+                    ++length;
+
+                tokens.push_back( text.substr( 0, length ) );
+                text.remove_prefix( length );
+            }
+
+            return tokens;
+        }
+
+        std::int64_t parse_number( std::string_view token, std::size_t line )
+        {
+            const std::string text( token );
+
+            try
+            {
+                std::size_t used = 0;
+                const auto value = std::stoll( text, &used, 0 );
+
+                if ( used == text.size() )
+                    return value;
+            }
+            catch ( const std::exception& )
+            {
+            }
+
+            fail( line, "'" + text + "' is not a number" );
+        }
+
+        bool is_pattern_byte( std::string_view token )
+        {
+            if ( token == "?" || token == "??" )
+                return true;
+
+            return token.size() == 2 && std::isxdigit( static_cast< unsigned char >( token[ 0 ] ) ) &&
+                   std::isxdigit( static_cast< unsigned char >( token[ 1 ] ) );
+        }
+
+        operation_t parse_operation( std::string_view text, std::size_t line )
+        {
+            const auto tokens = split( text );
+
+            if ( tokens.empty() )
+                fail( line, "an operation is empty" );
+
+            const auto expect = [ & ]( std::size_t least, std::size_t most ) {
+                if ( tokens.size() < least + 1 || tokens.size() > most + 1 )
+                    fail( line, "'" + std::string( tokens[ 0 ] ) + "' takes the wrong number of operands" );
+            };
+
+            operation_t operation{};
+
+            if ( tokens[ 0 ] == "add" )
+            {
+                expect( 1, 1 );
+
+                operation.kind = operation_kind_t::add;
+                operation.operand = parse_number( tokens[ 1 ], line );
+            }
+            else if ( tokens[ 0 ] == "rel32" )
+            {
+                expect( 1, 2 );
+
+                operation.kind = operation_kind_t::rel32;
+                operation.operand = parse_number( tokens[ 1 ], line );
+                operation.length = tokens.size() > 2 ? parse_number( tokens[ 2 ], line ) : operation.operand + 4;
+
+                if ( operation.operand < 0 || operation.length < operation.operand + 4 )
+                    fail( line, "the displacement of 'rel32' must lie within the instruction" );
+            }
+            else if ( tokens[ 0 ] == "deref" )
+            {
+                expect( 0, 0 );
+
+                operation.kind = operation_kind_t::deref;
+            }
+            else
+                fail( line, "'" + std::string( tokens[ 0 ] ) + "' is not an operation" );
+
+            return operation;
+        }
+
+        std::vector< entry_t > parse_entries( std::string_view source )
+        {
+            std::vector< entry_t > entries;
+            std::unordered_map< std::string, std::size_t > lines;
+
+            for ( std::size_t line = 1; !source.empty(); ++line )
+            {
+                const auto end = std::min( source.find( '\n' ), source.size() );
+                auto text = source.substr( 0, end );
+
+                source.remove_prefix( std::min( end + 1, source.size() ) );
+                text = trim( text.substr( 0, text.find( '#' ) ) );
+
+                if ( text.empty() )
+                    continue;
+
+                const auto bar = std::min( text.find( '|' ), text.size() );
+                const auto tokens = split( text.substr( 0, bar ) );
+
+                if ( tokens.size() < 4 )
+                    fail( line, "a signature needs a name, a module, a section and a pattern" );
+
+                entry_t entry{ std::string( tokens[ 0 ] ),
+                               std::string( tokens[ 1 ] ),
+                               std::string( tokens[ 2 ] ),
+                               pattern_t::from_byte_pattern( "" ),
+                               {},
+                               0 };
+
+                std::string pattern;
+
+                for ( std::size_t i = 3; i < tokens.size(); ++i )
+                {
+                    if ( !is_pattern_byte( tokens[ i ] ) )
+                        fail( line, "'" + std::string( tokens[ i ] ) + "' is not a pattern byte" );
+
+                    pattern.append( tokens[ i ] ).push_back( ' ' );
+                }
+
+                entry.pattern = pattern_t::from_byte_pattern( pattern );
+
+                const auto& bytes = entry.pattern.bytes;
+
+                if ( std::all_of( bytes.begin(), bytes.end(), []( const auto& byte ) { return byte.second; } ) )
+                    fail( line, "a pattern needs at least one byte that is not a wildcard" );
+
+                for ( auto rest = text.substr( bar ); !rest.empty(); )
+                {
+                    rest.remove_prefix( 1 );
+
+                    const auto next = std::min( rest.find( '|' ), rest.size() );
+                    entry.operations.push_back( parse_operation( rest.substr( 0, next ), line ) );
+                    rest.remove_prefix( next );
+                }
+
+                if ( const auto [ it, inserted ] = lines.emplace( entry.name, line ); !inserted )
+                    fail( line, "'" + entry.name + "' is already defined on line " + std::to_string( it->second ) );
+
+                entries.push_back( std::move( entry ) );
+            }
+
+            return entries;
+        }
+
+        bool equals_ignoring_case( std::string_view left, std::string_view right )
+        {
+            return left.size() == right.size() &&
+                   std::equal( left.begin(), left.end(), right.begin(), []( char a, char b ) {
+                       return std::tolower( static_cast< unsigned char >( a ) ) ==
+                              std::tolower( static_cast< unsigned char >( b ) );
+                   } );
+        }
+    }  // namespace
+
+    const signature_result_t* signature_report_t::find( std::string_view name ) const
+    {
+        for ( const auto& result : results )
+        {
+            if ( result.name == name )
+                return &result;
+        }
+
+        return nullptr;
+    }
+
+    std::size_t signature_report_t::resolved_count() const
+    {
+        return static_cast< std::size_t >( std::count_if( results.begin(), results.end(), []( const auto& result ) {
+            return result.status == signature_status_t::resolved;
+        } ) );
+    }
+
+    std::vector< std::uint8_t > signature_database::compile( std::string_view source )
+    {
+        auto entries = parse_entries( source );
+
+        // Signatures keep the order they were written in, and are grouped by where they are searched.
+        std::vector< std::pair< std::string, std::string > > places;
+
+        for ( auto& entry : entries )
+        {
+            const auto place = std::make_pair( entry.module, entry.section );
+            const auto it = std::find( places.begin(), places.end(), place );
+
+            entry.group = static_cast< std::uint32_t >( it - places.begin() );
+
+            if ( it == places.end() )
+                places.push_back( place );
+        }
+
+        std::vector< signature_t > signatures;
+        std::vector< group_t > groups( places.size() );
+        std::vector< anchor_t > anchors;
+        std::vector< operation_t > operations;
+        std::vector< std::uint8_t > values, masks;
+        std::string strings;
+
+        const auto add_string = [ &strings ]( const std::string& value ) {
+            strings += value;
+            return std::make_pair( std::uint64_t{ strings.size() - value.size() }, std::uint64_t{ value.size() } );
+        };
+
+        for ( const auto& entry : entries )
+        {
+            signature_t signature{};
+
+            std::tie( signature.name_offset, signature.name_size ) = add_string( entry.name );
+
+            signature.pattern_offset = values.size();
+            signature.pattern_size = entry.pattern.bytes.size();
+            signature.first_operation = static_cast< std::uint32_t >( operations.size() );
+            signature.operation_count = static_cast< std::uint32_t >( entry.operations.size() );
+            signature.group = entry.group;
+
+            // Wildcards are masked out, so a byte matches when its masked value equals the pattern's.
+            for ( const auto& [ byte, wildcard ] : entry.pattern.bytes )
+            {
+                values.push_back( wildcard ? 0x00 : byte );
+                masks.push_back( wildcard ? 0x00 : 0xFF );
+            }
+
+            operations.insert( operations.end(), entry.operations.begin(), entry.operations.end() );
+            signatures.push_back( signature );
+        }
+
+        for ( std::uint32_t i = 0; i < groups.size(); ++i )
+        {
+            auto& group = groups[ i ];
+
+            std::tie( group.module_offset, group.module_size ) = add_string( places[ i ].first );
+            std::tie( group.section_offset, group.section_size ) = add_string( places[ i ].second );
+
+            group.first_anchor = static_cast< std::uint32_t >( anchors.size() );
+
+            // The group's anchors are chosen and bucketed as `pattern_set` does, with the group's own indices mapped
+            // back onto the signature table.
+            std::vector< std::uint32_t > members;
+            std::vector< const pattern_t* > patterns;
+
+            for ( std::uint32_t j = 0; j < entries.size(); ++j )
+            {
+                const auto& entry = entries[ j ];
+
+                if ( entry.group != i )
+                    continue;
+
+                group.longest = std::max( group.longest, static_cast< std::uint32_t >( entry.pattern.bytes.size() ) );
+
+                members.push_back( j );
+                patterns.push_back( &entry.pattern );
+            }
+
+            const auto table = detail::build_anchor_table( patterns );
+
+            for ( const auto& [ member, offset ] : table.anchors )
+                anchors.push_back( { members[ member ], offset } );
+
+            std::copy( std::begin( table.first ), std::end( table.first ), std::begin( group.buckets ) );
+
+            group.anchor_count = static_cast< std::uint32_t >( table.anchors.size() );
+        }
+
+        header_t header{};
+
+        header.magic = magic;
+        header.version = version;
+        header.signature_count = signatures.size();
+        header.group_count = groups.size();
+        header.anchor_count = anchors.size();
+        header.operation_count = operations.size();
+        header.pattern_size = values.size();
+        header.string_size = strings.size();
+        header.signature_offset = detail::align8( sizeof( header ) );
+        header.group_offset = detail::align8( header.signature_offset + signatures.size() * sizeof( signature_t ) );
+        header.anchor_offset = detail::align8( header.group_offset + groups.size() * sizeof( group_t ) );
+        header.operation_offset = detail::align8( header.anchor_offset + anchors.size() * sizeof( anchor_t ) );
+        header.value_offset = detail::align8( header.operation_offset + operations.size() * sizeof( operation_t ) );
+        header.mask_offset = detail::align8( header.value_offset + values.size() );
+        header.string_offset = detail::align8( header.mask_offset + masks.size() );
+
+        const auto blob_size = detail::align8( header.string_offset + strings.size() );
+        std::vector< std::uint8_t > blob( static_cast< std::size_t >( blob_size ) );
+
+        const auto write_at = [ &blob ]( std::uint64_t offset, const void* data, std::size_t size ) {
+            if ( size )
+                std::memcpy( blob.data() + offset, data, size );
+        };
+
+        write_at( 0, &header, sizeof( header ) );
+        write_at( header.signature_offset, signatures.data(), signatures.size() * sizeof( signature_t ) );
+        write_at( header.group_offset, groups.data(), groups.size() * sizeof( group_t ) );
+        write_at( header.anchor_offset, anchors.data(), anchors.size() * sizeof( anchor_t ) );
+        write_at( header.operation_offset, operations.data(), operations.size() * sizeof( operation_t ) );
+        write_at( header.value_offset, values.data(), values.size() );
+        write_at( header.mask_offset, masks.data(), masks.size() );
+        write_at( header.string_offset, strings.data(), strings.size() );
+
+        return blob;
+    }
+
+    signature_database signature_database::parse( std::string_view source )
+    {
+        const auto blob = compile( source );
+
+        // The blob is copied into 8 byte words, so its tables are as aligned as those of a mapped file.
+        signature_database database;
+        database.owned.resize( blob.size() / sizeof( std::uint64_t ) );
+        std::memcpy( database.owned.data(), blob.data(), blob.size() );
+
+        database.attach( reinterpret_cast< const std::uint8_t* >( database.owned.data() ), blob.size(), "the source" );
+
+        return database;
+    }
+
+    signature_database signature_database::load( const std::filesystem::path& path )
+    {
+        signature_database database;
+        database.file = std::make_unique< win::mapped_file >( path );
+
+        database.attach( database.file->data(), database.file->size(), "'" + path.string() + "'" );
+
+        return database;
+    }
+
+    void signature_database::attach( const std::uint8_t* data, std::size_t size, const std::string& origin )
+    {
+        if ( size < sizeof( header_t ) )
+            corrupt( origin, "the blob is too small" );
+
+        header_t header;
+        std::memcpy( &header, data, sizeof( header ) );
+
+        if ( header.magic != magic )
+            corrupt( origin, "the magic does not match" );
+
+        if ( header.version != version )
+            corrupt( origin, "the version is not supported" );
+
+        if ( !detail::table_fits( header.signature_offset, header.signature_count, sizeof( signature_t ), size ) ||
+             !detail::table_fits( header.group_offset, header.group_count, sizeof( group_t ), size ) ||
+             !detail::table_fits( header.anchor_offset, header.anchor_count, sizeof( anchor_t ), size ) ||
+             !detail::table_fits( header.operation_offset, header.operation_count, sizeof( operation_t ), size ) ||
+             !detail::table_fits( header.value_offset, header.pattern_size, 1, size ) ||
+             !detail::table_fits( header.mask_offset, header.pattern_size, 1, size ) ||
+             !detail::table_fits( header.string_offset, header.string_size, 1, size ) )
+            corrupt( origin, "a table lies outside the blob" );
+
+        signatures = detail::table_at< signature_t >( data, header.signature_offset );
+        groups = detail::table_at< group_t >( data, header.group_offset );
+        anchors = detail::table_at< anchor_t >( data, header.anchor_offset );
+        operations = detail::table_at< operation_t >( data, header.operation_offset );
+        values = data + header.value_offset;
+        masks = data + header.mask_offset;
+        strings = detail::table_at< char >( data, header.string_offset );
+
+        signature_count = static_cast< std::size_t >( header.signature_count );
+        group_count = static_cast< std::size_t >( header.group_count );
+
+        const auto inside = []( std::uint64_t first, std::uint64_t count, std::uint64_t total ) {
+            return first <= total && count <= total - first;
+        };
+
+        // Matching follows the ranges in the tables without checking them, so they must not point past them.
+        for ( std::size_t i = 0; i < signature_count; ++i )
+        {
+            const auto& signature = signatures[ i ];
+
+            if ( !inside( signature.name_offset, signature.name_size, header.string_size ) ||
+                 !inside( signature.pattern_offset, signature.pattern_size, header.pattern_size ) ||
+                 !inside( signature.first_operation, signature.operation_count, header.operation_count ) ||
+                 signature.group >= group_count )
+                corrupt( origin, "a signature lies outside the tables" );
+        }
+
+        for ( std::size_t i = 0; i < header.operation_count; ++i )
+        {
+            if ( operations[ i ].kind > operation_kind_t::deref )
+                corrupt( origin, "an operation is not known" );
+        }
+
+        for ( std::size_t i = 0; i < group_count; ++i )
+        {
+            const auto& group = groups[ i ];
+
+            if ( !inside( group.module_offset, group.module_size, header.string_size ) ||
+                 !inside( group.section_offset, group.section_size, header.string_size ) ||
+                 !inside( group.first_anchor, group.anchor_count, header.anchor_count ) )
+                corrupt( origin, "a group lies outside the tables" );
+
+            for ( std::size_t j = 0; j < 256; ++j )
+            {
+                if ( group.buckets[ j ] > group.buckets[ j + 1 ] )
+                    corrupt( origin, "a group's anchors are out of order" );
+            }
+
+            if ( group.buckets[ 256 ] != group.anchor_count )
+                corrupt( origin, "a group's anchors are out of order" );
+
+            for ( std::size_t j = group.first_anchor; j < group.first_anchor + group.anchor_count; ++j )
+            {
+                const auto& anchor = anchors[ j ];
+
+                if ( anchor.signature >= signature_count || signatures[ anchor.signature ].group != i ||
+                     anchor.offset >= signatures[ anchor.signature ].pattern_size ||
+                     signatures[ anchor.signature ].pattern_size > group.longest )
+                    corrupt( origin, "an anchor does not belong to its group" );
+            }
+        }
+    }
+
+    signature_report_t signature_database::resolve( const std::vector< win::module_t >& modules ) const
+    {
+        using clock = std::chrono::steady_clock;
+
+        const auto start = clock::now();
+
+        signature_report_t report{};
+        report.results.resize( signature_count );
+
+        std::vector< std::vector< std::size_t > > members( group_count );
+
+        for ( std::size_t i = 0; i < signature_count; ++i )
+        {
+            report.results[ i ].name = get_name( i );
+            members[ signatures[ i ].group ].push_back( i );
+        }
+
+        // Names of modules backed by a memory source may not be known to it, in which case no signature names them.
+        std::vector< std::string > names;
+
+        for ( const auto& module : modules )
+        {
+            try
+            {
+                names.push_back( module.get_name() );
+            }
+            catch ( const std::exception& )
+            {
+                names.emplace_back();
+            }
+        }
+
+        std::vector< std::size_t > counts( signature_count ), firsts( signature_count );
+
+        for ( std::size_t i = 0; i < group_count; ++i )
+        {
+            const auto& group = groups[ i ];
+            const auto module_name = get_string( group.module_offset, group.module_size );
+            const auto section_name = get_string( group.section_offset, group.section_size );
+
+            const auto set_status = [ & ]( signature_status_t status ) {
+                for ( const auto signature : members[ i ] )
+                    report.results[ signature ].status = status;
+            };
+
+            const win::module_t* module = nullptr;
+
+            for ( std::size_t j = 0; j < modules.size() && !module; ++j )
+            {
+                if ( module_name == "*" || equals_ignoring_case( names[ j ], module_name ) )
+                    module = &modules[ j ];
+            }
+
+            if ( !module )
+            {
+                set_status( signature_status_t::missing_module );
+                continue;
+            }
+
+            const auto scan_start = clock::now();
+
+            std::uintptr_t base = module->start;
+            std::vector< std::uint8_t > bytes;
+
+            try
+            {
+                if ( section_name == "*" )
+                    bytes = module->read_image();
+                else
+                {
+                    const auto sections = module->get_sections();
+                    const auto section = std::find_if( sections.begin(), sections.end(), [ & ]( const auto& section ) {
+                        return std::string_view( section.name.c_str() ) == section_name;
+                    } );
+
+                    if ( section == sections.end() )
+                    {
+                        set_status( signature_status_t::missing_section );
+                        continue;
+                    }
+
+                    base = section->start;
+                    bytes = module->read( section->start, section->size );
+                }
+            }
+            catch ( const std::exception& )
+            {
+                set_status( signature_status_t::unreadable );
+                continue;
+            }
+
+            for ( const auto signature : members[ i ] )
+                counts[ signature ] = 0;
+
+            match( group, bytes.data(), bytes.size(), counts, firsts );
+
+            const auto scan_time = std::chrono::duration_cast< std::chrono::nanoseconds >( clock::now() - scan_start );
+
+            report.scans.push_back(
+                { std::string( module_name ), std::string( section_name ), bytes.size(), members[ i ].size(), scan_time } );
+
+            // Post-processing mostly reads the instruction it matched, which is still in the buffer.
+            const auto read = [ & ]( std::uintptr_t address, void* value, std::size_t size ) {
+                if ( address >= base && address - base <= bytes.size() && bytes.size() - ( address - base ) >= size )
+                    std::memcpy( value, bytes.data() + ( address - base ), size );
+                else
+                {
+                    const auto remote = module->read( address, size );
+                    std::memcpy( value, remote.data(), size );
+                }
+            };
+
+            for ( const auto index : members[ i ] )
+            {
+                const auto resolve_start = clock::now();
+
+                auto& result = report.results[ index ];
+                const auto& signature = signatures[ index ];
+
+                result.match_count = counts[ index ];
+                result.match = result.match_count ? base + firsts[ index ] : 0;
+                result.scan_time = scan_time;
+
+                if ( result.match_count != 1 )
+                    result.status = result.match_count ? signature_status_t::ambiguous : signature_status_t::not_found;
+                else
+                {
+                    auto address = result.match;
+                    result.status = signature_status_t::resolved;
+
+                    try
+                    {
+                        for ( auto j = signature.first_operation; j < signature.first_operation + signature.operation_count;
+                              ++j )
+                        {
+                            const auto& operation = operations[ j ];
+
+                            switch ( operation.kind )
+                            {
+                                case operation_kind_t::add:
+                                    address += operation.operand;
+                                    break;
+                                case operation_kind_t::rel32:
+                                {
+                                    std::int32_t displacement;
+                                    read( address + operation.operand, &displacement, sizeof( displacement ) );
+
+                                    address += operation.length + displacement;
+                                    break;
+                                }
+                                case operation_kind_t::deref:
+                                {
+                                    std::uint64_t pointer;
+                                    read( address, &pointer, sizeof( pointer ) );
+
+                                    address = static_cast< std::uintptr_t >( pointer );
+                                    break;
+                                }
+                            }
+                        }
+
+                        result.address = address;
+                    }
+                    catch ( const std::exception& )
+                    {
+                        result.status = signature_status_t::unreadable;
+                    }
+                }
+
+                result.resolve_time =
+                    std::chrono::duration_cast< std::chrono::nanoseconds >( clock::now() - resolve_start );
+            }
+        }
+
+        report.time = std::chrono::duration_cast< std::chrono::nanoseconds >( clock::now() - start );
+
+        return report;
+    }
+
+    std::size_t signature_database::size() const
+    {
+        return signature_count;
+    }
+
+    std::string_view signature_database::get_name( std::size_t signature ) const
+    {
+        return get_string( signatures[ signature ].name_offset, signatures[ signature ].name_size );
+    }
+
+    std::optional< std::size_t > signature_database::find( std::string_view name ) const
+    {
+        for ( std::size_t i = 0; i < signature_count; ++i )
+        {
+            if ( get_name( i ) == name )
+                return i;
+        }
+
+        return std::nullopt;
+    }
+
+    void signature_database::match(
+        const group_t& group,
+        const std::uint8_t* data,
+        std::size_t size,
+        std::vector< std::size_t >& counts,
+        std::vector< std::size_t >& firsts ) const
+    {
+        const auto group_anchors = anchors + group.first_anchor;
+
+        for ( std::size_t i = 0; i < size; ++i )
+        {
+            const auto byte = data[ i ];
+
+            for ( auto j = group.buckets[ byte ]; j < group.buckets[ byte + 1 ]; ++j )
+            {
+                const auto [ index, offset ] = group_anchors[ j ];
+                const auto& signature = signatures[ index ];
+                const auto length = static_cast< std::size_t >( signature.pattern_size );
+
+                if ( i < offset || i - offset + length > size )
+                    continue;
+
+                const auto start = i - offset;
+                const auto pattern_values = values + signature.pattern_offset;
+                const auto pattern_masks = masks + signature.pattern_offset;
+
+                bool located = true;
+
+                for ( std::size_t k = 0; k < length; ++k )
+                {
+                    if ( ( data[ start + k ] & pattern_masks[ k ] ) != pattern_values[ k ] )
+                    {
+                        located = false;
+                        break;
+                    }
+                }
+
+                // A signature's anchor is at the same offset in all of its matches, so its first match is found first.
+                if ( located && !counts[ index ]++ )
+                    firsts[ index ] = start;
+            }
+        }
+    }
+
+    std::string_view signature_database::get_string( std::uint64_t offset, std::uint64_t size ) const
+    {
+        return std::string_view( strings + offset, static_cast< std::size_t >( size ) );
+    }
+}  // namespace extlib
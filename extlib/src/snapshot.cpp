@@ -0,0 +1,264 @@
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+namespace extlib
+{
+    namespace
+    {
+        /// <summary>
+        /// A range both snapshots hold.
+        /// </summary>
+        struct overlap_t
+        {
+            std::uintptr_t address;
+            const std::uint8_t *before, *after;
+            std::size_t size;
+        };
+
+        /// <summary>
+        /// Reads a little-endian field as a sign-extended value.
+        /// </summary>
+        std::int64_t read_signed( const std::uint8_t* data, std::size_t size )
+        {
+            switch ( size )
+            {
+                case 1: return static_cast< std::int8_t >( data[ 0 ] );
+                case 2:
+                {
+                    std::int16_t value;
+                    std::memcpy( &value, data, sizeof( value ) );
+                    return value;
+                }
+                case 4:
+                {
+                    std::int32_t value;
+                    std::memcpy( &value, data, sizeof( value ) );
+                    return value;
+                }
+                default:
+                {
+                    std::int64_t value;
+                    std::memcpy( &value, data, sizeof( value ) );
+                    return value;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Appends a changed range to a diff, extending the last run if the range directly follows it.
+        /// </summary>
+        void append( snapshot_diff_t& diff, const overlap_t& overlap, std::size_t start, std::size_t end )
+        {
+            const auto address = overlap.address + start;
+
+            if ( diff.runs.empty() || diff.runs.back().address + diff.runs.back().size != address )
+                diff.runs.push_back( { address, 0, diff.old_bytes.size() } );
+
+            diff.runs.back().size += end - start;
+
+            diff.old_bytes.insert( diff.old_bytes.end(), overlap.before + start, overlap.before + end );
+            diff.new_bytes.insert( diff.new_bytes.end(), overlap.after + start, overlap.after + end );
+        }
+
+        /// <summary>
+        /// Computes the changed runs of bytes within an overlap.
+        /// </summary>
+        void diff_bytes( snapshot_diff_t& diff, const overlap_t& overlap )
+        {
+            for ( std::size_t position = 0; position < overlap.size; )
+            {
+                position += simd::mismatch( overlap.before + position, overlap.after + position, overlap.size - position );
+
+                if ( position >= overlap.size )
+                    break;
+
+                const auto remaining = overlap.size - position;
+                const auto end = position + simd::match( overlap.before + position, overlap.after + position, remaining );
+
+                append( diff, overlap, position, end );
+                position = end;
+            }
+        }
+
+        /// <summary>
+        /// Computes the changed, aligned fields within an overlap.
+        /// </summary>
+        void diff_fields(
+            snapshot_diff_t& diff,
+            const overlap_t& overlap,
+            std::size_t field_size,
+            const diff_options_t& options )
+        {
+            const auto first_field = ( ( overlap.address + field_size - 1 ) & ~( field_size - 1 ) ) - overlap.address;
+
+            for ( std::size_t position = first_field; position < overlap.size; )
+            {
+                position += simd::mismatch( overlap.before + position, overlap.after + position, overlap.size - position );
+
+                if ( position >= overlap.size )
+                    break;
+
+                const auto start = ( ( overlap.address + position ) & ~( field_size - 1 ) ) - overlap.address;
+                const auto end = start + field_size;
+
+                if ( end > overlap.size )
+                    break;
+
+                if ( options.changed_by )
+                {
+                    const auto old_value = read_signed( overlap.before + start, field_size );
+                    const auto new_value = read_signed( overlap.after + start, field_size );
+
+                    const auto delta = static_cast< std::int64_t >(
+                        static_cast< std::uint64_t >( new_value ) - static_cast< std::uint64_t >( old_value ) );
+
+                    if ( delta != *options.changed_by )
+                    {
+                        position = end;
+                        continue;
+                    }
+                }
+
+                append( diff, overlap, start, end );
+                position = end;
+            }
+        }
+    }  // namespace
+
+    std::size_t snapshot_diff_t::changed_bytes() const
+    {
+        return old_bytes.size();
+    }
+
+    snapshot snapshot::capture( win::handle_t handle, const std::vector< win::region_t >& regions )
+    {
+        snapshot result;
+
+        for ( const auto& region : regions )
+        {
+            if ( region.state != win::region_state_t::commit_t || region.protect & PAGE_GUARD ||
+                 region.protect == PAGE_NOACCESS )
+                continue;
+
+            result.blocks.push_back( { region.start, std::vector< std::uint8_t >( region.size ) } );
+        }
+
+        thread_pool::shared().parallel_for( result.blocks.size(), [ & ]( std::size_t index ) {
+            auto& block = result.blocks[ index ];
+            std::size_t bytes_read = 0;
+
+            // Called directly rather than through memapi: a region vanishing mid-capture is expected, not exceptional.
+            const auto success = ReadProcessMemory(
+                handle.handle,
+                reinterpret_cast< LPCVOID >( block.address ),
+                block.bytes.data(),
+                block.bytes.size(),
+                &bytes_read );
+
+            block.bytes.resize( success ? bytes_read : 0 );
+        } );
+
+        result.blocks.erase(
+            std::remove_if(
+                result.blocks.begin(),
+                result.blocks.end(),
+                []( const snapshot_block_t& block ) { return block.bytes.empty(); } ),
+            result.blocks.end() );
+
+        std::sort(
+            result.blocks.begin(), result.blocks.end(), []( const snapshot_block_t& lhs, const snapshot_block_t& rhs ) {
+                return lhs.address < rhs.address;
+            } );
+
+        return result;
+    }
+
+    snapshot snapshot::capture( const win::module_t& module )
+    {
+        return capture( module.handle, module.get_regions() );
+    }
+
+    snapshot_diff_t snapshot::diff( const snapshot& before, const snapshot& after, const diff_options_t& options )
+    {
+        auto field_size = options.field_size;
+
+        if ( field_size && ( field_size > 8 || field_size & ( field_size - 1 ) ) )
+            throw std::invalid_argument( "The field size of a diff must be 1, 2, 4 or 8" );
+
+        if ( !field_size && options.changed_by )
+            field_size = 1;
+
+        // Both block lists are sorted, so the ranges present in both fall out of a single merge.
+        std::vector< overlap_t > overlaps;
+
+        for ( auto lhs = before.blocks.begin(), rhs = after.blocks.begin();
+              lhs != before.blocks.end() && rhs != after.blocks.end(); )
+        {
+            const auto lhs_end = lhs->address + lhs->bytes.size();
+            const auto rhs_end = rhs->address + rhs->bytes.size();
+
+            const auto start = std::max( lhs->address, rhs->address );
+            const auto end = std::min( lhs_end, rhs_end );
+
+            if ( start < end )
+                overlaps.push_back( {
+                    start,
+                    lhs->bytes.data() + ( start - lhs->address ),
+                    rhs->bytes.data() + ( start - rhs->address ),
+                    end - start } );
+
+            if ( lhs_end < rhs_end )
+                ++lhs;
+            else
+                ++rhs;
+        }
+
+        std::vector< snapshot_diff_t > partial( overlaps.size() );
+
+        thread_pool::shared().parallel_for( overlaps.size(), [ & ]( std::size_t index ) {
+            if ( field_size )
+                diff_fields( partial[ index ], overlaps[ index ], field_size, options );
+            else
+                diff_bytes( partial[ index ], overlaps[ index ] );
+        } );
+
+        snapshot_diff_t result;
+
+        for ( auto& part : partial )
+        {
+            const auto base = result.old_bytes.size();
+
+            for ( auto run : part.runs )
+            {
+                run.offset += base;
+                result.runs.push_back( run );
+            }
+
+            result.old_bytes.insert( result.old_bytes.end(), part.old_bytes.begin(), part.old_bytes.end() );
+            result.new_bytes.insert( result.new_bytes.end(), part.new_bytes.begin(), part.new_bytes.end() );
+        }
+
+        return result;
+    }
+
+    const std::vector< snapshot_block_t >& snapshot::get_blocks() const
+    {
+        return blocks;
+    }
+
+    std::size_t snapshot::size() const
+    {
+        std::size_t total = 0;
+
+        for ( const auto& block : blocks )
+            total += block.bytes.size();
+
+        return total;
+    }
+}  // namespace extlib
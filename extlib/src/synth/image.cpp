@@ -0,0 +1,774 @@
+#include "synth/image.hpp"
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include "object.hpp"
+#include "scan.hpp"
+
+namespace extlib::synth
+{
+    namespace
+    {
+        constexpr std::size_t section_alignment = 0x1000;
+        constexpr std::size_t headers_size = 0x1000;
+
+        /// <summary>
+        /// The most entries a class's base class array may have. Multiple inheritance multiplies them quickly, so bases
+        /// are dropped from a class until it fits.
+        /// </summary>
+        constexpr std::size_t max_hierarchy_entries = 64;
+
+        /// <summary>
+        /// The x64 base class descriptor as MSVC emits it, which ends with the RVA of the base's hierarchy descriptor.
+        /// </summary>
+        struct base_class_descriptor_t
+        {
+            std::int32_t type_descriptor_rva;
+            std::uint32_t contained_bases;
+            std::int32_t member_displacement;
+            std::int32_t vtable_displacement;
+            std::int32_t displacement_within_vtable;
+            std::uint32_t attributes;
+            std::int32_t hierarchy_rva;
+        };
+
+        /// <summary>
+        /// A class before it is laid out: its bases and the shape of its objects.
+        /// </summary>
+        struct shape_t
+        {
+            std::vector< std::size_t > bases;
+
+            /// <summary>
+            /// The offset of every direct base within the object.
+            /// </summary>
+            std::vector< std::uint32_t > base_offsets;
+
+            std::uint32_t size;
+
+            /// <summary>
+            /// The offsets of every vfptr within the object, the primary one first.
+            /// </summary>
+            std::vector< std::uint32_t > vfptrs;
+
+            /// <summary>
+            /// The number of entries in the class's base class array: the class itself, then every base, flattened.
+            /// </summary>
+            std::size_t entries;
+        };
+
+        /// <summary>
+        /// A growing section.
+        /// </summary>
+        struct section_writer_t
+        {
+            template< typename T >
+            std::size_t append( const T& value )
+            {
+                return append( &value, sizeof( value ) );
+            }
+
+            std::size_t append( const void* data, std::size_t size )
+            {
+                const auto offset = bytes.size();
+                bytes.resize( offset + size );
+                std::memcpy( bytes.data() + offset, data, size );
+
+                return offset;
+            }
+
+            template< typename T >
+            void put( std::size_t offset, const T& value )
+            {
+                std::memcpy( bytes.data() + offset, &value, sizeof( value ) );
+            }
+
+            void align( std::size_t alignment, std::uint8_t fill = 0 )
+            {
+                bytes.resize( ( bytes.size() + alignment - 1 ) & ~( alignment - 1 ), fill );
+            }
+
+            std::vector< std::uint8_t > bytes;
+        };
+
+        std::size_t align_section( std::size_t size )
+        {
+            return ( size + section_alignment - 1 ) & ~( section_alignment - 1 );
+        }
+
+        /// <summary>
+        /// Generates bytes that look roughly like the body of x64 code, where a handful of bytes are far more common
+        /// than the rest.
+        /// </summary>
+        void generate_body( std::vector< std::uint8_t >& out, std::size_t size, std::mt19937_64& random )
+        {
+            static constexpr std::uint8_t common[] = { 0x00, 0x48, 0x8B, 0x89, 0xE8, 0xFF, 0x0F, 0x24, 0x44, 0x4C, 0x85 };
+
+            for ( std::size_t i = 0; i < size; ++i )
+            {
+                const auto value = random();
+                out.push_back( value % 10 < 3 ? common[ ( value >> 8 ) % std::size( common ) ]
+                                              : static_cast< std::uint8_t >( value >> 16 ) );
+            }
+        }
+
+        /// <summary>
+        /// Fills `.text` with functions, each opened and closed by one of the usual MSVC prologue and epilogue pairs
+        /// and padded to 16 bytes with `int3`.
+        /// </summary>
+        void generate_code(
+            section_writer_t& text,
+            std::vector< std::uint32_t >& functions,
+            std::size_t code_size,
+            std::mt19937_64& random )
+        {
+            static const std::vector< std::uint8_t > prologues[] = {
+                { 0x48, 0x89, 0x5C, 0x24, 0x08, 0x57, 0x48, 0x83, 0xEC, 0x20 },  // mov [rsp+8], rbx; push rdi; sub rsp, 20h
+                { 0x40, 0x53, 0x48, 0x83, 0xEC, 0x20 },                          // push rbx; sub rsp, 20h
+                { 0x48, 0x83, 0xEC, 0x28 },                                      // sub rsp, 28h
+            };
+
+            static const std::vector< std::uint8_t > epilogues[] = {
+                { 0x48, 0x8B, 0x5C, 0x24, 0x30, 0x48, 0x83, 0xC4, 0x20, 0x5F, 0xC3 },  // mov rbx, [rsp+30h]; ...; ret
+                { 0x48, 0x83, 0xC4, 0x20, 0x5B, 0xC3 },                                // add rsp, 20h; pop rbx; ret
+                { 0x48, 0x83, 0xC4, 0x28, 0xC3 },                                      // add rsp, 28h; ret
+            };
+
+            do
+            {
+                const auto kind = random() % std::size( prologues );
+
+                functions.push_back( static_cast< std::uint32_t >( text.bytes.size() ) );
+
+                text.append( prologues[ kind ].data(), prologues[ kind ].size() );
+                generate_body( text.bytes, 8 + random() % 240, random );
+                text.append( epilogues[ kind ].data(), epilogues[ kind ].size() );
+                text.align( 16, 0xCC );
+            } while ( text.bytes.size() < code_size );
+        }
+
+        /// <summary>
+        /// Plants every signature at the start of a different function that is long enough to hold it.
+        /// </summary>
+        std::vector< planted_signature_t > plant_signatures(
+            section_writer_t& text,
+            const std::vector< std::uint32_t >& functions,
+            const std::vector< std::string >& signatures,
+            std::mt19937_64& random )
+        {
+            std::vector< planted_signature_t > planted;
+            std::vector< bool > used( functions.size() );
+
+            for ( std::size_t i = 0; i < signatures.size(); ++i )
+            {
+                const auto pattern = pattern_t::from_byte_pattern( signatures[ i ] );
+
+                std::vector< std::size_t > candidates;
+
+                for ( std::size_t j = 0; j < functions.size(); ++j )
+                {
+                    const auto end = j + 1 < functions.size() ? functions[ j + 1 ] : text.bytes.size();
+
+                    if ( !used[ j ] && end - functions[ j ] >= pattern.bytes.size() )
+                        candidates.push_back( j );
+                }
+
+                if ( candidates.empty() )
+                {
+                    std::stringstream msg;
+                    msg << "No generated function is free and long enough for signature '" << signatures[ i ] << "'";
+                    throw std::invalid_argument( msg.str() );
+                }
+
+                const auto function = candidates[ random() % candidates.size() ];
+                used[ function ] = true;
+
+                for ( std::size_t j = 0; j < pattern.bytes.size(); ++j )
+                {
+                    const auto [ byte, wildcard ] = pattern.bytes[ j ];
+                    text.bytes[ functions[ function ] + j ] = wildcard ? static_cast< std::uint8_t >( random() ) : byte;
+                }
+
+                planted.push_back( { i, functions[ function ] } );
+            }
+
+            return planted;
+        }
+
+        /// <summary>
+        /// Hashes a key as `std::hash` does for MSVC: FNV-1a over its bytes.
+        /// </summary>
+        std::uint64_t hash_key( std::uint32_t key )
+        {
+            std::uint64_t hash = 0xCBF29CE484222325;
+
+            for ( std::size_t i = 0; i < sizeof( key ); ++i )
+            {
+                hash ^= ( key >> ( i * 8 ) ) & 0xFF;
+                hash *= 0x100000001B3;
+            }
+
+            return hash;
+        }
+
+        /// <summary>
+        /// Lays out standard containers in `.data` as MSVC's x64 standard library does, each object followed by its
+        /// storage.
+        /// </summary>
+        /// <param name="data_address">The address `.data` is loaded at.</param>
+        std::vector< planted_container_t > plant_containers(
+            section_writer_t& data,
+            std::uintptr_t data_address,
+            std::size_t count,
+            std::mt19937_64& random )
+        {
+            std::vector< planted_container_t > planted;
+
+            const auto address = [ & ]( std::size_t offset ) {
+                return static_cast< std::uint64_t >( data_address + offset );
+            };
+
+            for ( std::size_t i = 0; i < count; ++i )
+            {
+                planted_container_t container{ static_cast< container_kind_t >( i % 3 ), 0, {}, {} };
+
+                data.align( 16 );
+
+                const auto object = data.bytes.size();
+                container.rva = static_cast< std::uint32_t >( object );
+
+                switch ( container.kind )
+                {
+                    case container_kind_t::vector:
+                    {
+                        // The first element, the end of the elements and the end of the storage, all null while empty.
+                        data.append( std::uint64_t{ 0 } );
+                        data.append( std::uint64_t{ 0 } );
+                        data.append( std::uint64_t{ 0 } );
+
+                        const auto size = random() % 64;
+                        const auto capacity = size + random() % 8;
+
+                        if ( !capacity )
+                            break;
+
+                        data.align( 16 );
+
+                        const auto storage = data.bytes.size();
+
+                        for ( std::size_t j = 0; j < size; ++j )
+                        {
+                            container.values.push_back( static_cast< std::uint32_t >( random() ) );
+                            data.append( container.values.back() );
+                        }
+
+                        data.bytes.resize( storage + capacity * sizeof( std::uint32_t ) );
+
+                        data.put( object, address( storage ) );
+                        data.put( object + 8, address( storage + size * sizeof( std::uint32_t ) ) );
+                        data.put( object + 16, address( storage + capacity * sizeof( std::uint32_t ) ) );
+                        break;
+                    }
+                    case container_kind_t::string:
+                    {
+                        const auto length = random() % 48;
+
+                        for ( std::size_t j = 0; j < length; ++j )
+                            container.string.push_back( static_cast< char >( 'a' + random() % 26 ) );
+
+                        // A 16 byte buffer holding the characters and their terminator, or a pointer to them once they
+                        // no longer fit, followed by the length and the capacity.
+                        data.bytes.resize( object + 32 );
+                        data.put( object + 16, std::uint64_t{ length } );
+
+                        if ( length < 16 )
+                        {
+                            std::memcpy( data.bytes.data() + object, container.string.data(), length );
+                            data.put( object + 24, std::uint64_t{ 15 } );
+                            break;
+                        }
+
+                        const auto characters = data.append( container.string.c_str(), length + 1 );
+
+                        data.put( object, address( characters ) );
+                        data.put( object + 24, std::uint64_t{ length | 15 } );
+                        break;
+                    }
+                    case container_kind_t::unordered_map:
+                    {
+                        const auto size = random() % 64;
+
+                        std::vector< std::uint32_t > keys;
+
+                        while ( keys.size() < size )
+                        {
+                            const auto key = static_cast< std::uint32_t >( random() );
+
+                            if ( std::find( keys.begin(), keys.end(), key ) == keys.end() )
+                                keys.push_back( key );
+                        }
+
+                        // The table starts with 8 buckets and is kept a power of two no smaller than the entries.
+                        std::size_t bucket_count = 8;
+
+                        while ( bucket_count < size )
+                            bucket_count *= 2;
+
+                        std::vector< std::vector< std::uint32_t > > buckets( bucket_count );
+
+                        for ( const auto key : keys )
+                            buckets[ hash_key( key ) & ( bucket_count - 1 ) ].push_back( key );
+
+                        // The maximum load factor, the sentinel of the list of every entry and its size, the bucket
+                        // table, and the mask and number of buckets.
+                        data.bytes.resize( object + 0x40 );
+                        data.put( object, 1.0f );
+                        data.put( object + 16, std::uint64_t{ size } );
+                        data.put( object + 48, std::uint64_t{ bucket_count - 1 } );
+                        data.put( object + 56, std::uint64_t{ bucket_count } );
+
+                        // Every node is its links followed by the key and the value; the sentinel leaves them unused.
+                        const auto head = data.append( std::array< std::uint64_t, 3 >{} );
+                        auto previous = head;
+
+                        std::vector< std::uint64_t > table;
+                        table.reserve( bucket_count * 2 );
+
+                        for ( const auto& bucket : buckets )
+                        {
+                            if ( bucket.empty() )
+                            {
+                                table.insert( table.end(), 2, address( head ) );
+                                continue;
+                            }
+
+                            table.push_back( address( data.bytes.size() ) );
+
+                            for ( const auto key : bucket )
+                            {
+                                const auto value = static_cast< std::uint32_t >( random() );
+                                const auto node = data.append( std::array< std::uint64_t, 3 >{} );
+
+                                data.put( node + 8, address( previous ) );
+                                data.put( node + 16, key );
+                                data.put( node + 20, value );
+                                data.put( previous, address( node ) );
+
+                                container.values.push_back( key );
+                                container.values.push_back( value );
+
+                                previous = node;
+                            }
+
+                            table.push_back( address( previous ) );
+                        }
+
+                        data.put( previous, address( head ) );
+                        data.put( head + 8, address( previous ) );
+
+                        data.align( 16 );
+
+                        const auto table_offset = data.append( table.data(), table.size() * sizeof( std::uint64_t ) );
+
+                        data.put( object + 8, address( head ) );
+                        data.put( object + 24, address( table_offset ) );
+                        data.put( object + 32, address( data.bytes.size() ) );
+                        data.put( object + 40, address( data.bytes.size() ) );
+                        break;
+                    }
+                }
+
+                planted.push_back( std::move( container ) );
+            }
+
+            return planted;
+        }
+
+        /// <summary>
+        /// Decides the bases and object layout of every class. Bases are picked among the classes before, so the
+        /// hierarchy has no cycles and a class's bases are always shaped first.
+        /// </summary>
+        std::vector< shape_t > shape_classes( const image_options_t& options, std::mt19937_64& random )
+        {
+            std::vector< shape_t > shapes( options.classes );
+
+            for ( std::size_t i = 0; i < shapes.size(); ++i )
+            {
+                auto& shape = shapes[ i ];
+
+                // Most classes have at most one base, as in real code.
+                const auto roll = random() % 10;
+                const auto extra = random() % std::max< std::size_t >( options.max_bases, 1 );
+
+                const std::size_t wanted = roll < 4 ? 0 : roll < 8 ? 1 : 2 + extra;
+                const auto count = std::min( { wanted, options.max_bases, i } );
+
+                while ( shape.bases.size() < count )
+                {
+                    const auto base = static_cast< std::size_t >( random() % i );
+
+                    if ( std::find( shape.bases.begin(), shape.bases.end(), base ) == shape.bases.end() )
+                        shape.bases.push_back( base );
+                }
+
+                shape.entries = 1;
+
+                for ( const auto base : shape.bases )
+                    shape.entries += shapes[ base ].entries;
+
+                while ( shape.entries > max_hierarchy_entries )
+                {
+                    shape.entries -= shapes[ shape.bases.back() ].entries;
+                    shape.bases.pop_back();
+                }
+
+                // Every base subobject keeps its own vfptrs; a class without bases introduces one.
+                std::uint32_t size = shape.bases.empty() ? sizeof( std::uintptr_t ) : 0;
+
+                if ( shape.bases.empty() )
+                    shape.vfptrs.push_back( 0 );
+
+                for ( const auto base : shape.bases )
+                {
+                    shape.base_offsets.push_back( size );
+
+                    for ( const auto vfptr : shapes[ base ].vfptrs )
+                        shape.vfptrs.push_back( size + vfptr );
+
+                    size += shapes[ base ].size;
+                }
+
+                shape.size = size + static_cast< std::uint32_t >( sizeof( std::uintptr_t ) * ( random() % 7 ) );
+            }
+
+            return shapes;
+        }
+
+        /// <summary>
+        /// Appends the base class array entries of a class and its bases: the class, followed by each base's entries.
+        /// </summary>
+        void flatten(
+            const std::vector< shape_t >& shapes,
+            std::size_t index,
+            std::uint32_t offset,
+            std::vector< std::pair< std::size_t, std::uint32_t > >& entries )
+        {
+            entries.emplace_back( index, offset );
+
+            const auto& shape = shapes[ index ];
+
+            for ( std::size_t i = 0; i < shape.bases.size(); ++i )
+                flatten( shapes, shape.bases[ i ], offset + shape.base_offsets[ i ], entries );
+        }
+    }  // namespace
+
+    image image::generate( const image_options_t& options )
+    {
+        std::mt19937_64 random( options.seed );
+
+        image result;
+        result.base = options.base;
+
+        section_writer_t text, rdata, data;
+
+        generate_code( text, result.functions, options.code_size, random );
+        result.signatures = plant_signatures( text, result.functions, options.signatures, random );
+
+        const auto text_rva = static_cast< std::uint32_t >( headers_size );
+        const auto rdata_rva = static_cast< std::uint32_t >( text_rva + align_section( text.bytes.size() ) );
+
+        for ( auto& function : result.functions )
+            function += text_rva;
+
+        for ( auto& signature : result.signatures )
+            signature.rva += text_rva;
+
+        const auto random_function = [ & ]() {
+            return result.functions[ random() % result.functions.size() ];
+        };
+
+        // The vtable of `type_info`, which every type descriptor points at.
+        const auto type_info_vtable_rva =
+            rdata_rva + static_cast< std::uint32_t >( rdata.append( options.base + random_function() ) );
+
+        for ( std::size_t i = 0; i < options.strings; ++i )
+        {
+            static constexpr const char* words[] = { "player", "health", "render", "network", "update", "physics", "camera",
+                                                     "script", "asset", "input", "failed", "invalid", "loaded", "%s", "%d" };
+
+            std::string value = words[ random() % std::size( words ) ];
+            value += ' ';
+            value += words[ random() % std::size( words ) ];
+            value += ' ' + std::to_string( i );
+
+            const auto offset = rdata.append( value.c_str(), value.size() + 1 );
+            rdata.align( 8 );
+
+            result.strings.push_back( { std::move( value ), static_cast< std::uint32_t >( rdata_rva + offset ) } );
+        }
+
+        const auto shapes = shape_classes( options, random );
+
+        // Type descriptors live in `.data`, which is only placed once `.rdata` is complete, so `.rdata` refers to them
+        // by their offset into `.data` until then.
+        std::vector< std::size_t > data_references;
+
+        for ( std::size_t i = 0; i < shapes.size(); ++i )
+        {
+            class_t type;
+            type.name = options.namespace_name + "::class_" + std::to_string( i );
+            type.bases = shapes[ i ].bases;
+
+            data.align( 16 );
+
+            const auto mangled = object_pattern_t::from_class_name( type.name ).string;
+            const auto descriptor_offset = data.append( type_info_vtable_rva + options.base );
+
+            data.append( std::uint64_t{ 0 } );
+            data.append( mangled.c_str(), mangled.size() + 1 );
+
+            type.type_descriptor_rva = static_cast< std::uint32_t >( descriptor_offset );
+            result.classes.push_back( std::move( type ) );
+        }
+
+        for ( std::size_t i = 0; i < shapes.size(); ++i )
+        {
+            auto& type = result.classes[ i ];
+            const auto& shape = shapes[ i ];
+
+            std::vector< std::pair< std::size_t, std::uint32_t > > entries;
+            flatten( shapes, i, 0, entries );
+
+            // MSVC marks the hierarchy as multiple inheritance when any class in it, not only this one, has several
+            // bases.
+            const auto multiple = std::any_of( entries.begin(), entries.end(), [ & ]( const auto& entry ) {
+                return shapes[ entry.first ].bases.size() > 1;
+            } );
+
+            rdata.align( 8 );
+
+            const auto hierarchy_offset = rdata.append( class_hierarchy_descriptor_t{
+                0,
+                multiple ? 1u : 0u,
+                static_cast< std::uint32_t >( entries.size() ),
+                static_cast< std::int32_t >( rdata_rva + rdata.bytes.size() + sizeof( class_hierarchy_descriptor_t ) ) } );
+
+            type.hierarchy_rva = static_cast< std::uint32_t >( rdata_rva + hierarchy_offset );
+
+            const auto array_offset = rdata.bytes.size();
+            const auto descriptors_offset = array_offset + entries.size() * sizeof( std::int32_t );
+
+            for ( std::size_t j = 0; j < entries.size(); ++j )
+                rdata.append(
+                    static_cast< std::int32_t >( rdata_rva + descriptors_offset + j * sizeof( base_class_descriptor_t ) ) );
+
+            for ( const auto& [ index, offset ] : entries )
+            {
+                data_references.push_back( rdata.append( base_class_descriptor_t{
+                    static_cast< std::int32_t >( result.classes[ index ].type_descriptor_rva ),
+                    static_cast< std::uint32_t >( shapes[ index ].entries - 1 ),
+                    static_cast< std::int32_t >( offset ),
+                    -1,
+                    0,
+                    0x40,
+                    static_cast< std::int32_t >( result.classes[ index ].hierarchy_rva ) } ) );
+            }
+
+            for ( const auto vfptr : shape.vfptrs )
+            {
+                rdata.align( 8 );
+
+                const auto locator_offset = rdata.bytes.size();
+                const auto locator_rva = static_cast< std::uint32_t >( rdata_rva + locator_offset );
+
+                data_references.push_back( locator_offset + offsetof( complete_object_locator_t, type_descriptor_rva ) );
+
+                rdata.append( complete_object_locator_t{
+                    1,
+                    vfptr,
+                    0,
+                    static_cast< std::int32_t >( type.type_descriptor_rva ),
+                    static_cast< std::int32_t >( type.hierarchy_rva ),
+                    static_cast< std::int32_t >( locator_rva ) } );
+
+                // The slot before a vtable's first function points at its complete object locator.
+                rdata.append( options.base + locator_rva );
+
+                vtable_t vtable{ static_cast< std::uint32_t >( rdata_rva + rdata.bytes.size() ), locator_rva, vfptr, {} };
+
+                const auto count = 1 + random() % std::max< std::size_t >( options.max_virtual_functions, 1 );
+
+                for ( std::size_t j = 0; j < count; ++j )
+                {
+                    vtable.functions.push_back( random_function() );
+                    rdata.append( options.base + vtable.functions.back() );
+                }
+
+                type.vtables.push_back( std::move( vtable ) );
+            }
+        }
+
+        const auto data_rva = static_cast< std::uint32_t >( rdata_rva + align_section( rdata.bytes.size() ) );
+
+        for ( const auto offset : data_references )
+        {
+            std::int32_t value;
+            std::memcpy( &value, rdata.bytes.data() + offset, sizeof( value ) );
+
+            rdata.put( offset, static_cast< std::int32_t >( value + data_rva ) );
+        }
+
+        for ( auto& type : result.classes )
+            type.type_descriptor_rva += data_rva;
+
+        // Globals: mostly zero, with the odd counter, flag or pointer into the image.
+        data.align( 16 );
+
+        for ( std::size_t i = 0; i < options.data_size / sizeof( std::uint64_t ); ++i )
+        {
+            const auto roll = random() % 16;
+
+            if ( roll == 0 )
+                data.append( std::uint64_t{ random() % 1000 } );
+            else if ( roll == 1 )
+                data.append( options.base + random_function() );
+            else
+                data.append( std::uint64_t{ 0 } );
+        }
+
+        result.containers = plant_containers( data, options.base + data_rva, options.containers, random );
+
+        for ( auto& container : result.containers )
+            container.rva += data_rva;
+
+        const auto image_size = data_rva + align_section( data.bytes.size() );
+
+        result.bytes.resize( image_size );
+
+        std::copy( text.bytes.begin(), text.bytes.end(), result.bytes.begin() + text_rva );
+        std::copy( rdata.bytes.begin(), rdata.bytes.end(), result.bytes.begin() + rdata_rva );
+        std::copy( data.bytes.begin(), data.bytes.end(), result.bytes.begin() + data_rva );
+
+        IMAGE_DOS_HEADER dos{};
+        dos.e_magic = IMAGE_DOS_SIGNATURE;
+        dos.e_lfanew = sizeof( IMAGE_DOS_HEADER );
+
+        IMAGE_NT_HEADERS64 nt{};
+        nt.Signature = IMAGE_NT_SIGNATURE;
+        nt.FileHeader.Machine = IMAGE_FILE_MACHINE_AMD64;
+        nt.FileHeader.NumberOfSections = 3;
+        nt.FileHeader.TimeDateStamp = static_cast< DWORD >( options.seed );
+        nt.FileHeader.SizeOfOptionalHeader = sizeof( IMAGE_OPTIONAL_HEADER64 );
+        nt.FileHeader.Characteristics = IMAGE_FILE_EXECUTABLE_IMAGE | IMAGE_FILE_LARGE_ADDRESS_AWARE;
+        nt.OptionalHeader.Magic = IMAGE_NT_OPTIONAL_HDR64_MAGIC;
+        nt.OptionalHeader.SizeOfCode = static_cast< DWORD >( align_section( text.bytes.size() ) );
+        nt.OptionalHeader.AddressOfEntryPoint = result.functions.front();
+        nt.OptionalHeader.BaseOfCode = text_rva;
+        nt.OptionalHeader.ImageBase = options.base;
+        nt.OptionalHeader.SectionAlignment = section_alignment;
+        nt.OptionalHeader.FileAlignment = section_alignment;
+        nt.OptionalHeader.MajorOperatingSystemVersion = 6;
+        nt.OptionalHeader.MajorSubsystemVersion = 6;
+        nt.OptionalHeader.SizeOfImage = static_cast< DWORD >( image_size );
+        nt.OptionalHeader.SizeOfHeaders = headers_size;
+        nt.OptionalHeader.Subsystem = IMAGE_SUBSYSTEM_WINDOWS_CUI;
+        nt.OptionalHeader.NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+
+        std::memcpy( result.bytes.data(), &dos, sizeof( dos ) );
+        std::memcpy( result.bytes.data() + dos.e_lfanew, &nt, sizeof( nt ) );
+
+        const struct
+        {
+            const char* name;
+            std::uint32_t rva;
+            std::size_t size;
+            DWORD characteristics;
+        } sections[] = {
+            { ".text", text_rva, text.bytes.size(), IMAGE_SCN_CNT_CODE | IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_MEM_READ },
+            { ".rdata", rdata_rva, rdata.bytes.size(), IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ },
+            { ".data",
+              data_rva,
+              data.bytes.size(),
+              IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ | IMAGE_SCN_MEM_WRITE },
+        };
+
+        for ( std::size_t i = 0; i < std::size( sections ); ++i )
+        {
+            IMAGE_SECTION_HEADER section{};
+            std::strncpy( reinterpret_cast< char* >( section.Name ), sections[ i ].name, sizeof( section.Name ) );
+
+            // The file is laid out exactly like memory, so raw data starts at each section's virtual address.
+            section.Misc.VirtualSize = static_cast< DWORD >( sections[ i ].size );
+            section.VirtualAddress = sections[ i ].rva;
+            section.SizeOfRawData = static_cast< DWORD >( align_section( sections[ i ].size ) );
+            section.PointerToRawData = sections[ i ].rva;
+            section.Characteristics = sections[ i ].characteristics;
+
+            std::memcpy(
+                result.bytes.data() + dos.e_lfanew + sizeof( nt ) + i * sizeof( section ), &section, sizeof( section ) );
+        }
+
+        return result;
+    }
+
+    const std::vector< std::uint8_t >& image::get_bytes() const
+    {
+        return bytes;
+    }
+
+    std::uintptr_t image::get_base() const
+    {
+        return base;
+    }
+
+    const std::vector< class_t >& image::get_classes() const
+    {
+        return classes;
+    }
+
+    const std::vector< std::uint32_t >& image::get_functions() const
+    {
+        return functions;
+    }
+
+    const std::vector< planted_signature_t >& image::get_signatures() const
+    {
+        return signatures;
+    }
+
+    const std::vector< planted_string_t >& image::get_strings() const
+    {
+        return strings;
+    }
+
+    const std::vector< planted_container_t >& image::get_containers() const
+    {
+        return containers;
+    }
+
+    std::shared_ptr< buffer_source > image::create_source( std::string name ) const
+    {
+        return std::make_shared< buffer_source >( bytes, base, std::move( name ) );
+    }
+
+    void image::save( const std::filesystem::path& path ) const
+    {
+        std::ofstream file( path, std::ios::binary );
+
+        if ( !file.write( reinterpret_cast< const char* >( bytes.data() ), static_cast< std::streamsize >( bytes.size() ) ) )
+        {
+            std::stringstream msg;
+            msg << "Failed to write the image to '" << path.string() << "'";
+            throw std::runtime_error( msg.str() );
+        }
+    }
+}  // namespace extlib::synth
@@ -0,0 +1,73 @@
+#include "thread_pool.hpp"
+
+namespace extlib
+{
+    thread_pool::thread_pool( std::size_t threads ) : stopping( false )
+    {
+        threads = std::max< std::size_t >( threads, 1 );
+
+        for ( std::size_t i = 0; i < threads; ++i )
+            workers.emplace_back( &thread_pool::run, this );
+    }
+
+    thread_pool::~thread_pool()
+    {
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            stopping = true;
+        }
+
+        condition.notify_all();
+
+        for ( auto& worker : workers )
+            worker.join();
+    }
+
+    thread_pool& thread_pool::shared()
+    {
+        static thread_pool pool;
+
+        return pool;
+    }
+
+    std::size_t thread_pool::size() const
+    {
+        return workers.size();
+    }
+
+    void thread_pool::post( std::function< void() > task )
+    {
+        enqueue( std::move( task ) );
+    }
+
+    void thread_pool::enqueue( std::function< void() > task )
+    {
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            tasks.push_back( std::move( task ) );
+        }
+
+        condition.notify_one();
+    }
+
+    void thread_pool::run()
+    {
+        for ( ;; )
+        {
+            std::function< void() > task;
+
+            {
+                std::unique_lock< std::mutex > lock( mutex );
+                condition.wait( lock, [ this ]() { return stopping || !tasks.empty(); } );
+
+                if ( tasks.empty() )
+                    return;
+
+                task = std::move( tasks.front() );
+                tasks.pop_front();
+            }
+
+            task();
+        }
+    }
+}  // namespace extlib
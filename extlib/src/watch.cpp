@@ -0,0 +1,386 @@
+#include "watch.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "simd.hpp"
+
+namespace extlib
+{
+    namespace
+    {
+        /// <summary>
+        /// The number of recent tick latencies kept for percentiles.
+        /// </summary>
+        constexpr std::size_t latency_samples = 1024;
+
+        /// <summary>
+        /// A waitable timer for the polling thread to wait out each period on. The scheduler tick is far coarser than a
+        /// 2ms period, so the timer is high resolution where the system supports it (Windows 10 1803 and later).
+        /// </summary>
+        class period_timer_t
+        {
+           public:
+            period_timer_t()
+                : timer( CreateWaitableTimerExW(
+                      nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS ) )
+            {
+                // Older systems reject the high resolution flag, and get an ordinary timer instead.
+                if ( !timer )
+                    timer = CreateWaitableTimerExW( nullptr, nullptr, 0, TIMER_ALL_ACCESS );
+            }
+
+            ~period_timer_t()
+            {
+                if ( timer )
+                    CloseHandle( timer );
+            }
+
+            period_timer_t( const period_timer_t& ) = delete;
+            period_timer_t& operator=( const period_timer_t& ) = delete;
+
+            /// <summary>
+            /// Blocks for a duration, falling back to sleeping if no timer could be created or armed.
+            /// </summary>
+            void wait( std::chrono::nanoseconds duration )
+            {
+                // Negative due times are relative, in 100ns units.
+                LARGE_INTEGER due;
+                due.QuadPart = -std::max< LONGLONG >( duration.count() / 100, 1 );
+
+                if ( timer && SetWaitableTimer( timer, &due, 0, nullptr, nullptr, FALSE ) &&
+                     WaitForSingleObject( timer, INFINITE ) == WAIT_OBJECT_0 )
+                    return;
+
+                std::this_thread::sleep_for( duration );
+            }
+
+           private:
+            HANDLE timer;
+        };
+    }  // namespace
+
+    watch_list::watch_list( win::handle_t handle, const watch_options_t& options )
+        : handle( handle ),
+          options( options ),
+          tick_count( 0 ),
+          compiled( false ),
+          queue( std::make_unique< spsc_queue< watch_change_t, queue_capacity > >() ),
+          running( false ),
+          totals{},
+          total_latency( 0 ),
+          total_jitter( 0 )
+    {
+    }
+
+    watch_list::~watch_list()
+    {
+        stop();
+    }
+
+    std::size_t watch_list::add( std::uintptr_t address, std::size_t size, watch_type_t type )
+    {
+        if ( running )
+            throw std::logic_error( "Entries cannot be added to a running watch list" );
+
+        if ( !size || size > max_watch_size )
+            throw std::invalid_argument( "Watch entries must be between 1 and max_watch_size bytes" );
+
+        entries.push_back( { address, size, type } );
+        compiled = false;
+
+        return entries.size() - 1;
+    }
+
+    void watch_list::on_change( callback_t callback )
+    {
+        if ( running )
+            throw std::logic_error( "The callback of a running watch list cannot be changed" );
+
+        this->callback = std::move( callback );
+    }
+
+    bool watch_list::poll( watch_change_t& change )
+    {
+        return queue->try_pop( change );
+    }
+
+    void watch_list::start()
+    {
+        if ( running )
+            return;
+
+        if ( !compiled )
+            compile();
+
+        running = true;
+        worker = std::thread( &watch_list::run, this );
+    }
+
+    void watch_list::stop()
+    {
+        running = false;
+
+        if ( worker.joinable() )
+            worker.join();
+    }
+
+    bool watch_list::is_running() const
+    {
+        return running;
+    }
+
+    void watch_list::tick()
+    {
+        if ( running )
+            throw std::logic_error( "A running watch list cannot be ticked manually" );
+
+        if ( !compiled )
+            compile();
+
+        const auto start = std::chrono::steady_clock::now();
+
+        poll_once();
+
+        record( std::chrono::steady_clock::now() - start, std::chrono::nanoseconds( 0 ), false );
+    }
+
+    watch_stats_t watch_list::stats() const
+    {
+        std::lock_guard< std::mutex > lock( stats_mutex );
+
+        auto stats = totals;
+        stats.spans = spans.size();
+
+        if ( stats.ticks )
+        {
+            stats.mean_latency = total_latency / stats.ticks;
+            stats.mean_jitter = total_jitter / stats.ticks;
+        }
+
+        if ( !latencies.empty() )
+        {
+            auto sorted = latencies;
+            const auto rank = sorted.begin() + ( sorted.size() - 1 ) * 99 / 100;
+
+            std::nth_element( sorted.begin(), rank, sorted.end() );
+            stats.p99_latency = *rank;
+        }
+
+        return stats;
+    }
+
+    void watch_list::compile()
+    {
+        order.resize( entries.size() );
+        std::iota( order.begin(), order.end(), 0 );
+
+        std::sort( order.begin(), order.end(), [ this ]( std::size_t lhs, std::size_t rhs ) {
+            return entries[ lhs ].address < entries[ rhs ].address;
+        } );
+
+        spans.clear();
+
+        std::size_t offset = 0;
+
+        for ( std::size_t i = 0; i < order.size(); ++i )
+        {
+            const auto& entry = entries[ order[ i ] ];
+            const auto end = entry.address + entry.size;
+
+            if ( !spans.empty() )
+            {
+                auto& span = spans.back();
+
+                // Reading a few unwatched bytes is far cheaper than another call, so close entries share a span.
+                if ( entry.address <= span.address + span.size + options.max_gap &&
+                     end - span.address <= options.max_span )
+                {
+                    const auto size = std::max( span.size, end - span.address );
+
+                    offset += size - span.size;
+                    span.size = size;
+                    span.last = i + 1;
+
+                    continue;
+                }
+            }
+
+            spans.push_back( { entry.address, entry.size, offset, i, i + 1, false } );
+            offset += entry.size;
+        }
+
+        previous.assign( offset, 0 );
+        current.assign( offset, 0 );
+        reported.assign( order.size(), 0 );
+
+        compiled = true;
+    }
+
+    void watch_list::poll_once()
+    {
+        ++tick_count;
+
+        std::uint64_t failures = 0;
+
+        for ( auto& span : spans )
+        {
+            const auto buffer = current.data() + span.offset;
+
+            // Called directly rather than through memapi: a freed page is routine here and not worth an exception.
+            if ( !ReadProcessMemory(
+                     handle.handle, reinterpret_cast< LPCVOID >( span.address ), buffer, span.size, nullptr ) )
+            {
+                ++failures;
+                span.valid = false;
+
+                continue;
+            }
+
+            // The first good read of a span only establishes its baseline.
+            if ( !span.valid )
+            {
+                span.valid = true;
+                continue;
+            }
+
+            const auto old_buffer = previous.data() + span.offset;
+
+            auto cursor = span.first;
+
+            for ( std::size_t position = 0; position < span.size; )
+            {
+                position += simd::mismatch( old_buffer + position, buffer + position, span.size - position );
+
+                if ( position >= span.size )
+                    break;
+
+                const auto address = span.address + position;
+
+                while ( cursor < span.last &&
+                        entries[ order[ cursor ] ].address + entries[ order[ cursor ] ].size <= address )
+                    ++cursor;
+
+                // Report every entry covering the changed byte, then resume after the nearest end among them, or at
+                // the next entry to start if that comes first, so entries nested in or overlapping the reported ones
+                // are still compared.
+                auto next = span.size;
+                auto i = cursor;
+
+                for ( ; i < span.last && entries[ order[ i ] ].address <= address; ++i )
+                {
+                    const auto& entry = entries[ order[ i ] ];
+                    const auto end = entry.address + entry.size;
+
+                    if ( end <= address )
+                        continue;
+
+                    if ( reported[ i ] != tick_count )
+                    {
+                        reported[ i ] = tick_count;
+                        deliver( i, span );
+                    }
+
+                    next = std::min( next, end - span.address );
+                }
+
+                if ( i < span.last )
+                    next = std::min( next, entries[ order[ i ] ].address - span.address );
+
+                position = next;
+            }
+        }
+
+        previous.swap( current );
+
+        if ( failures )
+        {
+            std::lock_guard< std::mutex > lock( stats_mutex );
+            totals.read_failures += failures;
+        }
+    }
+
+    void watch_list::deliver( std::size_t index, const span_t& span )
+    {
+        const auto id = order[ index ];
+        const auto& entry = entries[ id ];
+
+        watch_change_t change{};
+        change.id = id;
+        change.address = entry.address;
+        change.size = entry.size;
+        change.type = entry.type;
+        change.tick = tick_count;
+
+        const auto offset = span.offset + ( entry.address - span.address );
+
+        std::memcpy( change.previous.data(), previous.data() + offset, entry.size );
+        std::memcpy( change.current.data(), current.data() + offset, entry.size );
+
+        if ( callback )
+            callback( change );
+        else if ( !queue->try_push( change ) )
+        {
+            std::lock_guard< std::mutex > lock( stats_mutex );
+            ++totals.dropped;
+        }
+    }
+
+    void watch_list::run()
+    {
+        using clock = std::chrono::steady_clock;
+
+        const auto period =
+            std::chrono::duration_cast< clock::duration >( std::chrono::duration< double >( 1.0 / options.rate ) );
+
+        period_timer_t timer;
+
+        auto next = clock::now();
+
+        while ( running )
+        {
+            const auto remaining = next - clock::now();
+
+            if ( remaining > clock::duration::zero() )
+                timer.wait( remaining );
+
+            const auto start = clock::now();
+            const auto jitter = std::chrono::nanoseconds( start - next );
+
+            poll_once();
+
+            const auto finish = clock::now();
+            const auto latency = std::chrono::nanoseconds( finish - start );
+
+            next += period;
+
+            const auto overrun = next < finish;
+
+            // Don't try to catch up on missed ticks, just start counting from now.
+            if ( overrun )
+                next = finish;
+
+            record( latency, jitter, overrun );
+        }
+    }
+
+    void watch_list::record( std::chrono::nanoseconds latency, std::chrono::nanoseconds jitter, bool overrun )
+    {
+        std::lock_guard< std::mutex > lock( stats_mutex );
+
+        ++totals.ticks;
+        totals.overruns += overrun;
+
+        total_latency += latency;
+        total_jitter += jitter;
+
+        totals.max_latency = std::max( totals.max_latency, latency );
+        totals.max_jitter = std::max( totals.max_jitter, jitter );
+
+        if ( latencies.size() < latency_samples )
+            latencies.push_back( latency );
+        else
+            latencies[ totals.ticks % latency_samples ] = latency;
+    }
+}  // namespace extlib
@@ -0,0 +1,255 @@
+#include "win/win.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+namespace extlib::win
+{
+    namespace
+    {
+        /// <summary>
+        /// A span of a module read in a single call, with reads outside of it falling back to the module.
+        /// </summary>
+        class image_reader final
+        {
+           public:
+            image_reader( const module_t& module, std::uint32_t rva, std::uint32_t size ) : module( module ), rva( rva )
+            {
+                // If the span cannot be read whole (e.g. part of it is uncommitted), every value is read on its own.
+                try
+                {
+                    bytes = module.read( module.start + rva, size );
+                }
+                catch ( const std::exception& )
+                {
+                    bytes.clear();
+                }
+            }
+
+            template< typename T >
+            T get( std::uint32_t offset ) const
+            {
+                if ( offset >= rva && offset - rva + sizeof( T ) <= bytes.size() )
+                {
+                    T value;
+                    std::memcpy( &value, bytes.data() + ( offset - rva ), sizeof( value ) );
+
+                    return value;
+                }
+
+                return module.read< T >( module.start + offset );
+            }
+
+            std::string string( std::uint32_t offset ) const
+            {
+                if ( offset >= rva && offset - rva < bytes.size() )
+                {
+                    const auto begin = reinterpret_cast< const char* >( bytes.data() + ( offset - rva ) );
+                    const auto end = reinterpret_cast< const char* >( bytes.data() + bytes.size() );
+
+                    return { begin, std::find( begin, end, '\0' ) };
+                }
+
+                return module.read_string( module.start + offset, 256 );
+            }
+
+           private:
+            const module_t& module;
+            std::uint32_t rva;
+            std::vector< std::uint8_t > bytes;
+        };
+
+        /// <summary>
+        /// Gets the key an import by name is found under. Module names compare case-insensitively, as the loader does.
+        /// </summary>
+        std::string import_key( std::string_view module, std::string_view name )
+        {
+            std::string key;
+            key.reserve( module.size() + 1 + name.size() );
+
+            for ( const auto character : module )
+                key.push_back( static_cast< char >( std::tolower( static_cast< unsigned char >( character ) ) ) );
+
+            // Neither name can hold a null, so it separates them.
+            key.push_back( '\0' );
+            key.append( name );
+
+            return key;
+        }
+    }  // namespace
+
+    const std::vector< export_t >& module_t::get_exports() const
+    {
+        return load_exports().exports;
+    }
+
+    const export_t* module_t::find_export( std::string_view name ) const
+    {
+        const auto& loaded = load_exports();
+        const auto it = loaded.exports_by_name.find( std::string( name ) );
+
+        return it != loaded.exports_by_name.end() ? &loaded.exports[ it->second ] : nullptr;
+    }
+
+    const export_t* module_t::find_export( std::uint16_t ordinal ) const
+    {
+        const auto& loaded = load_exports();
+        const auto it = loaded.exports_by_ordinal.find( ordinal );
+
+        return it != loaded.exports_by_ordinal.end() ? &loaded.exports[ it->second ] : nullptr;
+    }
+
+    const std::vector< import_t >& module_t::get_imports() const
+    {
+        return load_imports().imports;
+    }
+
+    const import_t* module_t::find_import( std::string_view module, std::string_view name ) const
+    {
+        const auto& loaded = load_imports();
+        const auto it = loaded.imports_by_name.find( import_key( module, name ) );
+
+        return it != loaded.imports_by_name.end() ? &loaded.imports[ it->second ] : nullptr;
+    }
+
+    const module_t::state_t& module_t::load_exports() const
+    {
+        load_headers();
+
+        std::call_once( state->exports_loaded, [ this ]() {
+            const auto directory = state->directories[ IMAGE_DIRECTORY_ENTRY_EXPORT ];
+
+            if ( !directory.VirtualAddress || directory.Size < sizeof( IMAGE_EXPORT_DIRECTORY ) )
+                return;
+
+            // Linkers place the address, name and ordinal tables and every name and forwarder string inside the
+            // directory, so a single read covers everything.
+            const image_reader reader{ *this, directory.VirtualAddress, directory.Size };
+            const auto header = reader.get< IMAGE_EXPORT_DIRECTORY >( directory.VirtualAddress );
+
+            auto& exports = state->exports;
+            exports.reserve( header.NumberOfFunctions );
+
+            for ( std::uint32_t i = 0; i < header.NumberOfFunctions; ++i )
+            {
+                const auto rva = reader.get< std::uint32_t >( header.AddressOfFunctions + i * sizeof( std::uint32_t ) );
+
+                if ( !rva )
+                    continue;
+
+                export_t entry{ {}, static_cast< std::uint16_t >( header.Base + i ), 0, {} };
+
+                // An address pointing back into the directory is a forwarder string rather than code or data.
+                if ( rva >= directory.VirtualAddress && rva - directory.VirtualAddress < directory.Size )
+                    entry.forwarder = reader.string( rva );
+                else
+                    entry.address = start + rva;
+
+                state->exports_by_ordinal.emplace( entry.ordinal, exports.size() );
+                exports.push_back( std::move( entry ) );
+            }
+
+            for ( std::uint32_t i = 0; i < header.NumberOfNames; ++i )
+            {
+                const auto name_rva = reader.get< std::uint32_t >( header.AddressOfNames + i * sizeof( std::uint32_t ) );
+                const auto index =
+                    reader.get< std::uint16_t >( header.AddressOfNameOrdinals + i * sizeof( std::uint16_t ) );
+
+                const auto it = state->exports_by_ordinal.find( static_cast< std::uint16_t >( header.Base + index ) );
+
+                if ( it == state->exports_by_ordinal.end() )
+                    continue;
+
+                auto& entry = exports[ it->second ];
+                auto name = reader.string( name_rva );
+
+                // Several names can share one function; the first one names the export, and all of them find it.
+                if ( entry.name.empty() )
+                    entry.name = name;
+
+                state->exports_by_name.emplace( std::move( name ), it->second );
+            }
+        } );
+
+        return *state;
+    }
+
+    const module_t::state_t& module_t::load_imports() const
+    {
+        load_headers();
+
+        std::call_once( state->imports_loaded, [ this ]() {
+            const auto directory = state->directories[ IMAGE_DIRECTORY_ENTRY_IMPORT ];
+
+            if ( !directory.VirtualAddress || !directory.Size )
+                return;
+
+            // The descriptors, name tables and names usually share a section, so read the whole of it at once.
+            auto span_start = directory.VirtualAddress;
+            auto span_size = directory.Size;
+
+            for ( const auto& section : state->sections )
+            {
+                if ( directory.VirtualAddress >= section.VirtualAddress &&
+                     directory.VirtualAddress - section.VirtualAddress < section.Misc.VirtualSize )
+                {
+                    span_start = section.VirtualAddress;
+                    span_size = section.Misc.VirtualSize;
+                    break;
+                }
+            }
+
+            const image_reader reader{ *this, span_start, span_size };
+
+            const auto is_64bit = state->kind == pe_kind_t::pe64;
+            const auto thunk_size = is_64bit ? sizeof( std::uint64_t ) : sizeof( std::uint32_t );
+            const auto ordinal_flag = is_64bit ? 0x8000000000000000ull : 0x80000000ull;
+
+            for ( auto offset = directory.VirtualAddress;; offset += sizeof( IMAGE_IMPORT_DESCRIPTOR ) )
+            {
+                const auto descriptor = reader.get< IMAGE_IMPORT_DESCRIPTOR >( offset );
+
+                if ( !descriptor.Name || !descriptor.FirstThunk )
+                    break;
+
+                const auto module_name = reader.string( descriptor.Name );
+
+                // Bound or loaded images overwrite the address table, so names come from the lookup table if present.
+                const auto lookup = descriptor.OriginalFirstThunk ? descriptor.OriginalFirstThunk : descriptor.FirstThunk;
+
+                for ( std::uint32_t i = 0;; ++i )
+                {
+                    const auto thunk_rva = static_cast< std::uint32_t >( lookup + i * thunk_size );
+                    const auto thunk = is_64bit ? reader.get< std::uint64_t >( thunk_rva )
+                                                : std::uint64_t{ reader.get< std::uint32_t >( thunk_rva ) };
+
+                    if ( !thunk )
+                        break;
+
+                    import_t entry{ module_name, {}, 0, start + descriptor.FirstThunk + i * thunk_size };
+
+                    if ( thunk & ordinal_flag )
+                        entry.ordinal = static_cast< std::uint16_t >( thunk & 0xFFFF );
+                    else
+                    {
+                        // The thunk points at a hint (an index into the exporter's name pointer table where the name
+                        // probably is) followed by the name.
+                        const auto hint_rva = static_cast< std::uint32_t >( thunk );
+
+                        entry.ordinal = reader.get< std::uint16_t >( hint_rva );
+                        entry.name = reader.string( hint_rva + sizeof( std::uint16_t ) );
+
+                        // A name imported twice from one module finds its first slot, as a scan in order would.
+                        state->imports_by_name.emplace( import_key( module_name, entry.name ), state->imports.size() );
+                    }
+
+                    state->imports.push_back( std::move( entry ) );
+                }
+            }
+        } );
+
+        return *state;
+    }
+}  // namespace extlib::win
@@ -0,0 +1,105 @@
+#include "win/win.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "scan.hpp"
+
+namespace extlib::win
+{
+    namespace
+    {
+        /// <summary>
+        /// An entry of the exception directory, spelled out here as the SDK only declares it for x64 targets.
+        /// </summary>
+        struct runtime_function_t
+        {
+            std::uint32_t start, end, unwind_info;
+        };
+
+        static_assert( sizeof( runtime_function_t ) == 12 );
+    }  // namespace
+
+    const std::vector< function_t >& module_t::get_functions() const
+    {
+        return load_functions().functions;
+    }
+
+    const function_t* module_t::find_function( std::uintptr_t address ) const
+    {
+        const auto& functions = load_functions().functions;
+
+        // The last function starting at or before the address is the only one that can contain it.
+        const auto it = std::upper_bound(
+            functions.begin(), functions.end(), address, []( std::uintptr_t value, const function_t& function ) {
+                return value < function.start;
+            } );
+
+        if ( it == functions.begin() || !std::prev( it )->contains( address ) )
+            return nullptr;
+
+        return &*std::prev( it );
+    }
+
+    std::vector< std::uintptr_t > module_t::find_all( const pattern_t& pattern, const function_t& function ) const
+    {
+        return find_all( pattern, std::vector< function_t >{ function } );
+    }
+
+    std::vector< std::uintptr_t >
+    module_t::find_all( const pattern_t& pattern, const std::vector< function_t >& functions ) const
+    {
+        if ( functions.empty() )
+            return {};
+
+        scanner_options_t options{ *this };
+
+        options.ranges.reserve( functions.size() );
+
+        for ( const auto& function : functions )
+            options.ranges.emplace_back( function.start, function.end );
+
+        return get_scanners().scan( options, [ & ]( const scanner& scan ) { return scan.find_all( pattern ); } );
+    }
+
+    const module_t::state_t& module_t::load_functions() const
+    {
+        load_headers();
+
+        std::call_once( state->functions_loaded, [ this ]() {
+            const auto directory = state->directories[ IMAGE_DIRECTORY_ENTRY_EXCEPTION ];
+
+            // 32-bit modules unwind through frame chains rather than tables, so they have no directory to read.
+            if ( state->kind != pe_kind_t::pe64 || !directory.VirtualAddress ||
+                 directory.Size < sizeof( runtime_function_t ) )
+                return;
+
+            const auto count = directory.Size / sizeof( runtime_function_t );
+            const auto bytes = read( start + directory.VirtualAddress, count * sizeof( runtime_function_t ) );
+
+            auto& functions = state->functions;
+            functions.reserve( count );
+
+            for ( std::size_t i = 0; i < count; ++i )
+            {
+                runtime_function_t entry;
+                std::memcpy( &entry, bytes.data() + i * sizeof( entry ), sizeof( entry ) );
+
+                if ( !entry.start || entry.end <= entry.start )
+                    continue;
+
+                functions.push_back( { start + entry.start, start + entry.end, start + entry.unwind_info } );
+            }
+
+            // The linker emits the table sorted, but nothing else guarantees it, and lookups depend on the order.
+            if ( !std::is_sorted( functions.begin(), functions.end(), []( const function_t& lhs, const function_t& rhs ) {
+                     return lhs.start < rhs.start;
+                 } ) )
+                std::sort( functions.begin(), functions.end(), []( const function_t& lhs, const function_t& rhs ) {
+                    return lhs.start < rhs.start;
+                } );
+        } );
+
+        return *state;
+    }
+}  // namespace extlib::win
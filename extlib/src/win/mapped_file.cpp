@@ -0,0 +1,78 @@
+#include "win/mapped_file.hpp"
+
+#include "win/win_exception.hpp"
+
+namespace extlib::win
+{
+    mapped_file::mapped_file( const std::filesystem::path& path )
+        : file( INVALID_HANDLE_VALUE ),
+          mapping( nullptr ),
+          view( nullptr ),
+          length( 0 )
+    {
+        file = CreateFileA(
+            path.string().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+        if ( file == INVALID_HANDLE_VALUE )
+            throw win_exception::from_last_error( "CreateFileA" );
+
+        LARGE_INTEGER size;
+
+        if ( !GetFileSizeEx( file, &size ) )
+        {
+            const auto error = win_exception::from_last_error( "GetFileSizeEx" );
+            CloseHandle( file );
+
+            throw error;
+        }
+
+        length = static_cast< std::size_t >( size.QuadPart );
+
+        // Empty files cannot be mapped, and there is nothing to read from them anyway.
+        if ( !length )
+            return;
+
+        mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+        if ( !mapping )
+        {
+            const auto error = win_exception::from_last_error( "CreateFileMappingA" );
+            CloseHandle( file );
+
+            throw error;
+        }
+
+        view = static_cast< const std::uint8_t* >( MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) );
+
+        if ( !view )
+        {
+            const auto error = win_exception::from_last_error( "MapViewOfFile" );
+            CloseHandle( mapping );
+            CloseHandle( file );
+
+            throw error;
+        }
+    }
+
+    mapped_file::~mapped_file()
+    {
+        if ( view )
+            UnmapViewOfFile( view );
+
+        if ( mapping )
+            CloseHandle( mapping );
+
+        if ( file != INVALID_HANDLE_VALUE )
+            CloseHandle( file );
+    }
+
+    const std::uint8_t* mapped_file::data() const
+    {
+        return view;
+    }
+
+    std::size_t mapped_file::size() const
+    {
+        return length;
+    }
+}  // namespace extlib::win
@@ -5,17 +5,63 @@ namespace extlib::win
     std::vector< std::uint8_t >
     memapi::read_process_memory( const handle_t& handle, std::uintptr_t address, std::size_t length )
     {
-        std::size_t bytes_read;
-
         std::vector< std::uint8_t > buffer( length );
 
-        if ( !ReadProcessMemory(
-                 handle.handle, reinterpret_cast< LPCVOID >( address ), buffer.data(), length, &bytes_read ) )
-            throw win_exception::from_last_error( "ReadProcessMemory" );
+        read_process_memory( handle, address, buffer.data(), length );
 
         return buffer;
     }
 
+    std::size_t
+    memapi::read_process_memory( const handle_t& handle, std::uintptr_t address, void* buffer, std::size_t length )
+    {
+        std::size_t bytes_read;
+
+        if ( !ReadProcessMemory( handle.handle, reinterpret_cast< LPCVOID >( address ), buffer, length, &bytes_read ) )
+            throw win_exception::from_last_error( "ReadProcessMemory" );
+
+        return bytes_read;
+    }
+
+    std::size_t memapi::write_process_memory(
+        const handle_t& handle,
+        std::uintptr_t address,
+        const void* buffer,
+        std::size_t length )
+    {
+        std::size_t bytes_written;
+
+        if ( !WriteProcessMemory( handle.handle, reinterpret_cast< LPVOID >( address ), buffer, length, &bytes_written ) )
+            throw win_exception::from_last_error( "WriteProcessMemory" );
+
+        return bytes_written;
+    }
+
+    std::uint64_t memapi::virtual_protect_ex(
+        const handle_t& handle,
+        std::uintptr_t address,
+        std::size_t size,
+        std::uint64_t protect )
+    {
+        DWORD old_protect;
+
+        if ( !VirtualProtectEx(
+                 handle.handle,
+                 reinterpret_cast< LPVOID >( address ),
+                 size,
+                 static_cast< DWORD >( protect ),
+                 &old_protect ) )
+            throw win_exception::from_last_error( "VirtualProtectEx" );
+
+        return old_protect;
+    }
+
+    void memapi::flush_instruction_cache( const handle_t& handle, std::uintptr_t address, std::size_t size )
+    {
+        if ( !FlushInstructionCache( handle.handle, reinterpret_cast< LPCVOID >( address ), size ) )
+            throw win_exception::from_last_error( "FlushInstructionCache" );
+    }
+
     std::optional< MEMORY_BASIC_INFORMATION > memapi::virtual_query_ex( const handle_t& handle, std::uintptr_t address )
     {
         MEMORY_BASIC_INFORMATION mbi;
@@ -6,28 +6,42 @@ namespace extlib::win
 {
     std::vector< std::uint64_t > psapi::enum_processes()
     {
-        DWORD aProcesses[ MAX_PROCESSES_COUNT ], cbNeeded;
+        std::vector< DWORD > processes( 1024 );
+        DWORD cbNeeded;
+
+        // EnumProcesses does not report how many identifiers did not fit, so grow the buffer until one is left spare.
+        for ( ;; )
+        {
+            const auto capacity = static_cast< DWORD >( processes.size() * sizeof( DWORD ) );
 
-        // Try to call EnumProcesses. If it fails, we throw a new windows exception.
-        if ( !EnumProcesses( aProcesses, sizeof( aProcesses ), &cbNeeded ) )
-            throw win_exception::from_last_error( "EnumProcesses" );
+            // Try to call EnumProcesses. If it fails, we throw a new windows exception.
+            if ( !EnumProcesses( processes.data(), capacity, &cbNeeded ) )
+                throw win_exception::from_last_error( "EnumProcesses" );
+
+            if ( cbNeeded < capacity )
+                break;
+
+            processes.resize( processes.size() * 2 );
+        }
 
         // Calculate the number of process identifiers returned
         std::size_t count = static_cast< std::size_t >( cbNeeded / sizeof( DWORD ) );
 
         std::vector< std::uint64_t > ids;
+        ids.reserve( count );
 
         // Add all of our process identifiers into the vector. We don't want our own though.
         for ( std::size_t i = 0; i < count; ++i )
         {
-            if ( aProcesses[ i ] )
-                ids.push_back( aProcesses[ i ] );
+            if ( processes[ i ] )
+                ids.push_back( processes[ i ] );
         }
 
         return ids;
     }
 
-    std::vector< module_t > psapi::enum_process_modules( std::unique_ptr< handle_t >& handle, module_filter_flag filter )
+    std::vector< module_t >
+    psapi::enum_process_modules( const std::unique_ptr< handle_t >& handle, module_filter_flag filter )
     {
         const auto modules = try_enum_process_modules( handle, filter );
 
@@ -37,18 +51,32 @@ namespace extlib::win
         return modules;
     }
 
-    std::vector< module_t > psapi::try_enum_process_modules( std::unique_ptr< handle_t >& handle, module_filter_flag filter )
+    std::vector< module_t >
+    psapi::try_enum_process_modules( const std::unique_ptr< handle_t >& handle, module_filter_flag filter )
     {
-        HMODULE hModules[ MAX_MODULE_COUNT ];
+        std::vector< HMODULE > hModules( 256 );
         DWORD cbNeeded;
 
         std::vector< module_t > modules;
 
-        if ( !EnumProcessModulesEx(
-                 handle->handle, hModules, sizeof( hModules ), &cbNeeded, static_cast< DWORD >( filter ) ) )
-            return modules;
+        // Unlike EnumProcesses, the required size is reported, so at most one retry is needed (unless modules are
+        // loaded in between).
+        for ( ;; )
+        {
+            const auto capacity = static_cast< DWORD >( hModules.size() * sizeof( HMODULE ) );
+
+            if ( !EnumProcessModulesEx(
+                     handle->handle, hModules.data(), capacity, &cbNeeded, static_cast< DWORD >( filter ) ) )
+                return modules;
+
+            if ( cbNeeded <= capacity )
+                break;
+
+            hModules.resize( cbNeeded / sizeof( HMODULE ) );
+        }
 
         std::size_t count = static_cast< std::size_t >( cbNeeded / sizeof( HMODULE ) );
+        modules.reserve( count );
 
         // Add all of our modules into the vector. We don't want our own though.
         for ( std::size_t i = 0; i < count; ++i )
@@ -57,7 +85,7 @@ namespace extlib::win
         return modules;
     }
 
-    std::string psapi::get_module_base_name( std::unique_ptr< handle_t >& handle, const module_t& module )
+    std::string psapi::get_module_base_name( const std::unique_ptr< handle_t >& handle, const module_t& module )
     {
         TCHAR szProcessName[ MAX_PATH ] = TEXT( "<unknown>" );
 
@@ -29,6 +29,53 @@ namespace extlib::win
         return true;
     }
 
+    std::filesystem::path ptapi::query_full_process_image_name( const handle_t& handle )
+    {
+        // Paths can be longer than MAX_PATH, up to the 32767 characters the kernel allows.
+        for ( std::size_t capacity = MAX_PATH; capacity <= 0x8000; capacity *= 2 )
+        {
+            std::string path( capacity, '\0' );
+            auto length = static_cast< DWORD >( capacity );
+
+            if ( QueryFullProcessImageNameA( handle.handle, 0, path.data(), &length ) )
+            {
+                path.resize( length );
+                return path;
+            }
+
+            if ( GetLastError() != ERROR_INSUFFICIENT_BUFFER )
+                break;
+        }
+
+        return {};
+    }
+
+    std::uint64_t ptapi::get_process_creation_time( HANDLE handle )
+    {
+        FILETIME creation, exit, kernel, user;
+
+        if ( !GetProcessTimes( handle, &creation, &exit, &kernel, &user ) )
+            return 0;
+
+        return std::uint64_t{ creation.dwHighDateTime } << 32 | creation.dwLowDateTime;
+    }
+
+    bool ptapi::is_process_running( std::uint64_t id, std::uint64_t creation_time )
+    {
+        std::unique_ptr< handle_t > handle;
+
+        if ( !try_open_process( handle, PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, false, id ) )
+            return false;
+
+        // An exited process keeps its id for as long as handles to it are open, but its handle is signaled.
+        const auto running = get_process_creation_time( handle->handle ) == creation_time &&
+                             WaitForSingleObject( handle->handle, 0 ) == WAIT_TIMEOUT;
+
+        close_handle( std::move( handle ) );
+
+        return running;
+    }
+
     void ptapi::close_handle( std::unique_ptr< handle_t > handle )
     {
         if ( !CloseHandle( handle->handle ) )
@@ -0,0 +1,69 @@
+#include "win/win.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace extlib::win
+{
+    namespace
+    {
+        constexpr std::uint16_t relocation_highlow = 3;
+        constexpr std::uint16_t relocation_dir64 = 10;
+    }  // namespace
+
+    const std::vector< relocation_t >& module_t::get_relocations() const
+    {
+        return load_relocations().relocations;
+    }
+
+    const module_t::state_t& module_t::load_relocations() const
+    {
+        load_headers();
+
+        std::call_once( state->relocations_loaded, [ this ]() {
+            const auto directory = state->directories[ IMAGE_DIRECTORY_ENTRY_BASERELOC ];
+
+            if ( !directory.VirtualAddress || directory.Size < sizeof( IMAGE_BASE_RELOCATION ) )
+                return;
+
+            // The directory is a list of blocks, each covering a page with a 16-bit entry (type and page offset) for
+            // every location to rewrite.
+            const auto bytes = read( start + directory.VirtualAddress, directory.Size );
+
+            auto& relocations = state->relocations;
+
+            for ( std::size_t offset = 0; offset + sizeof( IMAGE_BASE_RELOCATION ) <= bytes.size(); )
+            {
+                IMAGE_BASE_RELOCATION block;
+                std::memcpy( &block, bytes.data() + offset, sizeof( block ) );
+
+                if ( block.SizeOfBlock < sizeof( block ) || block.SizeOfBlock > bytes.size() - offset )
+                    break;
+
+                const auto entries = ( block.SizeOfBlock - sizeof( block ) ) / sizeof( std::uint16_t );
+
+                for ( std::size_t i = 0; i < entries; ++i )
+                {
+                    std::uint16_t entry;
+                    std::memcpy(
+                        &entry, bytes.data() + offset + sizeof( block ) + i * sizeof( std::uint16_t ), sizeof( entry ) );
+
+                    const auto type = entry >> 12;
+
+                    // Everything else is either padding or specific to architectures other than x86 and x64.
+                    if ( type == relocation_dir64 || type == relocation_highlow )
+                        relocations.push_back(
+                            { block.VirtualAddress + ( entry & 0xFFFu ), type == relocation_dir64 ? 8u : 4u } );
+                }
+
+                offset += block.SizeOfBlock;
+            }
+
+            std::sort( relocations.begin(), relocations.end(), []( const relocation_t& lhs, const relocation_t& rhs ) {
+                return lhs.rva < rhs.rva;
+            } );
+        } );
+
+        return *state;
+    }
+}  // namespace extlib::win
@@ -1,8 +1,11 @@
 #include "win/win.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
+#include "patch.hpp"
 #include "scan.hpp"
 #include "win/psapi.hpp"
 
@@ -13,17 +16,42 @@ namespace extlib::win
         return win::psapi::get_module_file_name( handle, win::module_t{} );
     }
 
-    module_t::module_t( HANDLE hHandle, HMODULE hModule ) : handle( hHandle ), module( hModule )
+    module_t::module_t( HANDLE hHandle, HMODULE hModule )
+        : handle( hHandle ),
+          module( hModule ),
+          state( std::make_shared< state_t >() )
     {
         const auto module_info = win::psapi::get_module_information( handle, *this );
 
         start = reinterpret_cast< std::uintptr_t >( module_info.lpBaseOfDll );
         end = start + module_info.SizeOfImage;
+    }
 
-        sections = get_sections();
+    module_t::module_t( HANDLE handle, std::uintptr_t base, std::size_t size )
+        : handle( handle ),
+          module( reinterpret_cast< HMODULE >( base ) ),
+          start( base ),
+          end( base + size ),
+          state( std::make_shared< state_t >() )
+    {
+    }
+
+    module_t::module_t( std::shared_ptr< const memory_source > source, std::uintptr_t base, std::size_t size )
+        : handle( nullptr ),
+          module( reinterpret_cast< HMODULE >( base ) ),
+          source( std::move( source ) ),
+          start( base ),
+          end( base + size ),
+          state( std::make_shared< state_t >() )
+    {
     }
 
-    module_t::module_t() : handle( nullptr ), module( nullptr ), start( 0 ), end( 0 )
+    module_t::module_t()
+        : handle( nullptr ),
+          module( nullptr ),
+          start( 0 ),
+          end( 0 ),
+          state( std::make_shared< state_t >() )
     {
     }
 
@@ -39,17 +67,55 @@ namespace extlib::win
 
     std::vector< std::uintptr_t > section_t::find_all( const pattern_t& pattern ) const
     {
-        scanner scan{ *this };
+        return current_module.get_scanners().scan( *this, [ & ]( const scanner& scan ) {
+            return scan.find_all( pattern );
+        } );
+    }
+
+    std::pmr::vector< std::uintptr_t >
+    section_t::find_all( const pattern_t& pattern, std::pmr::memory_resource* resource ) const
+    {
+        return current_module.get_scanners().scan( *this, [ & ]( const scanner& scan ) {
+            return scan.find_all( pattern, resource );
+        } );
+    }
+
+    std::vector< std::uint8_t > module_t::read_image() const
+    {
+        std::vector< std::uint8_t > image( end - start );
+
+        const auto copy = [ this, &image ]( std::uintptr_t address, std::size_t size ) {
+            if ( address < start || address - start >= image.size() )
+                return;
+
+            size = std::min( size, image.size() - ( address - start ) );
+
+            try
+            {
+                const auto bytes = read( address, size );
+                std::memcpy( image.data() + ( address - start ), bytes.data(), bytes.size() );
+            }
+            catch ( const std::exception& )
+            {
+            }
+        };
 
-        return scan.find_all( pattern );
+        copy( start, std::min< std::size_t >( image.size(), 0x1000 ) );
+
+        for ( const auto& section : get_sections() )
+            copy( section.start, section.size );
+
+        return image;
     }
 
     section_t module_t::operator[]( const std::string_view name ) const
     {
-        for ( const auto& section : sections )
+        for ( const auto& section : load_headers().sections )
         {
-            if ( section.name.find( name ) != std::string_view::npos )
-                return section;
+            const auto section_name = std::string_view( reinterpret_cast< const char* >( section.Name ), 8 );
+
+            if ( section_name.find( name ) != std::string_view::npos )
+                return { *this, section };
         }
 
         std::stringstream msg;
@@ -57,35 +123,125 @@ namespace extlib::win
         throw std::runtime_error( msg.str() );
     }
 
-    std::vector< section_t > module_t::get_sections()
+    std::vector< section_t > module_t::get_sections() const
     {
         std::vector< section_t > sections;
 
-        dos = read< IMAGE_DOS_HEADER >( start );
+        for ( const auto& section : load_headers().sections )
+            sections.emplace_back( *this, section );
 
-        std::size_t nt_header_size;
-        nt = read< IMAGE_NT_HEADERS >( start + dos.e_lfanew, &nt_header_size );
+        return sections;
+    }
 
-        kind = static_cast< pe_kind_t >( nt.OptionalHeader.Magic );
+    pe_kind_t module_t::get_kind() const
+    {
+        return load_headers().kind;
+    }
 
-        std::uintptr_t offset = start + dos.e_lfanew + nt_header_size;
-        for ( std::size_t i = 0; i < nt.FileHeader.NumberOfSections; ++i )
-        {
-            std::size_t bytes_read;
-            const auto section = read< IMAGE_SECTION_HEADER >( offset, &bytes_read );
+    const IMAGE_DOS_HEADER& module_t::get_dos_header() const
+    {
+        return load_headers().dos;
+    }
 
-            sections.emplace_back( *this, section );
-            offset += bytes_read;
-        }
+    const IMAGE_NT_HEADERS& module_t::get_nt_headers() const
+    {
+        return load_headers().nt;
+    }
 
-        return sections;
+    IMAGE_DATA_DIRECTORY module_t::get_data_directory( std::size_t index ) const
+    {
+        return index < IMAGE_NUMBEROF_DIRECTORY_ENTRIES ? load_headers().directories[ index ] : IMAGE_DATA_DIRECTORY{};
+    }
+
+    const module_t::state_t& module_t::load_headers() const
+    {
+        std::call_once( state->headers_loaded, [ this ]() {
+            // The DOS header, NT headers and section table almost always fit in the first page of the image, so a
+            // single read is enough. Sources other than processes may hold less than a page of headers (a file on
+            // disk only has SizeOfHeaders bytes of them), so take whatever they have.
+            std::vector< std::uint8_t > page( std::min< std::size_t >( end - start, 0x1000 ) );
+
+            if ( source )
+                page.resize( source->read( start, page.data(), page.size() ) );
+            else
+                page = read( start, page.size() );
+
+            if ( page.size() < sizeof( IMAGE_DOS_HEADER ) )
+                throw std::runtime_error( "The module is too small to hold a DOS header" );
+
+            auto& dos = state->dos;
+            std::memcpy( &dos, page.data(), sizeof( dos ) );
+
+            if ( dos.e_magic != IMAGE_DOS_SIGNATURE || dos.e_lfanew < 0 )
+                throw std::runtime_error( "The module does not start with a DOS header" );
+
+            const auto nt_offset = static_cast< std::size_t >( dos.e_lfanew );
+            const auto file_header_end = nt_offset + sizeof( DWORD ) + sizeof( IMAGE_FILE_HEADER );
+
+            if ( page.size() < file_header_end )
+                page = read( start, file_header_end );
+
+            IMAGE_FILE_HEADER file_header;
+            std::memcpy( &file_header, page.data() + nt_offset + sizeof( DWORD ), sizeof( file_header ) );
+
+            // The section table follows the optional header, whose size differs between 32 and 64-bit images.
+            const auto section_offset = file_header_end + file_header.SizeOfOptionalHeader;
+            const auto headers_end = section_offset + file_header.NumberOfSections * sizeof( IMAGE_SECTION_HEADER );
+
+            if ( page.size() < headers_end )
+                page = read( start, headers_end );
+
+            auto& nt = state->nt;
+            std::memcpy( &nt, page.data() + nt_offset, std::min( sizeof( nt ), section_offset - nt_offset ) );
+
+            if ( nt.Signature != IMAGE_NT_SIGNATURE )
+                throw std::runtime_error( "The module's NT headers are invalid" );
+
+            state->kind = static_cast< pe_kind_t >( nt.OptionalHeader.Magic );
+
+            // PE32 optional headers have no 64-bit fields, which moves the data directories 16 bytes closer.
+            const auto optional_offset = file_header_end;
+            const auto directory_offset = optional_offset + ( state->kind == pe_kind_t::pe64 ? 112 : 96 );
+            const auto directory_count = std::min< std::size_t >(
+                IMAGE_NUMBEROF_DIRECTORY_ENTRIES,
+                ( section_offset - std::min( section_offset, directory_offset ) ) / sizeof( IMAGE_DATA_DIRECTORY ) );
+
+            std::memcpy(
+                state->directories, page.data() + directory_offset, directory_count * sizeof( IMAGE_DATA_DIRECTORY ) );
+
+            state->sections.resize( file_header.NumberOfSections );
+            std::memcpy(
+                state->sections.data(),
+                page.data() + section_offset,
+                state->sections.size() * sizeof( IMAGE_SECTION_HEADER ) );
+        } );
+
+        return *state;
     }
 
     std::vector< std::uintptr_t > module_t::find_all( const pattern_t& pattern ) const
     {
-        scanner scan{ *this };
+        return get_scanners().scan( *this, [ & ]( const scanner& scan ) { return scan.find_all( pattern ); } );
+    }
 
-        return scan.find_all( pattern );
+    std::pmr::vector< std::uintptr_t >
+    module_t::find_all( const pattern_t& pattern, std::pmr::memory_resource* resource ) const
+    {
+        return get_scanners().scan( *this, [ & ]( const scanner& scan ) {
+            return scan.find_all( pattern, resource );
+        } );
+    }
+
+    scanner_pool& module_t::get_scanners() const
+    {
+        std::call_once( state->scanners_created, [ this ]() { state->scanners = std::make_shared< scanner_pool >(); } );
+
+        return *state->scanners;
+    }
+
+    patch_set module_t::create_patch_set() const
+    {
+        return patch_set{ handle };
     }
 
     std::vector< string_t > module_t::get_strings_by_name( std::string_view name ) const
@@ -136,7 +292,13 @@ namespace extlib::win
 
     std::vector< std::uint8_t > module_t::read( std::uintptr_t address, std::size_t length ) const
     {
-        return memapi::read_process_memory( handle, address, length );
+        if ( !source )
+            return memapi::read_process_memory( handle, address, length );
+
+        std::vector< std::uint8_t > bytes( length );
+        source->read_exact( address, bytes.data(), length );
+
+        return bytes;
     }
 
     bool handle_t::is_valid() const
@@ -161,6 +323,9 @@ namespace extlib::win
 
     std::vector< region_t > module_t::get_regions( std::uintptr_t start, std::uintptr_t end ) const
     {
+        if ( source )
+            return source->get_regions( start, end );
+
         std::vector< region_t > regions;
 
         auto start_address = start;
@@ -197,6 +362,19 @@ namespace extlib::win
 
     std::string module_t::get_name() const
     {
+        if ( source )
+        {
+            for ( const auto& info : source->get_modules() )
+            {
+                if ( info.base == start )
+                    return info.name;
+            }
+
+            std::stringstream msg;
+            msg << "Failed to locate module at 0x" << std::hex << start << " in its memory source";
+            throw std::runtime_error( msg.str() );
+        }
+
         return win::psapi::get_module_base_name( std::make_unique< handle_t >( handle ), *this );
     }
 
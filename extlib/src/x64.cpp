@@ -0,0 +1,420 @@
+#include "x64.hpp"
+
+#include <array>
+
+namespace extlib::x64
+{
+    namespace
+    {
+        /// <summary>
+        /// The kinds of immediate an opcode takes.
+        /// </summary>
+        enum immediate_t : std::uint8_t
+        {
+            no_immediate,
+
+            /// <summary>
+            /// A byte.
+            /// </summary>
+            ib,
+
+            /// <summary>
+            /// A word.
+            /// </summary>
+            iw,
+
+            /// <summary>
+            /// A word with an operand size prefix, and a dword otherwise.
+            /// </summary>
+            iz,
+
+            /// <summary>
+            /// Like `iz`, but a qword with REX.W (`mov r64, imm64`).
+            /// </summary>
+            iv,
+
+            /// <summary>
+            /// An absolute address, a qword unless the address size is overridden (`mov al, [moffs]`).
+            /// </summary>
+            moffs,
+
+            /// <summary>
+            /// A word followed by a byte (`enter`).
+            /// </summary>
+            iw_ib,
+
+            /// <summary>
+            /// `iz` or `ib` depending on the operation in the ModRM byte (`test` takes one, `not` and the rest do not).
+            /// </summary>
+            group3,
+        };
+
+        /// <summary>
+        /// The opcode takes a ModRM byte.
+        /// </summary>
+        constexpr std::uint8_t modrm = 0x10;
+
+        /// <summary>
+        /// The opcode's immediate is a branch displacement.
+        /// </summary>
+        constexpr std::uint8_t relative = 0x20;
+
+        /// <summary>
+        /// The opcode does not exist in 64-bit mode.
+        /// </summary>
+        constexpr std::uint8_t invalid = 0x40;
+
+        /// <summary>
+        /// The byte is a legacy prefix rather than an opcode.
+        /// </summary>
+        constexpr std::uint8_t prefix = 0x80;
+
+        /// <summary>
+        /// Gets the ModRM and immediate flags of an opcode in the one-byte map.
+        /// </summary>
+        constexpr std::uint8_t one_byte_flags( std::uint8_t opcode )
+        {
+            switch ( opcode )
+            {
+                case 0x26:
+                case 0x2E:
+                case 0x36:
+                case 0x3E:
+                case 0x64:
+                case 0x65:
+                case 0x66:
+                case 0x67:
+                case 0xF0:
+                case 0xF2:
+                case 0xF3: return prefix;
+                default: break;
+            }
+
+            if ( opcode < 0x40 )
+            {
+                switch ( opcode & 7 )
+                {
+                    case 0:
+                    case 1:
+                    case 2:
+                    case 3: return modrm;
+                    case 4: return ib;
+                    case 5: return iz;
+                    default: return invalid;  // Segment pushes and pops and BCD adjustments.
+                }
+            }
+
+            if ( opcode < 0x60 )
+                return no_immediate;
+
+            if ( opcode >= 0x70 && opcode < 0x80 )
+                return ib | relative;
+
+            if ( opcode >= 0x84 && opcode < 0x90 )
+                return modrm;
+
+            if ( opcode >= 0x90 && opcode < 0xA0 )
+                return opcode == 0x9A ? invalid : static_cast< std::uint8_t >( no_immediate );
+
+            if ( opcode >= 0xA0 && opcode < 0xA4 )
+                return moffs;
+
+            if ( opcode >= 0xB0 && opcode < 0xB8 )
+                return ib;
+
+            if ( opcode >= 0xB8 && opcode < 0xC0 )
+                return iv;
+
+            if ( opcode >= 0xD8 && opcode < 0xE0 )
+                return modrm;
+
+            if ( opcode >= 0xE0 && opcode < 0xE4 )
+                return ib | relative;
+
+            switch ( opcode )
+            {
+                case 0x60:
+                case 0x61:
+                case 0x82:
+                case 0xCE:
+                case 0xD4:
+                case 0xD5:
+                case 0xD6:
+                case 0xEA: return invalid;
+                case 0x63: return modrm;
+                case 0x68: return iz;
+                case 0x69: return modrm | iz;
+                case 0x6A: return ib;
+                case 0x6B: return modrm | ib;
+                case 0x80: return modrm | ib;
+                case 0x81: return modrm | iz;
+                case 0x83: return modrm | ib;
+                case 0xA8: return ib;
+                case 0xA9: return iz;
+                case 0xC0:
+                case 0xC1: return modrm | ib;
+                case 0xC2: return iw;
+                case 0xC6: return modrm | ib;
+                case 0xC7: return modrm | iz;
+                case 0xC8: return iw_ib;
+                case 0xCA: return iw;
+                case 0xCD: return ib;
+                case 0xD0:
+                case 0xD1:
+                case 0xD2:
+                case 0xD3: return modrm;
+                case 0xE4:
+                case 0xE5:
+                case 0xE6:
+                case 0xE7: return ib;
+                case 0xE8:
+                case 0xE9: return iz | relative;
+                case 0xEB: return ib | relative;
+                case 0xF6:
+                case 0xF7: return modrm | group3;
+                case 0xFE:
+                case 0xFF: return modrm;
+                default: return no_immediate;
+            }
+        }
+
+        /// <summary>
+        /// Gets the ModRM and immediate flags of an opcode in the two-byte (0F) map.
+        /// </summary>
+        constexpr std::uint8_t two_byte_flags( std::uint8_t opcode )
+        {
+            if ( opcode >= 0x80 && opcode < 0x90 )
+                return iz | relative;
+
+            if ( opcode >= 0xC8 && opcode < 0xD0 )
+                return no_immediate;
+
+            switch ( opcode )
+            {
+                case 0x04:
+                case 0x0A:
+                case 0x0C:
+                case 0x24:
+                case 0x25:
+                case 0x26:
+                case 0x27:
+                case 0x39:
+                case 0x3B:
+                case 0x3C:
+                case 0x3D:
+                case 0x3E:
+                case 0x3F:
+                case 0x7A:
+                case 0x7B:
+                case 0xA6:
+                case 0xA7: return invalid;
+                case 0x05:
+                case 0x06:
+                case 0x07:
+                case 0x08:
+                case 0x09:
+                case 0x0B:
+                case 0x0E:
+                case 0x30:
+                case 0x31:
+                case 0x32:
+                case 0x33:
+                case 0x34:
+                case 0x35:
+                case 0x36:
+                case 0x37:
+                case 0x77:
+                case 0xA0:
+                case 0xA1:
+                case 0xA2:
+                case 0xA8:
+                case 0xA9:
+                case 0xAA: return no_immediate;
+                case 0x0F:  // 3DNow! takes its operation as a trailing byte.
+                case 0x70:
+                case 0x71:
+                case 0x72:
+                case 0x73:
+                case 0xA4:
+                case 0xAC:
+                case 0xBA:
+                case 0xC2:
+                case 0xC4:
+                case 0xC5:
+                case 0xC6: return modrm | ib;
+                default: return modrm;
+            }
+        }
+
+        template< std::uint8_t ( *flags )( std::uint8_t ) >
+        constexpr std::array< std::uint8_t, 256 > make_table()
+        {
+            std::array< std::uint8_t, 256 > table{};
+
+            for ( std::size_t i = 0; i < table.size(); ++i )
+                table[ i ] = flags( static_cast< std::uint8_t >( i ) );
+
+            return table;
+        }
+
+        constexpr auto one_byte_table = make_table< one_byte_flags >();
+        constexpr auto two_byte_table = make_table< two_byte_flags >();
+
+        /// <summary>
+        /// Checks whether an opcode of a VEX or EVEX encoded instruction takes an immediate byte.
+        /// </summary>
+        constexpr bool vex_takes_immediate( std::uint8_t map, std::uint8_t opcode )
+        {
+            return map == 3 || ( map == 1 && two_byte_table[ opcode ] == ( modrm | ib ) );
+        }
+    }  // namespace
+
+    std::optional< instruction_t > decode( const std::uint8_t* data, std::size_t size )
+    {
+        const auto available = size < max_instruction_length ? size : max_instruction_length;
+
+        std::size_t position = 0;
+
+        bool operand_size = false, address_size = false, rex_w = false;
+
+        // Legacy prefixes come first in any order, then an optional REX prefix right before the opcode.
+        while ( position < available && one_byte_table[ data[ position ] ] & prefix )
+        {
+            operand_size |= data[ position ] == 0x66;
+            address_size |= data[ position ] == 0x67;
+            ++position;
+        }
+
+        if ( position < available && ( data[ position ] & 0xF0 ) == 0x40 )
+            rex_w = ( data[ position++ ] & 0x08 ) != 0;
+
+        if ( position >= available )
+            return std::nullopt;
+
+        std::uint8_t flags;
+
+        const auto opcode = data[ position++ ];
+
+        if ( opcode == 0xC4 || opcode == 0xC5 || opcode == 0x62 )
+        {
+            // VEX and EVEX prefixes carry the opcode map (and REX) themselves, and always take a ModRM byte.
+            const auto prefix_size = opcode == 0xC5 ? 1 : opcode == 0xC4 ? 2 : 3;
+
+            if ( position + prefix_size >= available )
+                return std::nullopt;
+
+            const auto map = opcode == 0xC5 ? 1 : data[ position ] & ( opcode == 0xC4 ? 0x1F : 0x07 );
+
+            // VEX has the 0F, 0F38 and 0F3A maps, and EVEX adds maps 5 and 6 for half precision.
+            const auto valid_map = ( map >= 1 && map <= 3 ) || ( opcode == 0x62 && ( map == 5 || map == 6 ) );
+
+            if ( !valid_map )
+                return std::nullopt;
+
+            position += prefix_size;
+
+            const auto vex_opcode = data[ position++ ];
+
+            // `vzeroupper` and `vzeroall` are the only VEX instructions without a ModRM byte.
+            if ( map == 1 && vex_opcode == 0x77 )
+                flags = no_immediate;
+            else
+                flags = modrm | ( vex_takes_immediate( static_cast< std::uint8_t >( map ), vex_opcode ) ? ib : 0 );
+        }
+        else if ( opcode == 0x0F )
+        {
+            if ( position >= available )
+                return std::nullopt;
+
+            const auto second = data[ position++ ];
+
+            if ( second == 0x38 || second == 0x3A )
+            {
+                if ( position >= available )
+                    return std::nullopt;
+
+                ++position;
+                flags = modrm | ( second == 0x3A ? ib : 0 );
+            }
+            else
+                flags = two_byte_table[ second ];
+        }
+        else
+            flags = one_byte_table[ opcode ];
+
+        if ( flags & invalid )
+            return std::nullopt;
+
+        instruction_t instruction{};
+
+        if ( flags & modrm )
+        {
+            if ( position >= available )
+                return std::nullopt;
+
+            const auto byte = data[ position++ ];
+            const auto mod = byte >> 6;
+            const auto rm = byte & 7;
+
+            if ( mod != 3 )
+            {
+                auto base = rm;
+
+                if ( rm == 4 )
+                {
+                    if ( position >= available )
+                        return std::nullopt;
+
+                    base = data[ position++ ] & 7;
+                }
+
+                std::uint8_t displacement = 0;
+
+                if ( mod == 1 )
+                    displacement = 1;
+                else if ( mod == 2 || ( mod == 0 && base == 5 ) )
+                    displacement = 4;
+
+                // Only a ModRM without a SIB byte addresses relative to the instruction; with one, it is absolute.
+                instruction.rip_relative = mod == 0 && rm == 5;
+                instruction.displacement_offset = static_cast< std::uint8_t >( position );
+                instruction.displacement_size = displacement;
+
+                position += displacement;
+            }
+
+            // `test` is the only operation of group 3 with an immediate.
+            if ( ( flags & 0x0F ) == group3 )
+            {
+                const auto kind = ( byte >> 3 & 7 ) < 2 ? ( opcode == 0xF6 ? ib : iz ) : no_immediate;
+                flags = static_cast< std::uint8_t >( ( flags & ~0x0F ) | kind );
+            }
+        }
+
+        std::size_t immediate = 0;
+
+        switch ( flags & 0x0F )
+        {
+            case ib: immediate = 1; break;
+            case iw: immediate = 2; break;
+            case iw_ib: immediate = 3; break;
+            case iz: immediate = operand_size && !( flags & relative ) ? 2 : 4; break;
+            case iv: immediate = rex_w ? 8 : operand_size ? 2 : 4; break;
+            case moffs: immediate = address_size ? 4 : 8; break;
+            default: break;
+        }
+
+        instruction.immediate_offset = static_cast< std::uint8_t >( position );
+        instruction.immediate_size = static_cast< std::uint8_t >( immediate );
+        instruction.relative_branch = ( flags & relative ) != 0;
+
+        position += immediate;
+
+        if ( position > available )
+            return std::nullopt;
+
+        instruction.length = static_cast< std::uint8_t >( position );
+
+        return instruction;
+    }
+}  // namespace extlib::x64
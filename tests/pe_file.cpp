@@ -0,0 +1,268 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "pe_file.hpp"
+#include "win/win.hpp"
+
+namespace
+{
+    std::int32_t failures = 0;
+
+    void check( bool condition, const char* what )
+    {
+        if ( !condition )
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    // The image has its headers, then `.text` and `.rdata`, and aligns sections in the file differently than in
+    // memory, so reading it as loaded means moving every section.
+    constexpr std::uint32_t file_alignment = 0x200, section_alignment = 0x1000;
+    constexpr std::uint32_t text_rva = 0x1000, text_raw = 0x400;
+    constexpr std::uint32_t rdata_rva = 0x2000, rdata_raw = 0x600, rdata_size = 0x400;
+    constexpr std::uint32_t image_size = 0x3000;
+
+    // Where `.rdata` holds the export directory, its tables and strings, and the import directory, its lookup and
+    // address tables and names.
+    constexpr std::uint32_t export_rva = 0x2000, export_size = 0x200;
+    constexpr std::uint32_t functions_rva = 0x2040, names_rva = 0x2060, name_ordinals_rva = 0x2070;
+    constexpr std::uint32_t forwarder_rva = 0x2100;
+    constexpr std::uint32_t import_rva = 0x2200, import_size = 3 * sizeof( IMAGE_IMPORT_DESCRIPTOR );
+    constexpr std::uint32_t kernel32_lookup_rva = 0x2240, kernel32_iat_rva = 0x2280, user32_iat_rva = 0x22A0;
+    constexpr std::uint32_t kernel32_name_rva = 0x22C0, user32_name_rva = 0x22D0;
+    constexpr std::uint32_t sleep_rva = 0x2300, exit_process_rva = 0x2310, message_box_rva = 0x2330;
+
+    class image_builder final
+    {
+       public:
+        image_builder() : bytes( rdata_raw + rdata_size ) {}
+
+        template< typename T >
+        void put( std::uint32_t offset, const T& value )
+        {
+            std::memcpy( bytes.data() + offset, &value, sizeof( value ) );
+        }
+
+        template< typename T >
+        void put_rva( std::uint32_t rva, const T& value )
+        {
+            put( rva - rdata_rva + rdata_raw, value );
+        }
+
+        void put_string( std::uint32_t rva, const char* string )
+        {
+            std::memcpy( bytes.data() + ( rva - rdata_rva + rdata_raw ), string, std::strlen( string ) + 1 );
+        }
+
+        /// <summary>
+        /// Puts a hint and a name, as an import by name points at.
+        /// </summary>
+        void put_hint_name( std::uint32_t rva, std::uint16_t hint, const char* name )
+        {
+            put_rva( rva, hint );
+            put_string( rva + sizeof( hint ), name );
+        }
+
+        std::vector< std::uint8_t > bytes;
+    };
+
+    /// <summary>
+    /// Builds a DLL exporting `Alpha` (ordinal 10, also named `AlphaAlias`), `Beta` (ordinal 11, forwarded to
+    /// `NTDLL.RtlAllocateHeap`) and ordinal 13 by ordinal only, with ordinal 12 left empty. It imports `Sleep`, ordinal
+    /// 16 and `ExitProcess` from KERNEL32.dll, and `MessageBoxA` from USER32.dll through its address table alone.
+    /// </summary>
+    template< typename nt_headers_t, typename thunk_t >
+    std::vector< std::uint8_t > build_image( std::uint16_t machine, std::uint64_t image_base, thunk_t ordinal_flag )
+    {
+        image_builder image;
+
+        IMAGE_DOS_HEADER dos{};
+        dos.e_magic = IMAGE_DOS_SIGNATURE;
+        dos.e_lfanew = 0x80;
+        image.put( 0, dos );
+
+        nt_headers_t nt{};
+        nt.Signature = IMAGE_NT_SIGNATURE;
+        nt.FileHeader.Machine = machine;
+        nt.FileHeader.NumberOfSections = 2;
+        nt.FileHeader.SizeOfOptionalHeader = sizeof( nt.OptionalHeader );
+        nt.FileHeader.Characteristics = IMAGE_FILE_EXECUTABLE_IMAGE | IMAGE_FILE_DLL;
+        nt.OptionalHeader.Magic = sizeof( thunk_t ) == 8 ? IMAGE_NT_OPTIONAL_HDR64_MAGIC : IMAGE_NT_OPTIONAL_HDR32_MAGIC;
+        nt.OptionalHeader.ImageBase = static_cast< decltype( nt.OptionalHeader.ImageBase ) >( image_base );
+        nt.OptionalHeader.SectionAlignment = section_alignment;
+        nt.OptionalHeader.FileAlignment = file_alignment;
+        nt.OptionalHeader.SizeOfImage = image_size;
+        nt.OptionalHeader.SizeOfHeaders = text_raw;
+        nt.OptionalHeader.NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+        nt.OptionalHeader.DataDirectory[ IMAGE_DIRECTORY_ENTRY_EXPORT ] = { export_rva, export_size };
+        nt.OptionalHeader.DataDirectory[ IMAGE_DIRECTORY_ENTRY_IMPORT ] = { import_rva, import_size };
+        image.put( 0x80, nt );
+
+        IMAGE_SECTION_HEADER sections[ 2 ]{};
+        std::memcpy( sections[ 0 ].Name, ".text", 5 );
+        sections[ 0 ].Misc.VirtualSize = 0x20;
+        sections[ 0 ].VirtualAddress = text_rva;
+        sections[ 0 ].SizeOfRawData = file_alignment;
+        sections[ 0 ].PointerToRawData = text_raw;
+        sections[ 0 ].Characteristics = IMAGE_SCN_CNT_CODE | IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_MEM_READ;
+        std::memcpy( sections[ 1 ].Name, ".rdata", 6 );
+        sections[ 1 ].Misc.VirtualSize = rdata_size;
+        sections[ 1 ].VirtualAddress = rdata_rva;
+        sections[ 1 ].SizeOfRawData = rdata_size;
+        sections[ 1 ].PointerToRawData = rdata_raw;
+        sections[ 1 ].Characteristics = IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ;
+        image.put( 0x80 + sizeof( nt ), sections );
+
+        // Two functions in `.text`, `ret` and `int3; ret`, to tell the loaded image from the file.
+        image.put( text_raw, std::uint8_t{ 0xC3 } );
+        image.put( text_raw + 0x10, std::uint16_t{ 0xC3CC } );
+
+        IMAGE_EXPORT_DIRECTORY exports{};
+        exports.Name = 0x20A0;
+        exports.Base = 10;
+        exports.NumberOfFunctions = 4;
+        exports.NumberOfNames = 3;
+        exports.AddressOfFunctions = functions_rva;
+        exports.AddressOfNames = names_rva;
+        exports.AddressOfNameOrdinals = name_ordinals_rva;
+        image.put_rva( export_rva, exports );
+
+        const std::uint32_t functions[] = { text_rva, forwarder_rva, 0, text_rva + 0x10 };
+        const std::uint32_t names[] = { 0x2080, 0x2088, 0x2098 };
+        const std::uint16_t name_ordinals[] = { 0, 0, 1 };
+        image.put_rva( functions_rva, functions );
+        image.put_rva( names_rva, names );
+        image.put_rva( name_ordinals_rva, name_ordinals );
+        image.put_string( 0x2080, "Alpha" );
+        image.put_string( 0x2088, "AlphaAlias" );
+        image.put_string( 0x2098, "Beta" );
+        image.put_string( 0x20A0, "test.dll" );
+        image.put_string( forwarder_rva, "NTDLL.RtlAllocateHeap" );
+
+        IMAGE_IMPORT_DESCRIPTOR imports[ 3 ]{};
+        imports[ 0 ].OriginalFirstThunk = kernel32_lookup_rva;
+        imports[ 0 ].Name = kernel32_name_rva;
+        imports[ 0 ].FirstThunk = kernel32_iat_rva;
+        imports[ 1 ].Name = user32_name_rva;
+        imports[ 1 ].FirstThunk = user32_iat_rva;
+        image.put_rva( import_rva, imports );
+
+        // An unbound image's address table holds the same thunks as its lookup table.
+        const thunk_t kernel32_thunks[] = { sleep_rva, static_cast< thunk_t >( ordinal_flag | 16 ), exit_process_rva, 0 };
+        const thunk_t user32_thunks[] = { message_box_rva, 0 };
+        image.put_rva( kernel32_lookup_rva, kernel32_thunks );
+        image.put_rva( kernel32_iat_rva, kernel32_thunks );
+        image.put_rva( user32_iat_rva, user32_thunks );
+        image.put_string( kernel32_name_rva, "KERNEL32.dll" );
+        image.put_string( user32_name_rva, "USER32.dll" );
+        image.put_hint_name( sleep_rva, 3, "Sleep" );
+        image.put_hint_name( exit_process_rva, 9, "ExitProcess" );
+        image.put_hint_name( message_box_rva, 1, "MessageBoxA" );
+
+        return image.bytes;
+    }
+
+    void check_image(
+        const std::filesystem::path& path,
+        const std::vector< std::uint8_t >& bytes,
+        extlib::win::pe_kind_t kind,
+        std::uintptr_t image_base,
+        std::size_t thunk_size )
+    {
+        {
+            std::ofstream file( path, std::ios::binary | std::ios::trunc );
+            file.write( reinterpret_cast< const char* >( bytes.data() ), static_cast< std::streamsize >( bytes.size() ) );
+        }
+
+        const auto source = std::make_shared< extlib::pe_file_source >( path );
+        check( source->get_base() == image_base, "the image is presented at its preferred base" );
+        check( source->get_size() == image_size, "the size of the loaded image" );
+
+        const extlib::win::module_t module( source, source->get_base(), source->get_size() );
+        check( module.get_kind() == kind, "the kind of the image" );
+
+        // Sections are read at their virtual addresses, not where they lie in the file.
+        check( module.read< std::uint8_t >( image_base + text_rva ) == 0xC3, "the first function is loaded" );
+        check( module.read< std::uint16_t >( image_base + text_rva + 0x10 ) == 0xC3CC, "the second function is loaded" );
+
+        check( module.get_exports().size() == 3, "the empty ordinal is not exported" );
+
+        const auto alpha = module.find_export( "Alpha" );
+        check( alpha && alpha->ordinal == 10 && alpha->address == image_base + text_rva, "Alpha" );
+        check( alpha && alpha->forwarder.empty(), "Alpha is not forwarded" );
+        check( module.find_export( "AlphaAlias" ) == alpha, "a second name finds the same export" );
+        check( module.find_export( std::uint16_t{ 10 } ) == alpha, "Alpha by ordinal" );
+
+        const auto beta = module.find_export( "Beta" );
+        check( beta && beta->ordinal == 11 && !beta->address, "Beta has no address" );
+        check( beta && beta->forwarder == "NTDLL.RtlAllocateHeap", "Beta's forwarder" );
+
+        const auto unnamed = module.find_export( std::uint16_t{ 13 } );
+        check( unnamed && unnamed->name.empty() && unnamed->address == image_base + text_rva + 0x10, "ordinal 13" );
+
+        check( !module.find_export( std::uint16_t{ 12 } ), "the empty ordinal is not found" );
+        check( !module.find_export( "Gamma" ), "a name not exported is not found" );
+
+        const auto& imports = module.get_imports();
+        check( imports.size() == 4, "every import is parsed" );
+
+        if ( imports.size() == 4 )
+        {
+            check( imports[ 0 ].module == "KERNEL32.dll" && imports[ 0 ].name == "Sleep", "Sleep" );
+            check( imports[ 0 ].ordinal == 3, "Sleep's hint" );
+            check( imports[ 0 ].slot == image_base + kernel32_iat_rva, "Sleep's slot" );
+            check( imports[ 1 ].name.empty() && imports[ 1 ].ordinal == 16, "the import by ordinal" );
+            check( imports[ 1 ].slot == image_base + kernel32_iat_rva + thunk_size, "the slot of the import by ordinal" );
+            check( imports[ 3 ].module == "USER32.dll" && imports[ 3 ].name == "MessageBoxA", "MessageBoxA" );
+            check( imports[ 3 ].slot == image_base + user32_iat_rva, "the slot of an import without a lookup table" );
+        }
+
+        const auto exit_process = module.find_import( "kernel32.DLL", "ExitProcess" );
+        check( exit_process && exit_process->ordinal == 9, "ExitProcess is found case-insensitively" );
+        check( exit_process && exit_process->slot == image_base + kernel32_iat_rva + 2 * thunk_size, "ExitProcess's slot" );
+        check( !module.find_import( "KERNEL32.dll", "MessageBoxA" ), "an import is not found under another module" );
+
+        // The image can also be presented somewhere else, moving every export and slot with it.
+        const auto moved = std::make_shared< extlib::pe_file_source >( path, 0x50000000 );
+        const extlib::win::module_t moved_module( moved, moved->get_base(), moved->get_size() );
+
+        const auto moved_alpha = moved_module.find_export( "Alpha" );
+        check( moved_alpha && moved_alpha->address == 0x50000000 + text_rva, "Alpha at another base" );
+
+        const auto moved_sleep = moved_module.find_import( "KERNEL32.dll", "Sleep" );
+        check( moved_sleep && moved_sleep->slot == 0x50000000 + kernel32_iat_rva, "Sleep's slot at another base" );
+    }
+}  // namespace
+
+// Writes a 32 and a 64-bit DLL and checks their exports, forwarders, ordinals and import address table slots, as read
+// through `pe_file_source`.
+std::int32_t main()
+{
+    const auto directory = std::filesystem::temp_directory_path();
+
+    check_image(
+        directory / "extlib_test_pe32.dll",
+        build_image< IMAGE_NT_HEADERS32, std::uint32_t >( IMAGE_FILE_MACHINE_I386, 0x10000000, IMAGE_ORDINAL_FLAG32 ),
+        extlib::win::pe_kind_t::pe32,
+        0x10000000,
+        sizeof( std::uint32_t ) );
+
+    check_image(
+        directory / "extlib_test_pe64.dll",
+        build_image< IMAGE_NT_HEADERS64, std::uint64_t >( IMAGE_FILE_MACHINE_AMD64, 0x180000000, IMAGE_ORDINAL_FLAG64 ),
+        extlib::win::pe_kind_t::pe64,
+        static_cast< std::uintptr_t >( 0x180000000 ),
+        sizeof( std::uint64_t ) );
+
+    std::filesystem::remove( directory / "extlib_test_pe32.dll" );
+    std::filesystem::remove( directory / "extlib_test_pe64.dll" );
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+#include <cstdint>
+#include <iostream>
+#include <map>
+
+#include "watch.hpp"
+
+namespace
+{
+    std::int32_t failures = 0;
+
+    void check( bool condition, const char* what )
+    {
+        if ( !condition )
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+}  // namespace
+
+// Watches nested and overlapping entries in this process's own memory, and changes several of them in the same tick.
+std::int32_t main()
+{
+    static std::uint8_t memory[ 128 ];
+
+    const auto base = reinterpret_cast< std::uintptr_t >( memory );
+
+    const extlib::win::handle_t process( GetCurrentProcess() );
+    extlib::watch_list list( process );
+
+    const auto outer = list.add( base, 32 );
+    const auto nested = list.add( base + 8, 4 );
+    const auto overlapping = list.add( base + 24, 16 );
+    const auto unchanged = list.add( base + 48, 8 );
+
+    std::map< std::size_t, std::size_t > reports;
+    std::map< std::size_t, extlib::watch_change_t > last;
+
+    list.on_change( [ & ]( const extlib::watch_change_t& change ) {
+        ++reports[ change.id ];
+        last[ change.id ] = change;
+    } );
+
+    // The first tick only reads the baseline.
+    list.tick();
+    check( reports.empty(), "the baseline tick reports nothing" );
+
+    // A change in the outer entry ahead of the nested one, one in the nested entry, one where the outer and
+    // overlapping entries meet, and one only the overlapping entry covers.
+    memory[ 2 ] = 1;
+    memory[ 9 ] = 2;
+    memory[ 30 ] = 3;
+    memory[ 36 ] = 4;
+
+    list.tick();
+
+    check( reports[ outer ] == 1, "the outer entry is reported once" );
+    check( reports[ nested ] == 1, "the entry nested in a reported one is reported" );
+    check( reports[ overlapping ] == 1, "the entry overlapping a reported one is reported once" );
+    check( !reports.count( unchanged ), "the unchanged entry is not reported" );
+    check( last[ nested ].current[ 1 ] == 2 && last[ nested ].previous[ 1 ] == 0, "the nested entry's values" );
+    check( last[ overlapping ].current[ 6 ] == 3 && last[ overlapping ].current[ 12 ] == 4, "the overlapping values" );
+
+    reports.clear();
+
+    list.tick();
+    check( reports.empty(), "a tick without changes reports nothing" );
+
+    // A change past the end of the outer entry reaches only the overlapping one.
+    memory[ 36 ] = 5;
+
+    list.tick();
+    check( reports.size() == 1 && reports[ overlapping ] == 1, "only the overlapping entry is reported" );
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,51 @@
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "signature_database.hpp"
+
+// Compiles the text of a signature database into the blob `extlib::signature_database::load` maps.
+std::int32_t main( std::int32_t argc, char** argv )
+{
+    if ( argc != 3 )
+    {
+        std::cerr << "usage: extlib_sigc <source> <output>" << std::endl;
+        return 2;
+    }
+
+    try
+    {
+        std::ifstream source( argv[ 1 ], std::ios::binary );
+
+        if ( !source )
+            throw std::runtime_error( std::string( "Failed to open '" ) + argv[ 1 ] + "'" );
+
+        const std::string text( std::istreambuf_iterator< char >( source ), {} );
+        const auto blob = extlib::signature_database::compile( text );
+
+        std::ofstream output( argv[ 2 ], std::ios::binary | std::ios::trunc );
+        output.write( reinterpret_cast< const char* >( blob.data() ), static_cast< std::streamsize >( blob.size() ) );
+
+        // The file is mapped without sharing write access, so it must be flushed and closed before it is loaded.
+        output.close();
+
+        if ( !output )
+            throw std::runtime_error( std::string( "Failed to write '" ) + argv[ 2 ] + "'" );
+
+        // Loading the blob back checks it the way every consumer will.
+        const auto database = extlib::signature_database::load( argv[ 2 ] );
+
+        std::cout << argv[ 2 ] << ": " << database.size() << " signatures, " << blob.size() << " bytes" << std::endl;
+    }
+    catch ( const std::exception& e )
+    {
+        std::cerr << "extlib_sigc: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}